@@ -0,0 +1,123 @@
+/*
+ * BenchPersistentState.cpp
+ *
+ *  Created on: 17.10.2026
+ *      Author: joe
+ */
+
+#include "BenchPersistentState.h"
+
+#include <stdio.h>
+#include <string.h>
+
+using namespace CppAppUtils;
+
+using namespace retroradio_bench;
+
+#define BENCH_CONF_FILE			"/dev/null"
+
+#define STATE_START_TAG_0 		'B'
+#define STATE_START_TAG_1 		'E'
+#define STATE_END_TAG_0 		'N'
+#define STATE_END_TAG_1 		'C'
+
+#define PERSISTENCE_GROUP		"Persistence"
+
+BenchConfiguration::BenchConfiguration() :
+		Configuration(BENCH_CONF_FILE, Logger::INFO)
+{
+}
+
+BenchConfiguration::~BenchConfiguration()
+{
+}
+
+const char *BenchConfiguration::GetVersion()
+{
+	return "bench";
+}
+
+const char *BenchConfiguration::GetDescriptionString()
+{
+	return "Persistence bench.";
+}
+
+const char *BenchConfiguration::GetCommand()
+{
+	return "retroradio-persistence-bench";
+}
+
+BenchPersistentState::BenchPersistentState(Configuration *configuration) :
+		AbstractPersistentState(configuration)
+{
+	this->DoResetToDefault();
+}
+
+BenchPersistentState::~BenchPersistentState()
+{
+}
+
+bool BenchPersistentState::Configure(const char *path, size_t journalSize)
+{
+	GKeyFile *keyFile=g_key_file_new();
+	char size[32];
+	bool result;
+
+	snprintf(size, sizeof(size), "%lu", (unsigned long)journalSize);
+	g_key_file_set_string(keyFile, PERSISTENCE_GROUP, "FilePath", path);
+	g_key_file_set_string(keyFile, PERSISTENCE_GROUP, "JournalSize", size);
+
+	result=this->ParseConfigFileItem(keyFile, PERSISTENCE_GROUP, "FilePath") &&
+			this->ParseConfigFileItem(keyFile, PERSISTENCE_GROUP, "JournalSize");
+
+	g_key_file_free(keyFile);
+	return result;
+}
+
+size_t BenchPersistentState::DoWriteDataSet(void *buffer, size_t maxSize)
+{
+	if (sizeof(BenchDataSet)>maxSize)
+		return 0;
+
+	memcpy(buffer, &this->state, sizeof(BenchDataSet));
+	return sizeof(BenchDataSet);
+}
+
+bool BenchPersistentState::DoReadDataSet(const void *buffer, size_t size)
+{
+	if (size<sizeof(BenchDataSet))
+		return false;
+
+	memcpy(&this->state, buffer, sizeof(BenchDataSet));
+
+	return this->state.stateStartTag[0]==STATE_START_TAG_0 && this->state.stateStartTag[1]==STATE_START_TAG_1 &&
+			this->state.stateEndTag[0]==STATE_END_TAG_0 && this->state.stateEndTag[1]==STATE_END_TAG_1;
+}
+
+void BenchPersistentState::DoResetToDefault()
+{
+	memset(&this->state, 0, sizeof(this->state));
+	this->state.stateStartTag[0]	= STATE_START_TAG_0;
+	this->state.stateStartTag[1]	= STATE_START_TAG_1;
+	this->state.stateEndTag[0]		= STATE_END_TAG_0;
+	this->state.stateEndTag[1]		= STATE_END_TAG_1;
+}
+
+void BenchPersistentState::SetValue(guint32 value, bool immediately)
+{
+	this->state.value=value;
+	if (immediately)
+		this->CommitImmediately();
+	else
+		this->CommitDelayed();
+}
+
+guint32 BenchPersistentState::GetValue()
+{
+	return this->state.value;
+}
+
+size_t BenchPersistentState::GetDataSetSize()
+{
+	return sizeof(BenchDataSet);
+}
@@ -0,0 +1,77 @@
+/*
+ * BenchPersistentState.h
+ *
+ *  Created on: 17.10.2026
+ *      Author: joe
+ */
+
+#ifndef BENCH_BENCHPERSISTENTSTATE_H_
+#define BENCH_BENCHPERSISTENTSTATE_H_
+
+#include <glib.h>
+
+#include <cpp-app-utils/Configuration.h>
+
+#include "AbstractPersistentState.h"
+
+namespace retroradio_bench {
+
+//configuration without file, the persistence bench passes its items to the module directly
+class BenchConfiguration : public CppAppUtils::Configuration {
+protected:
+	virtual const char *GetVersion();
+
+	virtual const char *GetDescriptionString();
+
+	virtual const char *GetCommand();
+
+public:
+	BenchConfiguration();
+
+	virtual ~BenchConfiguration();
+};
+
+//Persistent state holding a single counter in a data set of the controller's size.
+//Commits go through the controller's journal and writer thread unchanged.
+class BenchPersistentState : public retroradio_controller::AbstractPersistentState {
+private:
+	typedef struct BenchDataSet
+	{
+		char stateStartTag[2];
+
+		guint32 value;
+
+		//pads the data set to the size of the controller's one
+		char filler[300];
+
+		char stateEndTag[2];
+	} BenchDataSet;
+
+	BenchDataSet state;
+
+protected:
+	virtual size_t DoWriteDataSet(void *buffer, size_t maxSize);
+
+	virtual bool DoReadDataSet(const void *buffer, size_t size);
+
+	virtual void DoResetToDefault();
+
+public:
+	BenchPersistentState(CppAppUtils::Configuration *configuration);
+
+	virtual ~BenchPersistentState();
+
+	bool Configure(const char *path, size_t journalSize);
+
+	void SetValue(guint32 value, bool immediately);
+
+	//0 after a reset to default
+	guint32 GetValue();
+
+	//payload size of each journal record
+	static size_t GetDataSetSize();
+};
+
+} /* namespace retroradio_bench */
+
+#endif /* BENCH_BENCHPERSISTENTSTATE_H_ */
@@ -0,0 +1,22 @@
+/*
+ * BenchStatistics.cpp
+ *
+ *  Created on: 17.10.2026
+ *      Author: joe
+ */
+
+#include "BenchStatistics.h"
+
+using namespace retroradio_bench;
+
+gint64 BenchStatistics::Percentile(const std::vector<gint64> &values, unsigned int percent)
+{
+	size_t rank;
+
+	if (values.empty()) return 0;
+
+	rank=(values.size()*percent+99)/100;
+	if (rank==0) rank=1;
+
+	return values[rank-1];
+}
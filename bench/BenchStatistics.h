@@ -0,0 +1,26 @@
+/*
+ * BenchStatistics.h
+ *
+ *  Created on: 17.10.2026
+ *      Author: joe
+ */
+
+#ifndef BENCH_BENCHSTATISTICS_H_
+#define BENCH_BENCHSTATISTICS_H_
+
+#include <vector>
+
+#include <glib.h>
+
+namespace retroradio_bench {
+
+//Evaluation helpers shared by the benches.
+class BenchStatistics {
+public:
+	//nearest rank percentile of values sorted ascending, 0 without values
+	static gint64 Percentile(const std::vector<gint64> &values, unsigned int percent);
+};
+
+} /* namespace retroradio_bench */
+
+#endif /* BENCH_BENCHSTATISTICS_H_ */
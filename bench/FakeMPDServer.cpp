@@ -0,0 +1,488 @@
+/*
+ * FakeMPDServer.cpp
+ *
+ *  Created on: 17.10.2026
+ *      Author: joe
+ */
+
+#include "FakeMPDServer.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include <glib-unix.h>
+
+#include <cpp-app-utils/Logger.h>
+
+using namespace CppAppUtils;
+
+using namespace retroradio_bench;
+
+#define FAKE_MPD_GREETING			"OK MPD 0.23.5\n"
+#define FAKE_MPD_MAX_ARGS			16
+#define FAKE_MPD_PLAYLIST_NAME		"radio"
+#define FAKE_MPD_BITRATE			128
+
+#define ACK_ERROR_ARG				2
+#define ACK_ERROR_UNKNOWN			5
+
+FakeMPDServer::FakeMPDServer(unsigned int stationCnt, unsigned int audioDelayMs) :
+		socketPath(NULL),
+		listenFd(-1),
+		listenEventId(0),
+		stationCnt(stationCnt),
+		audioDelayMs(audioDelayMs),
+		playing(false),
+		currentSong(0),
+		queueLength(0),
+		queueVersion(1),
+		repeat(false),
+		playStartTime(0)
+{
+	for (int a=0; a<FAKE_MPD_MAX_CLIENTS; a++)
+	{
+		this->clients[a].server=this;
+		this->clients[a].fd=-1;
+		this->clients[a].eventId=0;
+		this->clients[a].commandListResponse=NULL;
+	}
+}
+
+FakeMPDServer::~FakeMPDServer()
+{
+	this->Stop();
+}
+
+bool FakeMPDServer::Start(const char *socketPath)
+{
+	struct sockaddr_un addr;
+
+	if (strlen(socketPath)>=sizeof(addr.sun_path))
+	{
+		Logger::LogError("Fake mpd socket path %s is too long.", socketPath);
+		return false;
+	}
+
+	this->listenFd=socket(AF_UNIX, SOCK_STREAM|SOCK_NONBLOCK|SOCK_CLOEXEC, 0);
+	if (this->listenFd==-1)
+	{
+		Logger::LogError("Failed to create fake mpd socket: %s", strerror(errno));
+		return false;
+	}
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family=AF_UNIX;
+	strcpy(addr.sun_path, socketPath);
+	unlink(socketPath);
+
+	if (bind(this->listenFd, (struct sockaddr *)&addr, sizeof(addr))!=0 || listen(this->listenFd, 4)!=0)
+	{
+		Logger::LogError("Failed to listen on fake mpd socket %s: %s", socketPath, strerror(errno));
+		close(this->listenFd);
+		this->listenFd=-1;
+		return false;
+	}
+
+	this->socketPath=strdup(socketPath);
+	this->listenEventId=g_unix_fd_add(this->listenFd, G_IO_IN, FakeMPDServer::OnListenSocketEvent, this);
+
+	Logger::LogDebug("FakeMPDServer::Start - Listening on %s.", socketPath);
+	return true;
+}
+
+void FakeMPDServer::Stop()
+{
+	for (int a=0; a<FAKE_MPD_MAX_CLIENTS; a++)
+		if (this->clients[a].fd!=-1)
+			this->CloseClient(&this->clients[a]);
+
+	if (this->listenEventId!=0)
+	{
+		g_source_remove(this->listenEventId);
+		this->listenEventId=0;
+	}
+
+	if (this->listenFd!=-1)
+	{
+		close(this->listenFd);
+		this->listenFd=-1;
+	}
+
+	if (this->socketPath!=NULL)
+	{
+		unlink(this->socketPath);
+		free(this->socketPath);
+		this->socketPath=NULL;
+	}
+}
+
+gboolean FakeMPDServer::OnListenSocketEvent(gint fd, GIOCondition condition, gpointer user_data)
+{
+	FakeMPDServer *instance=(FakeMPDServer *)user_data;
+	instance->AcceptClient();
+	return TRUE;
+}
+
+gboolean FakeMPDServer::OnClientSocketEvent(gint fd, GIOCondition condition, gpointer user_data)
+{
+	Client *client=(Client *)user_data;
+	client->server->ReceiveLines(client);
+	return TRUE;
+}
+
+void FakeMPDServer::AcceptClient()
+{
+	Client *client=NULL;
+	int fd;
+
+	fd=accept4(this->listenFd, NULL, NULL, SOCK_NONBLOCK|SOCK_CLOEXEC);
+	if (fd==-1)
+		return;
+
+	for (int a=0; a<FAKE_MPD_MAX_CLIENTS && client==NULL; a++)
+		if (this->clients[a].fd==-1)
+			client=&this->clients[a];
+
+	if (client==NULL)
+	{
+		Logger::LogError("Fake mpd refuses connection. Too many clients.");
+		close(fd);
+		return;
+	}
+
+	client->fd=fd;
+	client->lineLength=0;
+	client->idling=false;
+	client->idleMask=0;
+	client->inCommandList=false;
+	client->commandListOk=false;
+	client->commandListFailed=false;
+	client->commandListIdx=0;
+	client->commandListResponse=g_string_new(NULL);
+	client->pendingIdleEvents=0;
+	client->eventId=g_unix_fd_add(fd, G_IO_IN, FakeMPDServer::OnClientSocketEvent, client);
+
+	this->Send(client, FAKE_MPD_GREETING, strlen(FAKE_MPD_GREETING));
+}
+
+void FakeMPDServer::CloseClient(Client *client)
+{
+	g_source_remove(client->eventId);
+	client->eventId=0;
+	close(client->fd);
+	client->fd=-1;
+	g_string_free(client->commandListResponse, TRUE);
+	client->commandListResponse=NULL;
+}
+
+void FakeMPDServer::Send(Client *client, const char *data, size_t len)
+{
+	ssize_t written;
+
+	//responses are small, the socket buffer takes them at once
+	while (len>0)
+	{
+		written=write(client->fd, data, len);
+		if (written<=0)
+		{
+			if (written==-1 && errno==EINTR) continue;
+			return;
+		}
+		data+=written;
+		len-=written;
+	}
+}
+
+void FakeMPDServer::ReceiveLines(Client *client)
+{
+	ssize_t bytesRd;
+	char *lineEnd;
+
+	bytesRd=read(client->fd, client->lineBuffer+client->lineLength,
+			FAKE_MPD_LINE_BUFFER_SIZE-client->lineLength-1);
+	if (bytesRd<=0)
+	{
+		if (bytesRd==0 || (errno!=EAGAIN && errno!=EINTR))
+			this->CloseClient(client);
+		return;
+	}
+
+	client->lineLength+=bytesRd;
+	client->lineBuffer[client->lineLength]='\0';
+
+	while (client->fd!=-1 && (lineEnd=strchr(client->lineBuffer, '\n'))!=NULL)
+	{
+		unsigned int consumed=(lineEnd-client->lineBuffer)+1;
+
+		*lineEnd='\0';
+		this->ProcessLine(client, client->lineBuffer);
+
+		memmove(client->lineBuffer, client->lineBuffer+consumed, client->lineLength-consumed+1);
+		client->lineLength-=consumed;
+	}
+
+	if (client->lineLength==FAKE_MPD_LINE_BUFFER_SIZE-1)
+	{
+		Logger::LogError("Fake mpd received an overlong line. Closing client.");
+		this->CloseClient(client);
+	}
+}
+
+int FakeMPDServer::SplitArgs(char *line, char **argv, int maxArgs)
+{
+	int argc=0;
+	char *src=line;
+	char *dst;
+
+	while (*src!='\0' && argc<maxArgs)
+	{
+		while (*src==' ' || *src=='\t') src++;
+		if (*src=='\0') break;
+
+		if (*src=='"')
+		{
+			//quoted argument with backslash escapes as sent by libmpdclient
+			src++;
+			argv[argc++]=dst=src;
+			while (*src!='\0' && *src!='"')
+			{
+				if (*src=='\\' && src[1]!='\0') src++;
+				*dst++=*src++;
+			}
+			if (*src=='"') src++;
+			*dst='\0';
+		}
+		else
+		{
+			argv[argc++]=src;
+			while (*src!='\0' && *src!=' ' && *src!='\t') src++;
+			if (*src!='\0') *src++='\0';
+		}
+	}
+
+	return argc;
+}
+
+void FakeMPDServer::ProcessLine(Client *client, char *line)
+{
+	char *argv[FAKE_MPD_MAX_ARGS];
+	int argc;
+	GString *response;
+
+	argc=FakeMPDServer::SplitArgs(line, argv, FAKE_MPD_MAX_ARGS);
+	if (argc==0) return;
+
+	if (client->idling)
+	{
+		//mpd only accepts noidle while idling
+		if (strcmp(argv[0], "noidle")==0)
+		{
+			client->idling=false;
+			this->Send(client, "OK\n", 3);
+		}
+		return;
+	}
+
+	if (strcmp(argv[0], "noidle")==0)
+		return;
+
+	if (strcmp(argv[0], "idle")==0)
+	{
+		client->idleMask=FakeMPDServer::ParseIdleMask(argv+1, argc-1);
+		client->idling=true;
+		this->FlushIdle(client);
+		return;
+	}
+
+	if (strcmp(argv[0], "command_list_begin")==0 || strcmp(argv[0], "command_list_ok_begin")==0)
+	{
+		client->inCommandList=true;
+		client->commandListOk=strcmp(argv[0], "command_list_ok_begin")==0;
+		client->commandListFailed=false;
+		client->commandListIdx=0;
+		g_string_truncate(client->commandListResponse, 0);
+		return;
+	}
+
+	if (client->inCommandList)
+	{
+		if (strcmp(argv[0], "command_list_end")==0)
+		{
+			client->inCommandList=false;
+			if (!client->commandListFailed)
+				g_string_append(client->commandListResponse, "OK\n");
+			this->Send(client, client->commandListResponse->str, client->commandListResponse->len);
+			return;
+		}
+
+		//mpd skips the remaining commands of a list after the first failure
+		if (client->commandListFailed)
+			return;
+
+		if (!this->ExecuteCommand(client, argv, argc, client->commandListIdx, client->commandListResponse))
+			client->commandListFailed=true;
+		else if (client->commandListOk)
+			g_string_append(client->commandListResponse, "list_OK\n");
+
+		client->commandListIdx++;
+		return;
+	}
+
+	response=g_string_new(NULL);
+	if (this->ExecuteCommand(client, argv, argc, 0, response))
+		g_string_append(response, "OK\n");
+	this->Send(client, response->str, response->len);
+	g_string_free(response, TRUE);
+}
+
+bool FakeMPDServer::ExecuteCommand(Client *client, char **argv, int argc, unsigned int listIdx, GString *response)
+{
+	const char *cmd=argv[0];
+
+	if (strcmp(cmd, "status")==0)
+		this->AppendStatus(response);
+	else if (strcmp(cmd, "playlistinfo")==0)
+		this->AppendPlaylistInfo(response);
+	else if (strcmp(cmd, "listplaylists")==0)
+		g_string_append(response, "playlist: " FAKE_MPD_PLAYLIST_NAME "\nLast-Modified: 2026-10-17T00:00:00Z\n");
+	else if (strcmp(cmd, "ping")==0)
+		;
+	else if (strcmp(cmd, "clear")==0)
+	{
+		this->queueLength=0;
+		this->queueVersion++;
+		this->playing=false;
+		this->NotifyIdleClients(IDLE_EVENT_PLAYLIST|IDLE_EVENT_PLAYER);
+	}
+	else if (strcmp(cmd, "load")==0)
+	{
+		if (argc<2 || strcmp(argv[1], FAKE_MPD_PLAYLIST_NAME)!=0)
+		{
+			g_string_append_printf(response, "ACK [50@%u] {load} No such playlist\n", listIdx);
+			return false;
+		}
+		this->queueLength+=this->stationCnt;
+		this->queueVersion++;
+		this->NotifyIdleClients(IDLE_EVENT_PLAYLIST);
+	}
+	else if (strcmp(cmd, "repeat")==0)
+	{
+		this->repeat=argc>1 && strcmp(argv[1], "1")==0;
+		this->NotifyIdleClients(IDLE_EVENT_PLAYER);
+	}
+	else if (strcmp(cmd, "play")==0)
+	{
+		unsigned int song=argc>1 ? (unsigned int)atoi(argv[1]) : this->currentSong;
+
+		if (song>=this->queueLength)
+		{
+			g_string_append_printf(response, "ACK [%d@%u] {play} Bad song index\n", ACK_ERROR_ARG, listIdx);
+			return false;
+		}
+		this->currentSong=song;
+		this->playing=true;
+		this->playStartTime=g_get_monotonic_time();
+		this->NotifyIdleClients(IDLE_EVENT_PLAYER);
+	}
+	else if (strcmp(cmd, "stop")==0)
+	{
+		this->playing=false;
+		this->NotifyIdleClients(IDLE_EVENT_PLAYER);
+	}
+	else
+	{
+		g_string_append_printf(response, "ACK [%d@%u] {%s} unknown command \"%s\"\n",
+				ACK_ERROR_UNKNOWN, listIdx, cmd, cmd);
+		return false;
+	}
+
+	return true;
+}
+
+void FakeMPDServer::AppendStatus(GString *response)
+{
+	gint64 playedUs=0;
+
+	if (this->playing)
+		playedUs=g_get_monotonic_time()-this->playStartTime-(gint64)this->audioDelayMs*1000;
+
+	g_string_append_printf(response,
+			"volume: 100\nrepeat: %d\nrandom: 0\nsingle: 0\nconsume: 0\nplaylist: %u\nplaylistlength: %u\n"
+			"state: %s\n",
+			this->repeat ? 1 : 0, this->queueVersion, this->queueLength, this->playing ? "play" : "stop");
+
+	if (this->queueLength>0)
+		g_string_append_printf(response, "song: %u\nsongid: %u\n", this->currentSong, this->currentSong+1);
+
+	//the player needs audioDelayMs until the stream delivers audio
+	if (this->playing)
+		g_string_append_printf(response, "elapsed: %.3f\nbitrate: %d\n",
+				playedUs>0 ? (double)playedUs/G_USEC_PER_SEC : 0.0, playedUs>0 ? FAKE_MPD_BITRATE : 0);
+}
+
+void FakeMPDServer::AppendPlaylistInfo(GString *response)
+{
+	for (unsigned int a=0; a<this->queueLength; a++)
+		g_string_append_printf(response, "file: http://bench.invalid/station%u\nPos: %u\nId: %u\nName: Station %u\n",
+				a, a, a+1, a);
+}
+
+unsigned int FakeMPDServer::ParseIdleMask(char **argv, int argc)
+{
+	unsigned int mask=0;
+
+	//without arguments idle waits for any subsystem
+	if (argc==0)
+		return IDLE_EVENT_PLAYER|IDLE_EVENT_PLAYLIST|IDLE_EVENT_MIXER;
+
+	for (int a=0; a<argc; a++)
+	{
+		if (strcmp(argv[a], "player")==0)
+			mask|=IDLE_EVENT_PLAYER;
+		else if (strcmp(argv[a], "playlist")==0)
+			mask|=IDLE_EVENT_PLAYLIST;
+		else if (strcmp(argv[a], "mixer")==0)
+			mask|=IDLE_EVENT_MIXER;
+	}
+
+	return mask;
+}
+
+void FakeMPDServer::NotifyIdleClients(unsigned int idleEvents)
+{
+	for (int a=0; a<FAKE_MPD_MAX_CLIENTS; a++)
+	{
+		if (this->clients[a].fd==-1) continue;
+		this->clients[a].pendingIdleEvents|=idleEvents;
+		if (this->clients[a].idling)
+			this->FlushIdle(&this->clients[a]);
+	}
+}
+
+void FakeMPDServer::FlushIdle(Client *client)
+{
+	GString *response;
+	unsigned int events=client->pendingIdleEvents & client->idleMask;
+
+	if (events==0) return;
+
+	response=g_string_new(NULL);
+	if (events & IDLE_EVENT_PLAYER)
+		g_string_append(response, "changed: player\n");
+	if (events & IDLE_EVENT_PLAYLIST)
+		g_string_append(response, "changed: playlist\n");
+	if (events & IDLE_EVENT_MIXER)
+		g_string_append(response, "changed: mixer\n");
+	g_string_append(response, "OK\n");
+
+	client->pendingIdleEvents&=~events;
+	client->idling=false;
+	this->Send(client, response->str, response->len);
+	g_string_free(response, TRUE);
+}
@@ -0,0 +1,112 @@
+/*
+ * FakeMPDServer.h
+ *
+ *  Created on: 17.10.2026
+ *      Author: joe
+ */
+
+#ifndef BENCH_FAKEMPDSERVER_H_
+#define BENCH_FAKEMPDSERVER_H_
+
+#include <glib.h>
+
+namespace retroradio_bench {
+
+#define FAKE_MPD_MAX_CLIENTS		8
+#define FAKE_MPD_LINE_BUFFER_SIZE	1024
+
+//Minimal mpd stand-in listening on a unix domain socket. It answers the commands the controller uses with
+//plausible responses, keeps a queue of a fixed number of stations and reports audio being produced
+//a configurable time after each play command.
+class FakeMPDServer {
+private:
+	typedef struct Client
+	{
+		FakeMPDServer *server;
+		int fd;
+		guint eventId;
+		char lineBuffer[FAKE_MPD_LINE_BUFFER_SIZE];
+		unsigned int lineLength;
+		bool idling;
+		unsigned int idleMask;
+		bool inCommandList;
+		bool commandListOk;
+		bool commandListFailed;
+		unsigned int commandListIdx;
+		GString *commandListResponse;
+		unsigned int pendingIdleEvents;
+	} Client;
+
+	enum IdleEvent
+	{
+		IDLE_EVENT_PLAYER	= 0x01,
+		IDLE_EVENT_PLAYLIST	= 0x02,
+		IDLE_EVENT_MIXER	= 0x04
+	};
+
+	char *socketPath;
+
+	int listenFd;
+
+	guint listenEventId;
+
+	Client clients[FAKE_MPD_MAX_CLIENTS];
+
+	unsigned int stationCnt;
+
+	unsigned int audioDelayMs;
+
+	bool playing;
+
+	unsigned int currentSong;
+
+	unsigned int queueLength;
+
+	unsigned int queueVersion;
+
+	bool repeat;
+
+	//monotonic time of the last play command
+	gint64 playStartTime;
+
+	static gboolean OnListenSocketEvent(gint fd, GIOCondition condition, gpointer user_data);
+
+	static gboolean OnClientSocketEvent(gint fd, GIOCondition condition, gpointer user_data);
+
+	void AcceptClient();
+
+	void CloseClient(Client *client);
+
+	void ReceiveLines(Client *client);
+
+	void ProcessLine(Client *client, char *line);
+
+	bool ExecuteCommand(Client *client, char **argv, int argc, unsigned int listIdx, GString *response);
+
+	void AppendStatus(GString *response);
+
+	void AppendPlaylistInfo(GString *response);
+
+	void NotifyIdleClients(unsigned int idleEvents);
+
+	void FlushIdle(Client *client);
+
+	static unsigned int ParseIdleMask(char **argv, int argc);
+
+	void Send(Client *client, const char *data, size_t len);
+
+	static int SplitArgs(char *line, char **argv, int maxArgs);
+
+public:
+	FakeMPDServer(unsigned int stationCnt, unsigned int audioDelayMs);
+
+	virtual ~FakeMPDServer();
+
+	bool Start(const char *socketPath);
+
+	void Stop();
+};
+
+} /* namespace retroradio_bench */
+
+#endif /* BENCH_FAKEMPDSERVER_H_ */
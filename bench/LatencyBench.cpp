@@ -0,0 +1,597 @@
+/*
+ * LatencyBench.cpp
+ *
+ *  Created on: 17.10.2026
+ *      Author: joe
+ */
+
+#include "LatencyBench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/wait.h>
+
+#include <algorithm>
+
+#include <alsa/asoundlib.h>
+
+#include <cpp-app-utils/Logger.h>
+
+#include "BenchStatistics.h"
+#include "LatencyTracer.h"
+#include "RemoteControllerProfiles.h"
+
+using namespace CppAppUtils;
+
+using namespace retroradio_bench;
+
+using retroradio_controller::RemoteControllerProfiles;
+
+#define DEFAULT_CARD_NAME				"hw:Loopback"
+#define DEFAULT_AUDIO_DELAY_MS			150
+#define FAKE_MPD_STATION_CNT			12
+
+#define PERSISTENCE_IMAGE_SIZE			(64*1024)
+
+#define DUMP_POLL_INTERVAL_MS			100
+#define DUMP_POLL_CNT_MAX				50
+
+//softvol pcms of the bench alsa configuration. Opening them once creates their mixer controls.
+static const char *softVolPcms[]={ "bench_mpc", "bench_lmc", "bench_dlna", "bench_main", NULL };
+
+//scan codes of the tv stick rc5 remote profile
+static const struct
+{
+	const char *name;
+	unsigned long long scancode;
+} keyTable[]=
+	{
+		{ "power",		0x0025 },
+		{ "vol_up",		0x0010 },
+		{ "vol_down",	0x0011 },
+		{ "mute",		0x000A },
+		{ "next",		0x0020 },
+		{ "prev",		0x0021 },
+		{ "source",		0x0019 },
+		{ "fav0",		0x0000 },
+		{ "fav1",		0x0001 },
+		{ "fav2",		0x0002 },
+		{ "fav3",		0x0003 },
+		{ "fav4",		0x0004 },
+		{ "fav5",		0x0005 },
+		{ "fav6",		0x0006 },
+		{ "fav7",		0x0007 },
+		{ "fav8",		0x0008 },
+		{ "fav9",		0x0009 },
+		{ NULL,			0 }
+	};
+
+const char *LatencyBench::categoryNames[__CATEGORY_CNT__]=
+	{
+		"volume",
+		"mute",
+		"next",
+		"favourite",
+		"power",
+		"other"
+	};
+
+LatencyBench::LatencyBench() :
+		controllerPath(NULL),
+		scriptPath(NULL),
+		alsaConfPath(NULL),
+		cardName(NULL),
+		workDir(NULL),
+		audioDelayMs(DEFAULT_AUDIO_DELAY_MS),
+		stepIdx(0),
+		stepKeyCnt(0),
+		controllerPid(0),
+		stepTimerId(0),
+		dumpWaitCnt(0),
+		result(EXIT_FAILURE)
+{
+	this->mainloop=g_main_loop_new(NULL, FALSE);
+	this->fakeMpd=NULL;
+	this->lircReplay=new LircReplay();
+}
+
+LatencyBench::~LatencyBench()
+{
+	this->StopController();
+
+	delete this->lircReplay;
+	if (this->fakeMpd!=NULL)
+		delete this->fakeMpd;
+
+	if (this->workDir!=NULL)
+	{
+		rmdir(this->workDir);
+		g_free(this->workDir);
+	}
+
+	g_free(this->controllerPath);
+	g_free(this->scriptPath);
+	g_free(this->alsaConfPath);
+	g_free(this->cardName);
+	g_main_loop_unref(this->mainloop);
+}
+
+bool LatencyBench::ParseArgs(int argc, char *argv[])
+{
+	GError *err=NULL;
+	GOptionContext *context;
+	gint audioDelay=DEFAULT_AUDIO_DELAY_MS;
+	GOptionEntry entries[]=
+		{
+			{ "controller", 0, 0, G_OPTION_ARG_FILENAME, &this->controllerPath, "Controller binary built against the bench stand-ins", "PATH" },
+			{ "script", 0, 0, G_OPTION_ARG_FILENAME, &this->scriptPath, "Key sequence to replay", "PATH" },
+			{ "alsa-conf", 0, 0, G_OPTION_ARG_FILENAME, &this->alsaConfPath, "Alsa configuration defining the bench softvol pcms", "PATH" },
+			{ "card", 0, 0, G_OPTION_ARG_STRING, &this->cardName, "Sound card holding the mixers (default " DEFAULT_CARD_NAME ")", "NAME" },
+			{ "audio-delay", 0, 0, G_OPTION_ARG_INT, &audioDelay, "Time the fake mpd needs to produce audio after play in ms", "MS" },
+			{ NULL }
+		};
+
+	context=g_option_context_new("- replays remote control keys and reports the controller's key press latency");
+	g_option_context_add_main_entries(context, entries, NULL);
+	if (!g_option_context_parse(context, &argc, &argv, &err))
+	{
+		fprintf(stderr, "%s\n", err->message);
+		g_error_free(err);
+		g_option_context_free(context);
+		return false;
+	}
+	g_option_context_free(context);
+
+	if (this->controllerPath==NULL || this->scriptPath==NULL || this->alsaConfPath==NULL)
+	{
+		fprintf(stderr, "--controller, --script and --alsa-conf are mandatory.\n");
+		return false;
+	}
+
+	if (this->cardName==NULL)
+		this->cardName=g_strdup(DEFAULT_CARD_NAME);
+
+	this->audioDelayMs=audioDelay>0 ? audioDelay : 0;
+
+	return this->LoadScript();
+}
+
+bool LatencyBench::LookupKey(const char *keyName, unsigned long long *scancode)
+{
+	for (int a=0; keyTable[a].name!=NULL; a++)
+	{
+		if (strcmp(keyTable[a].name, keyName)==0)
+		{
+			*scancode=keyTable[a].scancode;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool LatencyBench::LoadScript()
+{
+	FILE *f;
+	char line[256];
+	unsigned int lineNr=0;
+
+	f=fopen(this->scriptPath, "r");
+	if (f==NULL)
+	{
+		Logger::LogError("Failed to open key sequence %s: %s", this->scriptPath, strerror(errno));
+		return false;
+	}
+
+	//each line: <key> <count> <interval ms> or wait <ms>
+	while (fgets(line, sizeof(line), f)!=NULL)
+	{
+		char keyName[32];
+		unsigned int count, intervalMs;
+		KeyStep step;
+		int fields;
+
+		lineNr++;
+		if (line[0]=='#' || line[strspn(line, " \t\r\n")]=='\0')
+			continue;
+
+		fields=sscanf(line, "%31s %u %u", keyName, &count, &intervalMs);
+		if (fields==2 && strcmp(keyName, "wait")==0)
+		{
+			step.keyName=NULL;
+			step.scancode=0;
+			step.count=1;
+			step.intervalMs=count;
+		}
+		else if (fields==3 && count>0)
+		{
+			step.keyName=g_intern_string(keyName);
+			step.count=count;
+			step.intervalMs=intervalMs;
+			if (!this->LookupKey(keyName, &step.scancode))
+			{
+				Logger::LogError("Unknown key %s in line %u of %s.", keyName, lineNr, this->scriptPath);
+				fclose(f);
+				return false;
+			}
+		}
+		else
+		{
+			Logger::LogError("Malformed line %u in %s.", lineNr, this->scriptPath);
+			fclose(f);
+			return false;
+		}
+
+		this->steps.push_back(step);
+	}
+
+	fclose(f);
+	return true;
+}
+
+bool LatencyBench::PrepareMixers()
+{
+	snd_config_t *config;
+	snd_input_t *input;
+	snd_pcm_t *pcm;
+	int err;
+
+	if ((err=snd_config_top(&config))<0 ||
+			(err=snd_input_stdio_open(&input, this->alsaConfPath, "r"))<0)
+	{
+		Logger::LogError("Failed to read alsa configuration %s: %s", this->alsaConfPath, snd_strerror(err));
+		return false;
+	}
+
+	err=snd_config_load(config, input);
+	snd_input_close(input);
+	if (err<0)
+	{
+		Logger::LogError("Failed to parse alsa configuration %s: %s", this->alsaConfPath, snd_strerror(err));
+		snd_config_delete(config);
+		return false;
+	}
+
+	for (int a=0; softVolPcms[a]!=NULL; a++)
+	{
+		err=snd_pcm_open_lconf(&pcm, softVolPcms[a], SND_PCM_STREAM_PLAYBACK, SND_PCM_NONBLOCK, config);
+		if (err<0)
+		{
+			Logger::LogError("Failed to open bench pcm %s: %s. Is snd-aloop loaded?", softVolPcms[a], snd_strerror(err));
+			snd_config_delete(config);
+			return false;
+		}
+		snd_pcm_close(pcm);
+	}
+
+	snd_config_delete(config);
+	return true;
+}
+
+bool LatencyBench::WriteControllerConfig(const char *confPath)
+{
+	FILE *f;
+
+	f=fopen(confPath, "w");
+	if (f==NULL)
+	{
+		Logger::LogError("Failed to write controller configuration %s: %s", confPath, strerror(errno));
+		return false;
+	}
+
+	fprintf(f, "[MPD Source]\nSoundCardName = %s\nAlsaMixerName = mpc_vol\nMpdHost = %s/mpd.socket\n"
+			"RadioStationPlaylist = radio\n\n", this->cardName, this->workDir);
+	fprintf(f, "[LMC Source]\nSoundCardName = %s\nAlsaMixerName = lmc_vol\n\n", this->cardName);
+	fprintf(f, "[DLNA Source]\nSoundCardName = %s\nAlsaMixerName = dlna_vol\n\n", this->cardName);
+	fprintf(f, "[Persistence]\nFilePath = %s/persistence.img\n\n", this->workDir);
+	fprintf(f, "[MainVolumeControl]\nSndCardName = %s\nMainMixerName = Speaker\n\n", this->cardName);
+	fprintf(f, "[RemoteControl]\nInputDevice = %s/lirc.fifo\nRemoteProfile = TVStickRC5RemoteProfile\n",
+			this->workDir);
+
+	fclose(f);
+	return true;
+}
+
+bool LatencyBench::StartController()
+{
+	GError *err=NULL;
+	char *confPath;
+	char *imagePath;
+	int fd;
+	gboolean spawned;
+
+	confPath=g_strdup_printf("%s/retroradio.conf", this->workDir);
+	imagePath=g_strdup_printf("%s/persistence.img", this->workDir);
+
+	fd=open(imagePath, O_WRONLY|O_CREAT|O_TRUNC|O_CLOEXEC, 0600);
+	if (fd==-1 || ftruncate(fd, PERSISTENCE_IMAGE_SIZE)!=0)
+	{
+		Logger::LogError("Failed to create persistence image %s: %s", imagePath, strerror(errno));
+		if (fd!=-1) close(fd);
+		g_free(imagePath);
+		g_free(confPath);
+		return false;
+	}
+	close(fd);
+
+	if (!this->WriteControllerConfig(confPath))
+	{
+		g_free(imagePath);
+		g_free(confPath);
+		return false;
+	}
+
+	char *args[]={ this->controllerPath, (char *)"-c", confPath, NULL };
+	spawned=g_spawn_async(NULL, args, NULL, G_SPAWN_DO_NOT_REAP_CHILD, NULL, NULL, &this->controllerPid, &err);
+
+	g_free(imagePath);
+	g_free(confPath);
+
+	if (!spawned)
+	{
+		Logger::LogError("Failed to start controller %s: %s", this->controllerPath, err->message);
+		g_error_free(err);
+		return false;
+	}
+
+	return true;
+}
+
+void LatencyBench::StopController()
+{
+	char *path;
+
+	if (this->controllerPid!=0)
+	{
+		kill(this->controllerPid, SIGTERM);
+		waitpid(this->controllerPid, NULL, 0);
+		g_spawn_close_pid(this->controllerPid);
+		this->controllerPid=0;
+	}
+
+	if (this->workDir==NULL)
+		return;
+
+	path=g_strdup_printf("%s/retroradio.conf", this->workDir);
+	unlink(path);
+	g_free(path);
+	path=g_strdup_printf("%s/persistence.img", this->workDir);
+	unlink(path);
+	g_free(path);
+}
+
+void LatencyBench::ScheduleNextKey()
+{
+	KeyStep *step;
+
+	if (this->stepIdx>=this->steps.size())
+	{
+		this->RequestTraceDump();
+		return;
+	}
+
+	step=&this->steps[this->stepIdx];
+	this->stepTimerId=g_timeout_add(step->intervalMs, LatencyBench::OnStepTimerElapsed, this);
+}
+
+gboolean LatencyBench::OnStepTimerElapsed(gpointer data)
+{
+	LatencyBench *instance=(LatencyBench *)data;
+
+	instance->stepTimerId=0;
+	instance->ReplayKey();
+	instance->ScheduleNextKey();
+
+	return FALSE;
+}
+
+void LatencyBench::ReplayKey()
+{
+	KeyStep *step=&this->steps[this->stepIdx];
+
+	if (step->keyName!=NULL)
+		this->lircReplay->SendScanCode(step->scancode, RC_PROTO_RC5, false);
+
+	if (++this->stepKeyCnt>=step->count)
+	{
+		this->stepKeyCnt=0;
+		this->stepIdx++;
+	}
+}
+
+void LatencyBench::RequestTraceDump()
+{
+	Logger::LogInfo("Key sequence replayed. Requesting latency trace.");
+
+	unlink(LATENCY_TRACE_DUMP_PATH);
+	kill(this->controllerPid, SIGUSR1);
+
+	this->dumpWaitCnt=0;
+	g_timeout_add(DUMP_POLL_INTERVAL_MS, LatencyBench::OnDumpPollTimerElapsed, this);
+}
+
+bool LatencyBench::IsTraceDumpComplete()
+{
+	char *content;
+	gsize len;
+	bool complete;
+
+	if (!g_file_get_contents(LATENCY_TRACE_DUMP_PATH, &content, &len, NULL))
+		return false;
+
+	complete=len>=3 && strcmp(content+len-3, "]}\n")==0;
+	g_free(content);
+
+	return complete;
+}
+
+gboolean LatencyBench::OnDumpPollTimerElapsed(gpointer data)
+{
+	LatencyBench *instance=(LatencyBench *)data;
+
+	if (instance->IsTraceDumpComplete())
+	{
+		if (instance->EvaluateTrace(LATENCY_TRACE_DUMP_PATH))
+		{
+			instance->PrintReport();
+			instance->result=EXIT_SUCCESS;
+		}
+		g_main_loop_quit(instance->mainloop);
+		return FALSE;
+	}
+
+	if (++instance->dumpWaitCnt>=DUMP_POLL_CNT_MAX)
+	{
+		Logger::LogError("Controller did not dump the latency trace to %s.", LATENCY_TRACE_DUMP_PATH);
+		g_main_loop_quit(instance->mainloop);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+LatencyBench::KeyCategory LatencyBench::GetCategoryOfCommand(int cmd)
+{
+	switch ((RemoteControllerProfiles::RemoteCommand)cmd)
+	{
+	case RemoteControllerProfiles::CMD_VOL_UP:
+	case RemoteControllerProfiles::CMD_VOL_DOWN:
+		return CATEGORY_VOLUME;
+	case RemoteControllerProfiles::CMD_MUTE:
+		return CATEGORY_MUTE;
+	case RemoteControllerProfiles::CMD_NEXT:
+	case RemoteControllerProfiles::CMD_PREV:
+		return CATEGORY_NEXT;
+	case RemoteControllerProfiles::CMD_FAV0:
+	case RemoteControllerProfiles::CMD_FAV1:
+	case RemoteControllerProfiles::CMD_FAV2:
+	case RemoteControllerProfiles::CMD_FAV3:
+	case RemoteControllerProfiles::CMD_FAV4:
+	case RemoteControllerProfiles::CMD_FAV5:
+	case RemoteControllerProfiles::CMD_FAV6:
+	case RemoteControllerProfiles::CMD_FAV7:
+	case RemoteControllerProfiles::CMD_FAV8:
+	case RemoteControllerProfiles::CMD_FAV9:
+		return CATEGORY_FAVORITE;
+	case RemoteControllerProfiles::CMD_POWER:
+		return CATEGORY_POWER;
+	default:
+		return CATEGORY_OTHER;
+	}
+}
+
+bool LatencyBench::EvaluateTrace(const char *tracePath)
+{
+	FILE *f;
+	char line[512];
+	GHashTable *spans;
+
+	f=fopen(tracePath, "r");
+	if (f==NULL)
+	{
+		Logger::LogError("Failed to open latency trace %s: %s", tracePath, strerror(errno));
+		return false;
+	}
+
+	//span id -> begin event line. The latency of a key press is the time until its last recorded stage.
+	spans=g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, g_free);
+
+	while (fgets(line, sizeof(line), f)!=NULL)
+	{
+		const char *ph=strstr(line, "\"ph\":\"");
+		const char *id=strstr(line, "\"id\":");
+		const char *ts=strstr(line, "\"ts\":");
+		unsigned int spanId;
+		gint64 timestamp;
+
+		if (ph==NULL || id==NULL || ts==NULL) continue;
+		if (sscanf(id+5, "%u", &spanId)!=1 || sscanf(ts+5, "%" G_GINT64_FORMAT, &timestamp)!=1) continue;
+
+		if (ph[6]=='b')
+		{
+			const char *arg=strstr(line, "\"arg\":");
+			gint64 *begin=g_new(gint64, 2);
+			int cmd=0;
+
+			if (arg!=NULL) sscanf(arg+6, "%d", &cmd);
+			begin[0]=timestamp;
+			begin[1]=cmd;
+			g_hash_table_insert(spans, GUINT_TO_POINTER(spanId), begin);
+		}
+		else if (ph[6]=='e')
+		{
+			gint64 *begin=(gint64 *)g_hash_table_lookup(spans, GUINT_TO_POINTER(spanId));
+
+			//spans without any stage after the key press did not reach the controller's actions
+			if (begin!=NULL && timestamp>begin[0])
+				this->latencies[LatencyBench::GetCategoryOfCommand((int)begin[1])].push_back(timestamp-begin[0]);
+		}
+	}
+
+	g_hash_table_destroy(spans);
+	fclose(f);
+	return true;
+}
+
+void LatencyBench::PrintReport()
+{
+	printf("\n%-10s %7s %10s %10s %10s\n", "key", "count", "p50 [ms]", "p99 [ms]", "max [ms]");
+
+	for (int a=0; a<__CATEGORY_CNT__; a++)
+	{
+		std::vector<gint64> &values=this->latencies[a];
+
+		if (values.empty()) continue;
+
+		std::sort(values.begin(), values.end());
+		printf("%-10s %7zu %10.1f %10.1f %10.1f\n", LatencyBench::categoryNames[a], values.size(),
+				BenchStatistics::Percentile(values, 50)/1000.0, BenchStatistics::Percentile(values, 99)/1000.0,
+				values.back()/1000.0);
+	}
+}
+
+int LatencyBench::Run()
+{
+	char *path;
+	bool started;
+
+	if (!this->PrepareMixers())
+		return EXIT_FAILURE;
+
+	this->workDir=g_dir_make_tmp("retroradio-bench-XXXXXX", NULL);
+	if (this->workDir==NULL)
+	{
+		Logger::LogError("Failed to create bench working directory.");
+		return EXIT_FAILURE;
+	}
+
+	this->fakeMpd=new FakeMPDServer(FAKE_MPD_STATION_CNT, this->audioDelayMs);
+	path=g_strdup_printf("%s/mpd.socket", this->workDir);
+	started=this->fakeMpd->Start(path);
+	g_free(path);
+	if (!started)
+		return EXIT_FAILURE;
+
+	path=g_strdup_printf("%s/lirc.fifo", this->workDir);
+	started=this->lircReplay->Open(path);
+	g_free(path);
+	if (!started)
+		return EXIT_FAILURE;
+
+	if (!this->StartController())
+		return EXIT_FAILURE;
+
+	this->ScheduleNextKey();
+	g_main_loop_run(this->mainloop);
+
+	this->StopController();
+	this->lircReplay->Close();
+	this->fakeMpd->Stop();
+
+	return this->result;
+}
@@ -0,0 +1,123 @@
+/*
+ * LatencyBench.h
+ *
+ *  Created on: 17.10.2026
+ *      Author: joe
+ */
+
+#ifndef BENCH_LATENCYBENCH_H_
+#define BENCH_LATENCYBENCH_H_
+
+#include <vector>
+
+#include <glib.h>
+
+#include "FakeMPDServer.h"
+#include "LircReplay.h"
+
+namespace retroradio_bench {
+
+//Runs the controller against the fake mpd and the lirc replay fifo, replays a scripted key sequence and
+//evaluates the latency trace the controller dumps on SIGUSR1.
+class LatencyBench {
+public:
+	enum KeyCategory
+	{
+		CATEGORY_VOLUME,
+		CATEGORY_MUTE,
+		CATEGORY_NEXT,
+		CATEGORY_FAVORITE,
+		CATEGORY_POWER,
+		CATEGORY_OTHER,
+		__CATEGORY_CNT__
+	};
+
+private:
+	typedef struct KeyStep
+	{
+		//scan code of the tv stick rc5 remote profile, NULL key for a pause
+		const char *keyName;
+		unsigned long long scancode;
+		unsigned int count;
+		unsigned int intervalMs;
+	} KeyStep;
+
+	GMainLoop *mainloop;
+
+	FakeMPDServer *fakeMpd;
+
+	LircReplay *lircReplay;
+
+	char *controllerPath;
+
+	char *scriptPath;
+
+	char *alsaConfPath;
+
+	char *cardName;
+
+	char *workDir;
+
+	unsigned int audioDelayMs;
+
+	std::vector<KeyStep> steps;
+
+	unsigned int stepIdx;
+
+	unsigned int stepKeyCnt;
+
+	GPid controllerPid;
+
+	guint stepTimerId;
+
+	unsigned int dumpWaitCnt;
+
+	int result;
+
+	std::vector<gint64> latencies[__CATEGORY_CNT__];
+
+	static const char *categoryNames[__CATEGORY_CNT__];
+
+	bool LoadScript();
+
+	bool LookupKey(const char *keyName, unsigned long long *scancode);
+
+	bool PrepareMixers();
+
+	bool WriteControllerConfig(const char *confPath);
+
+	bool StartController();
+
+	void StopController();
+
+	void ScheduleNextKey();
+
+	static gboolean OnStepTimerElapsed(gpointer data);
+
+	void ReplayKey();
+
+	void RequestTraceDump();
+
+	static gboolean OnDumpPollTimerElapsed(gpointer data);
+
+	bool IsTraceDumpComplete();
+
+	bool EvaluateTrace(const char *tracePath);
+
+	static KeyCategory GetCategoryOfCommand(int cmd);
+
+	void PrintReport();
+
+public:
+	LatencyBench();
+
+	virtual ~LatencyBench();
+
+	bool ParseArgs(int argc, char *argv[]);
+
+	int Run();
+};
+
+} /* namespace retroradio_bench */
+
+#endif /* BENCH_LATENCYBENCH_H_ */
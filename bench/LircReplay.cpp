@@ -0,0 +1,94 @@
+/*
+ * LircReplay.cpp
+ *
+ *  Created on: 17.10.2026
+ *      Author: joe
+ */
+
+#include "LircReplay.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include <cpp-app-utils/Logger.h>
+
+using namespace CppAppUtils;
+
+using namespace retroradio_bench;
+
+LircReplay::LircReplay() :
+		fifoPath(NULL),
+		fifoFd(-1)
+{
+}
+
+LircReplay::~LircReplay()
+{
+	this->Close();
+}
+
+bool LircReplay::Open(const char *fifoPath)
+{
+	unlink(fifoPath);
+	if (mkfifo(fifoPath, 0600)!=0)
+	{
+		Logger::LogError("Failed to create lirc replay fifo %s: %s", fifoPath, strerror(errno));
+		return false;
+	}
+
+	//opened read-write so the fifo never signals a hang up to the controller while no key is replayed
+	this->fifoFd=open(fifoPath, O_RDWR|O_NONBLOCK|O_CLOEXEC);
+	if (this->fifoFd==-1)
+	{
+		Logger::LogError("Failed to open lirc replay fifo %s: %s", fifoPath, strerror(errno));
+		unlink(fifoPath);
+		return false;
+	}
+
+	this->fifoPath=strdup(fifoPath);
+	return true;
+}
+
+void LircReplay::Close()
+{
+	if (this->fifoFd!=-1)
+	{
+		close(this->fifoFd);
+		this->fifoFd=-1;
+	}
+
+	if (this->fifoPath!=NULL)
+	{
+		unlink(this->fifoPath);
+		free(this->fifoPath);
+		this->fifoPath=NULL;
+	}
+}
+
+bool LircReplay::SendScanCode(unsigned long long scancode, unsigned int rcProto, bool repeated)
+{
+	struct lirc_scancode sc;
+	struct timespec now;
+
+	memset(&sc, 0, sizeof(sc));
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	sc.timestamp=(unsigned long long)now.tv_sec*1000000000ULL+now.tv_nsec;
+	sc.flags=repeated ? LIRC_SCANCODE_FLAG_REPEAT : 0;
+	sc.rc_proto=rcProto;
+	sc.keycode=0;
+	sc.scancode=scancode;
+
+	//records are far smaller than PIPE_BUF and thus written atomically
+	if (write(this->fifoFd, &sc, sizeof(sc))!=sizeof(sc))
+	{
+		Logger::LogError("Failed to write scan code to lirc replay fifo: %s", strerror(errno));
+		return false;
+	}
+
+	return true;
+}
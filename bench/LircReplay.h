@@ -0,0 +1,37 @@
+/*
+ * LircReplay.h
+ *
+ *  Created on: 17.10.2026
+ *      Author: joe
+ */
+
+#ifndef BENCH_LIRCREPLAY_H_
+#define BENCH_LIRCREPLAY_H_
+
+#include <linux/lirc.h>
+
+namespace retroradio_bench {
+
+//Feeds lirc_scancode records into a fifo configured as the controller's InputDevice. The records carry a
+//CLOCK_MONOTONIC timestamp taken right before writing them, like the lirc driver does on reception.
+class LircReplay {
+private:
+	char *fifoPath;
+
+	int fifoFd;
+
+public:
+	LircReplay();
+
+	virtual ~LircReplay();
+
+	bool Open(const char *fifoPath);
+
+	void Close();
+
+	bool SendScanCode(unsigned long long scancode, unsigned int rcProto, bool repeated);
+};
+
+} /* namespace retroradio_bench */
+
+#endif /* BENCH_LIRCREPLAY_H_ */
@@ -0,0 +1,481 @@
+/*
+ * PersistenceBench.cpp
+ *
+ *  Created on: 17.10.2026
+ *      Author: joe
+ */
+
+#include "PersistenceBench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+
+#include <cpp-app-utils/Logger.h>
+
+#include "BenchStatistics.h"
+#include "Logging.h"
+#include "PersistentStateJournal.h"
+
+using namespace CppAppUtils;
+
+using namespace retroradio_controller;
+
+using namespace retroradio_bench;
+
+#define DEFAULT_ACTION_CNT				20
+#define DEFAULT_ROUND_CNT				200
+
+//longer than the 2xCOMIT_TIMOUT_MS debounce of delayed commits
+#define PHASE_SETTLE_MS					1500
+
+//commits written before the torn one in each power loss round
+#define ROUND_GOOD_COMMITS_MAX			4
+
+const PersistenceBench::Phase PersistenceBench::phases[]=
+	{
+		{ "volume repeat",		COMMIT_DELAYED,		110 },
+		{ "delayed 300 ms",		COMMIT_DELAYED,		300 },
+		{ "delayed 700 ms",		COMMIT_DELAYED,		700 },
+		{ "track change",		COMMIT_DELAYED,		1500 },
+		{ "power toggle",		COMMIT_IMMEDIATE,	500 },
+		{ NULL,					COMMIT_DELAYED,		0 }
+	};
+
+const char *PersistenceBench::faultNames[__FAULT_CNT__]=
+	{
+		"partial",
+		"truncated"
+	};
+
+const char *PersistenceBench::outcomeNames[__OUTCOME_CNT__]=
+	{
+		"newest",
+		"previous",
+		"reset to default",
+		"corrupt"
+	};
+
+PersistenceBench::PersistenceBench() :
+		configuration(NULL),
+		state(NULL),
+		imagePath(NULL),
+		workDir(NULL),
+		journalSize(JOURNAL_DEFAULT_SIZE),
+		actionCnt(DEFAULT_ACTION_CNT),
+		roundCnt(DEFAULT_ROUND_CNT),
+		seed(0),
+		value(0),
+		phaseIdx(0),
+		phaseActionIdx(0),
+		phaseStartWrites(0),
+		result(EXIT_FAILURE)
+{
+	this->mainloop=g_main_loop_new(NULL, FALSE);
+	memset(this->faultCnt, 0, sizeof(this->faultCnt));
+	memset(this->corruptingFaultCnt, 0, sizeof(this->corruptingFaultCnt));
+	memset(this->outcomeCnt, 0, sizeof(this->outcomeCnt));
+}
+
+PersistenceBench::~PersistenceBench()
+{
+	if (this->state!=NULL)
+		this->state->DeInit();
+	this->DropState();
+
+	if (this->workDir!=NULL)
+	{
+		unlink(this->imagePath);
+		rmdir(this->workDir);
+		g_free(this->workDir);
+	}
+
+	g_free(this->imagePath);
+	g_main_loop_unref(this->mainloop);
+}
+
+bool PersistenceBench::ParseArgs(int argc, char *argv[])
+{
+	GError *err=NULL;
+	GOptionContext *context;
+	GOptionEntry entries[]=
+		{
+			{ "image", 0, 0, G_OPTION_ARG_FILENAME, &this->imagePath, "File or loop device holding the journal. Its content is destroyed (default: temporary file)", "PATH" },
+			{ "journal-size", 0, 0, G_OPTION_ARG_INT, &this->journalSize, "Bytes of the image used by the journal", "BYTES" },
+			{ "actions", 0, 0, G_OPTION_ARG_INT, &this->actionCnt, "User actions per commit phase", "COUNT" },
+			{ "rounds", 0, 0, G_OPTION_ARG_INT, &this->roundCnt, "Power loss rounds", "COUNT" },
+			{ "seed", 0, 0, G_OPTION_ARG_INT, &this->seed, "Seed of the fault injection (default: random)", "SEED" },
+			{ NULL }
+		};
+
+	context=g_option_context_new("- measures commit latency and recovery of the persistent state under power loss");
+	g_option_context_add_main_entries(context, entries, NULL);
+	if (!g_option_context_parse(context, &argc, &argv, &err))
+	{
+		fprintf(stderr, "%s\n", err->message);
+		g_error_free(err);
+		g_option_context_free(context);
+		return false;
+	}
+	g_option_context_free(context);
+
+	if (this->journalSize<2*JOURNAL_SLOT_SIZE || this->actionCnt<1 || this->roundCnt<0)
+	{
+		fprintf(stderr, "--journal-size must be at least %u, --actions at least 1.\n", 2*JOURNAL_SLOT_SIZE);
+		return false;
+	}
+
+	if (this->seed==0)
+		this->seed=(gint)g_random_int();
+
+	return true;
+}
+
+bool PersistenceBench::PrepareImage()
+{
+	unsigned char *zeros;
+	bool written;
+	int fd;
+
+	if (this->imagePath==NULL)
+	{
+		this->workDir=g_dir_make_tmp("retroradio-persistence-bench-XXXXXX", NULL);
+		if (this->workDir==NULL)
+		{
+			Logger::LogError("Failed to create bench working directory.");
+			return false;
+		}
+		this->imagePath=g_strdup_printf("%s/persistence.img", this->workDir);
+	}
+
+	//records of earlier runs would be taken for newer ones
+	fd=open(this->imagePath, O_WRONLY|O_CREAT|O_CLOEXEC, 0600);
+	if (fd==-1)
+	{
+		Logger::LogError("Failed to open image %s: %s", this->imagePath, strerror(errno));
+		return false;
+	}
+
+	zeros=(unsigned char *)g_malloc0(this->journalSize);
+	written=pwrite(fd, zeros, this->journalSize, 0)==this->journalSize && fsync(fd)==0;
+	g_free(zeros);
+	close(fd);
+
+	if (!written)
+	{
+		Logger::LogError("Failed to clear image %s: %s", this->imagePath, strerror(errno));
+		return false;
+	}
+
+	return true;
+}
+
+bool PersistenceBench::CreateState()
+{
+	this->configuration=new BenchConfiguration();
+	this->state=new BenchPersistentState(this->configuration);
+
+	//debug messages of every commit would distort the timings
+	LogLevelCache::Refresh();
+
+	if (!this->state->Configure(this->imagePath, this->journalSize))
+	{
+		Logger::LogError("Failed to configure persistent state.");
+		return false;
+	}
+
+	this->state->Init();
+	return true;
+}
+
+void PersistenceBench::DropState()
+{
+	delete this->state;
+	this->state=NULL;
+	delete this->configuration;
+	this->configuration=NULL;
+}
+
+void PersistenceBench::StartPhase()
+{
+	const Phase *phase=&PersistenceBench::phases[this->phaseIdx];
+	PhaseResult phaseResult;
+
+	if (phase->name==NULL)
+	{
+		this->RunPowerLossRounds();
+		g_main_loop_quit(this->mainloop);
+		return;
+	}
+
+	Logger::LogInfo("Commit phase %s: %d actions every %u ms.", phase->name, this->actionCnt, phase->intervalMs);
+
+	memset(&phaseResult, 0, sizeof(phaseResult));
+	this->phaseResults.push_back(phaseResult);
+	this->phaseActionIdx=0;
+	this->phaseStartWrites=this->state->GetCommitCount();
+	this->state->ResetCommitLatencyStatistics();
+
+	g_timeout_add(phase->intervalMs, PersistenceBench::OnActionTimerElapsed, this);
+}
+
+gboolean PersistenceBench::OnActionTimerElapsed(gpointer data)
+{
+	PersistenceBench *instance=(PersistenceBench *)data;
+	const Phase *phase=&PersistenceBench::phases[instance->phaseIdx];
+	PhaseResult *phaseResult=&instance->phaseResults.back();
+	gint64 start, duration;
+
+	start=g_get_monotonic_time();
+	instance->state->SetValue(++instance->value, phase->mode==COMMIT_IMMEDIATE);
+	duration=g_get_monotonic_time()-start;
+
+	phaseResult->actions++;
+	phaseResult->callSumUs+=duration;
+	if (duration>phaseResult->callMaxUs)
+		phaseResult->callMaxUs=duration;
+
+	if (++instance->phaseActionIdx<(unsigned int)instance->actionCnt)
+		return TRUE;
+
+	//delayed commits are written once the debounce elapsed
+	g_timeout_add(PHASE_SETTLE_MS, PersistenceBench::OnPhaseSettled, instance);
+	return FALSE;
+}
+
+gboolean PersistenceBench::OnPhaseSettled(gpointer data)
+{
+	PersistenceBench *instance=(PersistenceBench *)data;
+
+	instance->FinishPhase();
+	instance->phaseIdx++;
+	instance->StartPhase();
+
+	return FALSE;
+}
+
+void PersistenceBench::FinishPhase()
+{
+	PhaseResult *phaseResult=&this->phaseResults.back();
+
+	this->state->Flush();
+	phaseResult->writes=this->state->GetCommitCount()-this->phaseStartWrites;
+	phaseResult->latencyAvgUs=this->state->GetCommitLatencyAvgUs();
+	phaseResult->latencyMaxUs=this->state->GetCommitLatencyMaxUs();
+}
+
+unsigned char *PersistenceBench::ReadImage(off_t *fileSize)
+{
+	unsigned char *content;
+	struct stat fileStat;
+	ssize_t size;
+	int fd;
+
+	fd=open(this->imagePath, O_RDONLY|O_CLOEXEC);
+	if (fd==-1)
+	{
+		Logger::LogError("Failed to open image %s: %s", this->imagePath, strerror(errno));
+		return NULL;
+	}
+
+	//a regular file ends behind the last slot written
+	content=(unsigned char *)g_malloc0(this->journalSize);
+	size=pread(fd, content, this->journalSize, 0);
+	*fileSize=(fstat(fd, &fileStat)==0 && S_ISREG(fileStat.st_mode)) ? fileStat.st_size : -1;
+	close(fd);
+
+	if (size<0)
+	{
+		Logger::LogError("Failed to read image %s: %s", this->imagePath, strerror(errno));
+		g_free(content);
+		return NULL;
+	}
+
+	return content;
+}
+
+bool PersistenceBench::InjectFault(const unsigned char *before, off_t beforeSize, const unsigned char *after)
+{
+	FaultMode mode=(FaultMode)g_random_int_range(0, __FAULT_CNT__);
+	unsigned int recordSize=PersistentStateJournal::GetRecordSize(BenchPersistentState::GetDataSetSize());
+	//a tear behind the record only hits the zero padding of the slot
+	unsigned int tearOffset=g_random_int_range(0, recordSize);
+	unsigned char torn[JOURNAL_SLOT_SIZE];
+	off_t slotStart=-1;
+	off_t tearPos;
+	bool corrupted;
+	bool result;
+	int fd;
+
+	for (gint a=0; a<this->journalSize; a++)
+	{
+		if (before[a]!=after[a])
+		{
+			slotStart=(a/JOURNAL_SLOT_SIZE)*JOURNAL_SLOT_SIZE;
+			break;
+		}
+	}
+
+	if (slotStart<0)
+	{
+		Logger::LogError("Last commit not found in image %s.", this->imagePath);
+		return false;
+	}
+
+	fd=open(this->imagePath, O_WRONLY|O_CLOEXEC);
+	if (fd==-1)
+	{
+		Logger::LogError("Failed to open image %s: %s", this->imagePath, strerror(errno));
+		return false;
+	}
+
+	//only the first tearOffset bytes of the slot made it to the storage
+	tearPos=slotStart+tearOffset;
+	memcpy(torn, after+slotStart, tearOffset);
+	if (mode==FAULT_PARTIAL)
+		memcpy(torn+tearOffset, before+tearPos, JOURNAL_SLOT_SIZE-tearOffset);
+	else
+		memset(torn+tearOffset, 0, JOURNAL_SLOT_SIZE-tearOffset);
+
+	//the old content may match the new record behind the tear
+	corrupted=memcmp(torn, after+slotStart, recordSize)!=0;
+
+	if (mode==FAULT_TRUNCATED && beforeSize>=0 && beforeSize<=slotStart)
+		result=ftruncate(fd, tearPos)==0;
+	else
+		result=pwrite(fd, torn+tearOffset, JOURNAL_SLOT_SIZE-tearOffset, tearPos)==JOURNAL_SLOT_SIZE-tearOffset;
+	result=result && fsync(fd)==0;
+	close(fd);
+
+	if (!result)
+	{
+		Logger::LogError("Failed to tear record in image %s: %s", this->imagePath, strerror(errno));
+		return false;
+	}
+
+	this->faultCnt[mode]++;
+	if (corrupted)
+		this->corruptingFaultCnt[mode]++;
+	return true;
+}
+
+bool PersistenceBench::RunPowerLossRound()
+{
+	unsigned int goodCommits=g_random_int_range(1, ROUND_GOOD_COMMITS_MAX+1);
+	unsigned char *before, *after;
+	off_t beforeSize, afterSize;
+	guint32 previous, newest, recovered;
+	gint64 start;
+	bool injected;
+
+	for (unsigned int a=0; a<goodCommits; a++)
+	{
+		this->state->SetValue(++this->value, true);
+		this->state->Flush();
+	}
+	previous=this->value;
+
+	before=this->ReadImage(&beforeSize);
+	if (before==NULL)
+		return false;
+
+	newest=++this->value;
+	this->state->SetValue(newest, true);
+	this->state->Flush();
+	this->DropState();
+
+	after=this->ReadImage(&afterSize);
+	injected=after!=NULL && this->InjectFault(before, beforeSize, after);
+	g_free(before);
+	g_free(after);
+	if (!injected)
+		return false;
+
+	start=g_get_monotonic_time();
+	if (!this->CreateState())
+		return false;
+	this->recoverTimes.push_back(g_get_monotonic_time()-start);
+
+	recovered=this->state->GetValue();
+	if (recovered==newest)
+		this->outcomeCnt[OUTCOME_NEWEST]++;
+	else if (recovered==previous)
+		this->outcomeCnt[OUTCOME_PREVIOUS]++;
+	else if (recovered==0)
+		this->outcomeCnt[OUTCOME_RESET]++;
+	else
+		this->outcomeCnt[OUTCOME_CORRUPT]++;
+
+	return true;
+}
+
+void PersistenceBench::RunPowerLossRounds()
+{
+	Logger::LogInfo("Running %d power loss rounds with seed %d.", this->roundCnt, this->seed);
+	g_random_set_seed((guint32)this->seed);
+
+	for (gint a=0; a<this->roundCnt; a++)
+	{
+		if (!this->RunPowerLossRound())
+			return;
+	}
+
+	this->PrintReport();
+
+	if (this->outcomeCnt[OUTCOME_RESET]==0 && this->outcomeCnt[OUTCOME_CORRUPT]==0)
+		this->result=EXIT_SUCCESS;
+}
+
+void PersistenceBench::PrintReport()
+{
+	printf("\n%-16s %7s %7s %8s %12s %12s %14s %14s\n", "phase", "actions", "writes", "writes/", "call avg",
+			"call max", "commit avg", "commit max");
+	printf("%-16s %7s %7s %8s %12s %12s %14s %14s\n", "", "", "", "action", "[us]", "[us]", "[us]", "[us]");
+
+	for (unsigned int a=0; a<this->phaseResults.size(); a++)
+	{
+		PhaseResult *phaseResult=&this->phaseResults[a];
+
+		printf("%-16s %7u %7u %8.2f %12lld %12lld %14lld %14lld\n", PersistenceBench::phases[a].name,
+				phaseResult->actions, phaseResult->writes, (double)phaseResult->writes/phaseResult->actions,
+				(long long)(phaseResult->callSumUs/phaseResult->actions), (long long)phaseResult->callMaxUs,
+				(long long)phaseResult->latencyAvgUs, (long long)phaseResult->latencyMaxUs);
+	}
+
+	printf("\npower loss rounds: %u (seed %d)\n", (unsigned int)this->recoverTimes.size(), this->seed);
+	for (int a=0; a<__FAULT_CNT__; a++)
+		printf("  %-18s %7u (%u corrupted the record)\n", PersistenceBench::faultNames[a], this->faultCnt[a],
+				this->corruptingFaultCnt[a]);
+
+	printf("recovered state:\n");
+	for (int a=0; a<__OUTCOME_CNT__; a++)
+		printf("  %-18s %7u\n", PersistenceBench::outcomeNames[a], this->outcomeCnt[a]);
+
+	if (!this->recoverTimes.empty())
+	{
+		std::sort(this->recoverTimes.begin(), this->recoverTimes.end());
+		printf("time to recover: p50 %.1f ms, p99 %.1f ms, max %.1f ms\n",
+				BenchStatistics::Percentile(this->recoverTimes, 50)/1000.0,
+				BenchStatistics::Percentile(this->recoverTimes, 99)/1000.0, this->recoverTimes.back()/1000.0);
+	}
+}
+
+int PersistenceBench::Run()
+{
+	if (!this->PrepareImage())
+		return EXIT_FAILURE;
+
+	if (!this->CreateState())
+		return EXIT_FAILURE;
+
+	this->StartPhase();
+	g_main_loop_run(this->mainloop);
+
+	return this->result;
+}
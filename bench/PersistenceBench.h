@@ -0,0 +1,149 @@
+/*
+ * PersistenceBench.h
+ *
+ *  Created on: 17.10.2026
+ *      Author: joe
+ */
+
+#ifndef BENCH_PERSISTENCEBENCH_H_
+#define BENCH_PERSISTENCEBENCH_H_
+
+#include <vector>
+
+#include <glib.h>
+
+#include "BenchPersistentState.h"
+
+namespace retroradio_bench {
+
+//Drives the controller's persistence against a file or loop device image. Commit phases replay user actions
+//at fixed intervals and report writes per action and commit latency. Power loss rounds tear the last written
+//record at a random offset within the record and report which state is recovered and how long recovery takes.
+class PersistenceBench {
+public:
+	enum CommitMode
+	{
+		COMMIT_DELAYED,
+		COMMIT_IMMEDIATE
+	};
+
+	enum FaultMode
+	{
+		//the tail of the record keeps the old content of the slot
+		FAULT_PARTIAL,
+		//the write stopped, the tail is zero or the file ends
+		FAULT_TRUNCATED,
+		__FAULT_CNT__
+	};
+
+	enum RecoveryOutcome
+	{
+		OUTCOME_NEWEST,
+		OUTCOME_PREVIOUS,
+		OUTCOME_RESET,
+		OUTCOME_CORRUPT,
+		__OUTCOME_CNT__
+	};
+
+private:
+	typedef struct Phase
+	{
+		const char *name;
+		CommitMode mode;
+		unsigned int intervalMs;
+	} Phase;
+
+	typedef struct PhaseResult
+	{
+		unsigned int actions;
+		unsigned int writes;
+		//time the main loop spends in the commit call
+		gint64 callSumUs;
+		gint64 callMaxUs;
+		gint64 latencyAvgUs;
+		gint64 latencyMaxUs;
+	} PhaseResult;
+
+	GMainLoop *mainloop;
+
+	BenchConfiguration *configuration;
+
+	BenchPersistentState *state;
+
+	char *imagePath;
+
+	char *workDir;
+
+	gint journalSize;
+
+	gint actionCnt;
+
+	gint roundCnt;
+
+	gint seed;
+
+	guint32 value;
+
+	unsigned int phaseIdx;
+
+	unsigned int phaseActionIdx;
+
+	unsigned int phaseStartWrites;
+
+	std::vector<PhaseResult> phaseResults;
+
+	unsigned int faultCnt[__FAULT_CNT__];
+
+	//faults which left the record different from the one written. The others tore behind differing bytes only.
+	unsigned int corruptingFaultCnt[__FAULT_CNT__];
+
+	unsigned int outcomeCnt[__OUTCOME_CNT__];
+
+	std::vector<gint64> recoverTimes;
+
+	int result;
+
+	static const Phase phases[];
+
+	static const char *faultNames[__FAULT_CNT__];
+
+	static const char *outcomeNames[__OUTCOME_CNT__];
+
+	bool PrepareImage();
+
+	bool CreateState();
+
+	//power loss. The state is dropped without deinitialization.
+	void DropState();
+
+	void StartPhase();
+
+	static gboolean OnActionTimerElapsed(gpointer data);
+
+	static gboolean OnPhaseSettled(gpointer data);
+
+	void FinishPhase();
+
+	void RunPowerLossRounds();
+
+	bool RunPowerLossRound();
+
+	unsigned char *ReadImage(off_t *fileSize);
+
+	bool InjectFault(const unsigned char *before, off_t beforeSize, const unsigned char *after);
+
+	void PrintReport();
+
+public:
+	PersistenceBench();
+
+	virtual ~PersistenceBench();
+
+	bool ParseArgs(int argc, char *argv[]);
+
+	int Run();
+};
+
+} /* namespace retroradio_bench */
+
+#endif /* BENCH_PERSISTENCEBENCH_H_ */
@@ -0,0 +1,27 @@
+/*
+ * PersistenceBenchMain.cpp
+ *
+ *  Created on: 17.10.2026
+ *      Author: joe
+ */
+#include <stdlib.h>
+
+#include "PersistenceBench.h"
+
+using namespace retroradio_bench;
+
+int main (int argc, char **argv)
+{
+	int result;
+
+	PersistenceBench *bench=new PersistenceBench();
+
+	if (bench->ParseArgs(argc, argv))
+		result=bench->Run();
+	else
+		result=EXIT_FAILURE;
+
+	delete bench;
+
+	return result;
+}
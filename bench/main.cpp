@@ -0,0 +1,27 @@
+/*
+ * main.cpp
+ *
+ *  Created on: 17.10.2026
+ *      Author: joe
+ */
+#include <stdlib.h>
+
+#include "LatencyBench.h"
+
+using namespace retroradio_bench;
+
+int main (int argc, char **argv)
+{
+	int result;
+
+	LatencyBench *bench=new LatencyBench();
+
+	if (bench->ParseArgs(argc, argv))
+		result=bench->Run();
+	else
+		result=EXIT_FAILURE;
+
+	delete bench;
+
+	return result;
+}
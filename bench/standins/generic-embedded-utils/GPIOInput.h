@@ -0,0 +1,36 @@
+/*
+ * GPIOInput.h
+ *
+ *  Created on: 17.10.2026
+ *      Author: joe
+ */
+
+#ifndef BENCH_STANDINS_GPIOINPUT_H_
+#define BENCH_STANDINS_GPIOINPUT_H_
+
+//Stand-in replacing the sysfs gpio input of generic-embedded-utils for the latency bench build. The power
+//button is never pressed, the radio is switched on and off by the replayed remote control power key.
+namespace GenericEmbeddedUtils {
+
+class GPIOInput {
+public:
+	class IGpioValueListener
+	{
+	public:
+		virtual void OnValueChanged(GPIOInput *gpio, bool value)=0;
+
+		virtual int GetPollIntervalUs()=0;
+	};
+
+	GPIOInput(int gpioNr, int exportTimeoutMs, IGpioValueListener *listener) {}
+
+	virtual ~GPIOInput() {}
+
+	bool Init() { return true; }
+
+	bool GetValue() { return false; }
+};
+
+} /* namespace GenericEmbeddedUtils */
+
+#endif /* BENCH_STANDINS_GPIOINPUT_H_ */
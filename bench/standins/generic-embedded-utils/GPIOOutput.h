@@ -0,0 +1,36 @@
+/*
+ * GPIOOutput.h
+ *
+ *  Created on: 17.10.2026
+ *      Author: joe
+ */
+
+#ifndef BENCH_STANDINS_GPIOOUTPUT_H_
+#define BENCH_STANDINS_GPIOOUTPUT_H_
+
+//Stand-in replacing the sysfs gpio output of generic-embedded-utils for the latency bench build.
+//Led and amplifier switching are dropped.
+namespace GenericEmbeddedUtils {
+
+class GPIOOutput {
+public:
+	class BlinkSequence
+	{
+	public:
+		BlinkSequence(int offset, const int *sequence, int sequenceLength) {}
+	};
+
+	GPIOOutput(int gpioNr, int exportTimeoutMs, bool initialValue) {}
+
+	virtual ~GPIOOutput() {}
+
+	bool Init() { return true; }
+
+	void SetModeConstantValue(bool value) {}
+
+	void SetModeBlinking(BlinkSequence *sequence) {}
+};
+
+} /* namespace GenericEmbeddedUtils */
+
+#endif /* BENCH_STANDINS_GPIOOUTPUT_H_ */
@@ -7,11 +7,11 @@
 
 #include "AbstractPersistentState.h"
 
-#include "cpp-app-utils/Logger.h"
+#include "Logging.h"
+#include "TimerWheel.h"
 
 #include <stdlib.h>
-#include <unistd.h>
-#include <fcntl.h>
+#include <alloca.h>
 
 
 
@@ -25,11 +25,14 @@ using namespace CppAppUtils;
 #define PERSISTENCE_CONFIG_GROUP		"Persistence"
 #define DEFAULT_PERS_FILE_PATH 			"/var/lib/retroradio.state"
 #define PERSISTENCE_CONFIG_TAG_PERSFILE	"FilePath"
+#define PERSISTENCE_CONFIG_TAG_JOURNALSIZE	"JournalSize"
 
 AbstractPersistentState::AbstractPersistentState(Configuration *configuration) :
+		persFilePath(NULL),
+		journalSize(JOURNAL_DEFAULT_SIZE),
+		writer(&this->journal),
 		commitTimerId(0),
-		newCommitRequested(false),
-		persFilePath(NULL)
+		newCommitRequested(false)
 {
 	configuration->AddConfigurationModule(this);
 }
@@ -42,50 +45,56 @@ AbstractPersistentState::~AbstractPersistentState()
 
 void AbstractPersistentState::Init()
 {
-	Logger::LogDebug("AbstractPersistentState::Init - Initializing persistent state.");
+	LOG_DEBUG("AbstractPersistentState::Init - Initializing persistent state.");
 	if (!ReadStateFile())
 	{
-		Logger::LogError("Setting default values.");
+		LOG_ERROR("Setting default values.");
 		this->DoResetToDefault();
 	}
+
+	//commits are written by the writer thread from now on
+	this->writer.Start(this->ConfigGetStateFileName(), this->journalSize);
 }
 
 void AbstractPersistentState::DeInit()
 {
-	Logger::LogDebug("AbstractPersistentState::DeInit - DeInitializing persistent state.");
+	LOG_DEBUG("AbstractPersistentState::DeInit - DeInitializing persistent state.");
 	this->DoCommit();
 
 	this->newCommitRequested=false;
-	if (this->commitTimerId==0)
+	if (this->commitTimerId!=0)
 	{
-		g_source_remove(this->commitTimerId);
+		TimerWheel::Instance()->Remove(this->commitTimerId);
 		this->commitTimerId=0;
 	}
+
+	//writes the final commit
+	this->writer.Stop();
+	this->journal.Close();
 }
 
 void AbstractPersistentState::DoCommit()
 {
-	Logger::LogDebug("AbstractPersistentState::DoCommit - Opening state to file %s.", this->ConfigGetStateFileName());
-	int fd=open(this->ConfigGetStateFileName(), O_RDWR | O_CREAT | O_SYNC, S_IRUSR | S_IWUSR);
-	if (fd==-1)
-	{
-		Logger::LogError("Unable to open state file %s for writing.", this->ConfigGetStateFileName());
-		return;
-	}
-
-	Logger::LogDebug("AbstractPersistentState::DoCommit - Writing state.");
-	if (!this->DoWriteDataSet(fd))
-		Logger::LogError("Unable to write into state file %s.", this->ConfigGetStateFileName());
-
-	close(fd);
+	size_t maxSize;
+	void *buffer;
+	size_t size;
+
+	//the main loop only copies the data set, the writer thread puts it on the storage
+	LOG_DEBUG("AbstractPersistentState::DoCommit - Taking state snapshot.");
+	buffer=this->writer.BeginSnapshot(&maxSize);
+	size=this->DoWriteDataSet(buffer, maxSize);
+	this->writer.CommitSnapshot(size);
+
+	if (size==0)
+		LOG_ERROR("Unable to serialize state for file %s.", this->ConfigGetStateFileName());
 }
 
 void AbstractPersistentState::CommitImmediately()
 {
-	Logger::LogDebug("AbstractPersistentState::CommitImmediately - Immediate commit requested.");
+	LOG_DEBUG("AbstractPersistentState::CommitImmediately - Immediate commit requested.");
 	if (this->commitTimerId!=0)
 	{
-		g_source_remove(this->commitTimerId);
+		TimerWheel::Instance()->Remove(this->commitTimerId);
 		this->commitTimerId=0;
 	}
 
@@ -94,9 +103,9 @@ void AbstractPersistentState::CommitImmediately()
 
 void AbstractPersistentState::CommitDelayed()
 {
-	Logger::LogDebug("AbstractPersistentState::CommitDelayed - Delayed commit requested.");
+	LOG_DEBUG("AbstractPersistentState::CommitDelayed - Delayed commit requested.");
 	if (this->commitTimerId==0)
-		this->commitTimerId=g_timeout_add(COMIT_TIMOUT_MS,
+		this->commitTimerId=TimerWheel::Instance()->Add(COMIT_TIMOUT_MS, TimerWheel::TIMER_SLACK_LAZY,
 				AbstractPersistentState::OnCommitTimeoutElapsed, this);
 
 	this->newCommitRequested=true;
@@ -105,12 +114,12 @@ void AbstractPersistentState::CommitDelayed()
 gboolean AbstractPersistentState::OnCommitTimeoutElapsed(gpointer userData)
 {
 	AbstractPersistentState *instance = (AbstractPersistentState *)userData;
-	Logger::LogDebug("AbstractPersistentState::OnCommitTimeoutElapsed - Commit timeout elapsed.");
+	LOG_DEBUG("AbstractPersistentState::OnCommitTimeoutElapsed - Commit timeout elapsed.");
 
 	//wait until after a timeout no one has requested an additional commit anymore
 	if (instance->newCommitRequested)
 	{
-		Logger::LogDebug("AbstractPersistentState::OnCommitTimeoutElapsed - Further commit requests detected. Waiting.");
+		LOG_DEBUG("AbstractPersistentState::OnCommitTimeoutElapsed - Further commit requests detected. Waiting.");
 		instance->newCommitRequested=false;
 		return TRUE;
 	}
@@ -123,23 +132,34 @@ gboolean AbstractPersistentState::OnCommitTimeoutElapsed(gpointer userData)
 
 bool AbstractPersistentState::ReadStateFile()
 {
+	size_t maxSize=PersistentStateJournal::GetMaxPayloadSize();
+	void *buffer;
+	size_t size;
 	bool result;
-	Logger::LogDebug("AbstractPersistentState::Init - Opening state file %s.", this->ConfigGetStateFileName());
 
-	int fd=open(this->ConfigGetStateFileName(), O_RDONLY | O_NONBLOCK);
-	if (fd==-1)
+	LOG_DEBUG("AbstractPersistentState::Init - Opening state file %s.", this->ConfigGetStateFileName());
+	if (!this->journal.Open(this->ConfigGetStateFileName(), this->journalSize))
 	{
-		Logger::LogError("Unable to open state file %s for reading.", this->ConfigGetStateFileName());
+		LOG_ERROR("Unable to open state file %s for reading.", this->ConfigGetStateFileName());
 		return false;
 	}
 
-	Logger::LogDebug("AbstractPersistentState::Init - File opened. Reading content.");
-	result=this->DoReadDataSet(fd);
+	LOG_DEBUG("AbstractPersistentState::Init - File opened. Scanning journal.");
+	buffer=alloca(maxSize);
+	size=this->journal.Recover(buffer, maxSize);
+	if (size>0)
+		result=this->DoReadDataSet(buffer, size);
+	else
+	{
+		//state written by versions without journal. Overwritten by the first commit.
+		size=this->journal.ReadLegacyDataSet(buffer, maxSize);
+		result=size>0 && this->DoReadDataSet(buffer, size);
+		if (result)
+			LOG_INFO("Converting state file %s into journal.", this->ConfigGetStateFileName());
+	}
 
 	if (!result)
-		Logger::LogError("State file %s corrupt.", this->ConfigGetStateFileName());
-
-	close(fd);
+		LOG_ERROR("State file %s corrupt.", this->ConfigGetStateFileName());
 
 	return result;
 }
@@ -158,7 +178,7 @@ bool AbstractPersistentState::ParseConfigFileItem(GKeyFile* confFile, const char
 	if (strcasecmp(key, PERSISTENCE_CONFIG_TAG_PERSFILE)==0)
 	{
 		char *path;
-		Logger::LogDebug("AbstractPersistentState::ParseConfigFileItem - Found key %s.",key);
+		LOG_DEBUG("AbstractPersistentState::ParseConfigFileItem - Found key %s.",key);
 		if (Configuration::GetStringValueFromKey(confFile,key,group, &path))
 		{
 			if (this->persFilePath!=NULL)
@@ -168,10 +188,57 @@ bool AbstractPersistentState::ParseConfigFileItem(GKeyFile* confFile, const char
 		else
 			return false;
 	}
+	else if (strcasecmp(key, PERSISTENCE_CONFIG_TAG_JOURNALSIZE)==0)
+	{
+		char *value;
+		char *end;
+		LOG_DEBUG("AbstractPersistentState::ParseConfigFileItem - Found key %s.",key);
+		if (!Configuration::GetStringValueFromKey(confFile,key,group, &value))
+			return false;
+
+		this->journalSize=(size_t)g_ascii_strtoull(value, &end, 10);
+		if (*end!='\0' || this->journalSize<2*JOURNAL_SLOT_SIZE)
+		{
+			LOG_ERROR("Invalid journal size %s. At least %u bytes required.", value, 2*JOURNAL_SLOT_SIZE);
+			free(value);
+			return false;
+		}
+		free(value);
+	}
 
 	return true;
 }
 
+bool AbstractPersistentState::Flush()
+{
+	return this->writer.Flush(PERSISTENT_STATE_FLUSH_TIMEOUT_MS);
+}
+
+unsigned int AbstractPersistentState::GetCommitCount()
+{
+	return this->writer.GetWriteCount();
+}
+
+unsigned int AbstractPersistentState::GetJournalWrapCount()
+{
+	return this->writer.GetWrapCount();
+}
+
+gint64 AbstractPersistentState::GetCommitLatencyAvgUs()
+{
+	return this->writer.GetCommitLatencyAvgUs();
+}
+
+gint64 AbstractPersistentState::GetCommitLatencyMaxUs()
+{
+	return this->writer.GetCommitLatencyMaxUs();
+}
+
+void AbstractPersistentState::ResetCommitLatencyStatistics()
+{
+	this->writer.ResetLatencyStatistics();
+}
+
 bool AbstractPersistentState::IsConfigFileGroupKnown(const char* group)
 {
 	return strcasecmp(group, PERSISTENCE_CONFIG_GROUP);
@@ -11,6 +11,9 @@
 #include <glib.h>
 #include <cpp-app-utils/Configuration.h>
 
+#include "PersistentStateJournal.h"
+#include "PersistentStateWriter.h"
+
 using namespace CppAppUtils;
 
 namespace retroradio_controller {
@@ -21,6 +24,13 @@ private:
 
 	char *persFilePath;
 
+	size_t journalSize;
+
+	PersistentStateJournal journal;
+
+	//owns the journal once started
+	PersistentStateWriter writer;
+
 	guint commitTimerId;
 
 	static gboolean OnCommitTimeoutElapsed(gpointer userData);
@@ -34,9 +44,10 @@ protected:
 
 	void CommitDelayed();
 
-	virtual bool DoWriteDataSet(int fd)=0;
+	//serializes the data set into buffer. Returns its size or 0 on error.
+	virtual size_t DoWriteDataSet(void *buffer, size_t maxSize)=0;
 
-	virtual bool DoReadDataSet(int fd)=0;
+	virtual bool DoReadDataSet(const void *buffer, size_t size)=0;
 
 	virtual void DoResetToDefault()=0;
 
@@ -54,6 +65,19 @@ public:
 	virtual bool ParseConfigFileItem(GKeyFile *confFile, const char *group, const char *key);
 
 	virtual bool IsConfigFileGroupKnown(const char *group);
+
+	//waits until all commits requested so far are on the storage. Delayed commits not yet due are not included.
+	bool Flush();
+
+	unsigned int GetCommitCount();
+
+	unsigned int GetJournalWrapCount();
+
+	gint64 GetCommitLatencyAvgUs();
+
+	gint64 GetCommitLatencyMaxUs();
+
+	void ResetCommitLatencyStatistics();
 };
 
 } /* namespace retroradio_controller */
@@ -0,0 +1,380 @@
+/*
+ * AlsaMixerRegistry.cpp
+ *
+ *  Created on: 17.10.2026
+ *      Author: joe
+ */
+
+#include "AlsaMixerRegistry.h"
+
+#include <string.h>
+
+#include <glib-unix.h>
+
+#include "Logging.h"
+
+using namespace CppAppUtils;
+
+using namespace retroradio_controller;
+
+AlsaMixerRegistry *AlsaMixerRegistry::instance=NULL;
+
+AlsaMixerRegistry::AlsaMixerRegistry() :
+		cards(NULL),
+		failedCards(NULL),
+		cardOpenCnt(0)
+{
+}
+
+AlsaMixerRegistry::~AlsaMixerRegistry()
+{
+	while (this->cards!=NULL)
+		this->CloseCard(this->cards);
+	while (this->failedCards!=NULL)
+		this->CloseCard(this->failedCards);
+}
+
+AlsaMixerRegistry *AlsaMixerRegistry::Instance()
+{
+	if (AlsaMixerRegistry::instance==NULL)
+		AlsaMixerRegistry::instance=new AlsaMixerRegistry();
+
+	return AlsaMixerRegistry::instance;
+}
+
+AlsaMixerRegistry::CardMixer *AlsaMixerRegistry::FindCard(const char *cardName)
+{
+	for (CardMixer *card=this->cards; card!=NULL; card=card->next)
+	{
+		if (strcmp(card->cardName, cardName)==0)
+			return card;
+	}
+
+	return NULL;
+}
+
+AlsaMixerRegistry::CardMixer *AlsaMixerRegistry::FindCardOfElement(snd_mixer_elem_t *elem, ElementEntry **entry)
+{
+	CardMixer *lists[]={ this->cards, this->failedCards };
+
+	for (unsigned int a=0; a<2; a++)
+	{
+		for (CardMixer *card=lists[a]; card!=NULL; card=card->next)
+		{
+			for (ElementEntry *itr=card->elements; itr!=NULL; itr=itr->next)
+			{
+				if (itr->elem==elem)
+				{
+					*entry=itr;
+					return card;
+				}
+			}
+		}
+	}
+
+	return NULL;
+}
+
+AlsaMixerRegistry::CardMixer *AlsaMixerRegistry::OpenCard(const char *cardName)
+{
+	CardMixer *card=g_new0(CardMixer, 1);
+
+	LOG_DEBUG("AlsaMixerRegistry::OpenCard - Opening mixer of card %s.", cardName);
+
+	card->cardName=g_strdup(cardName);
+	this->cardOpenCnt++;
+
+	if (snd_mixer_open(&card->handle, 0)!=0)
+	{
+		LOG_ERROR("Unable to get handle for alsa mixer API.");
+		card->handle=NULL;
+		this->CloseCard(card);
+		return NULL;
+	}
+
+	if (snd_mixer_attach(card->handle, cardName)!=0)
+	{
+		LOG_ERROR("Unable to attach handle to card %s.", cardName);
+		this->CloseCard(card);
+		return NULL;
+	}
+
+	if (snd_mixer_selem_register(card->handle, NULL, NULL)!=0)
+	{
+		LOG_ERROR("Unable register mixer simple element class.");
+		this->CloseCard(card);
+		return NULL;
+	}
+
+	if (snd_mixer_load(card->handle)!=0)
+	{
+		LOG_ERROR("Unable load mixer element.");
+		this->CloseCard(card);
+		return NULL;
+	}
+
+	if (!this->SetupPollFDs(card))
+	{
+		LOG_ERROR("Unable to register alsa event file descriptors for card: %s.", cardName);
+		this->CloseCard(card);
+		return NULL;
+	}
+
+	card->next=this->cards;
+	this->cards=card;
+
+	return card;
+}
+
+bool AlsaMixerRegistry::SetupPollFDs(CardMixer *card)
+{
+	struct pollfd *fds = NULL;
+	int count,rc;
+
+	count = snd_mixer_poll_descriptors_count(card->handle);
+	if (count < 0)
+	{
+		LOG_ERROR("snd_mixer_poll_descriptors_count() failed\n");
+		return false;
+	}
+
+	fds = (struct pollfd *)alloca(count*sizeof(struct pollfd));
+	rc = snd_mixer_poll_descriptors (card->handle, fds, count);
+	if (rc < 0)
+	{
+		LOG_ERROR("snd_mixer_poll_descriptors() failed\n");
+		return false;
+	}
+
+	card->pollSourcesCnt=count;
+	card->pollSources=g_new0(GSource *, count);
+
+	for (int a=0;a<count;a++)
+	{
+		GIOCondition con=(GIOCondition)fds[a].events; //take care: assumes that glib2.0 uses same bitmask as poll which is currently actually the case
+		LOG_DEBUG("AlsaMixerRegistry::SetupPollFDs() - Adding poll fd with event mask: 0x%X.", con);
+		card->pollSources[a]=g_unix_fd_source_new(fds[a].fd,con);
+		g_source_set_callback(card->pollSources[a],(GSourceFunc)AlsaMixerRegistry::OnCardFDEvent,card,NULL);
+		g_source_attach(card->pollSources[a],g_main_context_get_thread_default());
+	}
+
+	return true;
+}
+
+void AlsaMixerRegistry::UnlinkCard(CardMixer **list, CardMixer *card)
+{
+	for (CardMixer **itr=list; *itr!=NULL; itr=&(*itr)->next)
+	{
+		if (*itr==card)
+		{
+			*itr=card->next;
+			card->next=NULL;
+			return;
+		}
+	}
+}
+
+void AlsaMixerRegistry::CloseCard(CardMixer *card)
+{
+	LOG_DEBUG("AlsaMixerRegistry::CloseCard - Closing mixer of card %s.", card->cardName);
+
+	AlsaMixerRegistry::UnlinkCard(&this->cards, card);
+	AlsaMixerRegistry::UnlinkCard(&this->failedCards, card);
+
+	for (int a=0; a<card->pollSourcesCnt; a++)
+	{
+		g_source_destroy(card->pollSources[a]);
+		g_source_unref(card->pollSources[a]);
+	}
+	g_free(card->pollSources);
+
+	while (card->elements!=NULL)
+	{
+		ElementEntry *entry=card->elements;
+
+		card->elements=entry->next;
+		snd_mixer_elem_set_callback(entry->elem, NULL);
+		while (entry->views!=NULL)
+		{
+			ViewLink *link=entry->views;
+			entry->views=link->next;
+			g_free(link);
+		}
+		g_free(entry);
+	}
+
+	if (card->handle!=NULL)
+		snd_mixer_close(card->handle);
+
+	g_free(card->cardName);
+	g_free(card);
+}
+
+snd_mixer_elem_t *AlsaMixerRegistry::Acquire(const char *cardName, const char *mixerName, IElementView *view)
+{
+	snd_mixer_selem_id_t *mixerId;
+	snd_mixer_elem_t *elem;
+	ElementEntry *entry;
+	ViewLink *link;
+	CardMixer *card;
+
+	card=this->FindCard(cardName);
+	if (card==NULL)
+		card=this->OpenCard(cardName);
+	if (card==NULL)
+		return NULL;
+
+	snd_mixer_selem_id_alloca(&mixerId);
+	snd_mixer_selem_id_set_index(mixerId, 0);
+	snd_mixer_selem_id_set_name(mixerId, mixerName);
+	elem=snd_mixer_find_selem(card->handle, mixerId);
+
+	if (elem == NULL)
+	{
+		LOG_ERROR("Unable to find mixer element %s.", mixerName);
+		if (card->refCnt==0)
+			this->CloseCard(card);
+		return NULL;
+	}
+
+	for (entry=card->elements; entry!=NULL; entry=entry->next)
+	{
+		if (entry->elem==elem)
+			break;
+	}
+
+	//element events are routed to the views of this element only
+	if (entry==NULL)
+	{
+		entry=g_new0(ElementEntry, 1);
+		entry->elem=elem;
+		entry->next=card->elements;
+		card->elements=entry;
+		snd_mixer_elem_set_callback_private(elem, entry);
+		snd_mixer_elem_set_callback(elem, AlsaMixerRegistry::OnAlsaElementEvent);
+	}
+
+	link=g_new0(ViewLink, 1);
+	link->view=view;
+	link->next=entry->views;
+	entry->views=link;
+	card->refCnt++;
+
+	LOG_DEBUG("AlsaMixerRegistry::Acquire - Acquired mixer %s of card %s. Views on card: %u",
+			mixerName, cardName, card->refCnt);
+
+	return elem;
+}
+
+void AlsaMixerRegistry::Release(snd_mixer_elem_t *elem, IElementView *view)
+{
+	ElementEntry *entry=NULL;
+	CardMixer *card=this->FindCardOfElement(elem, &entry);
+
+	if (card==NULL)
+		return;
+
+	for (ViewLink **itr=&entry->views; *itr!=NULL; itr=&(*itr)->next)
+	{
+		if ((*itr)->view==view)
+		{
+			ViewLink *link=*itr;
+			*itr=link->next;
+			g_free(link);
+			card->refCnt--;
+			break;
+		}
+	}
+
+	if (entry->views==NULL)
+	{
+		for (ElementEntry **itr=&card->elements; *itr!=NULL; itr=&(*itr)->next)
+		{
+			if (*itr==entry)
+			{
+				*itr=entry->next;
+				break;
+			}
+		}
+		snd_mixer_elem_set_callback(elem, NULL);
+		g_free(entry);
+	}
+
+	if (card->refCnt==0)
+		this->CloseCard(card);
+}
+
+AlsaMixerRegistry::IElementView **AlsaMixerRegistry::CollectViews(ElementEntry *entry, bool allElements,
+		unsigned int *count)
+{
+	IElementView **views;
+	unsigned int cnt=0;
+
+	for (ElementEntry *itr=entry; itr!=NULL; itr=allElements ? itr->next : NULL)
+		for (ViewLink *link=itr->views; link!=NULL; link=link->next)
+			cnt++;
+
+	views=g_new(IElementView *, cnt+1);
+	cnt=0;
+	for (ElementEntry *itr=entry; itr!=NULL; itr=allElements ? itr->next : NULL)
+		for (ViewLink *link=itr->views; link!=NULL; link=link->next)
+			views[cnt++]=link->view;
+
+	*count=cnt;
+	return views;
+}
+
+int AlsaMixerRegistry::OnAlsaElementEvent(snd_mixer_elem_t *elem, unsigned int mask)
+{
+	ElementEntry *entry=(ElementEntry *)snd_mixer_elem_get_callback_private(elem);
+	IElementView **views;
+	unsigned int count;
+
+	views=AlsaMixerRegistry::CollectViews(entry, false, &count);
+	for (unsigned int a=0; a<count; a++)
+		views[a]->OnElementEvent(elem, mask);
+	g_free(views);
+
+	return 0;
+}
+
+gboolean AlsaMixerRegistry::OnCardFDEvent(gint fd, GIOCondition condition, gpointer user_data)
+{
+	AlsaMixerRegistry::Instance()->ProcessCardEvent((CardMixer *)user_data, condition);
+	return TRUE;
+}
+
+void AlsaMixerRegistry::ProcessCardEvent(CardMixer *card, GIOCondition condition)
+{
+	IElementView **views;
+	unsigned int count;
+
+	if ((condition & G_IO_ERR)==0)
+	{
+		snd_mixer_handle_events(card->handle);
+		return;
+	}
+
+	if (card->failed)
+		return;
+
+	LOG_ERROR("Poll FD of card %s released with condition==G_IO_ERR. Sound card removed. Deinitializing mixers.",
+			card->cardName);
+
+	//the next acquire opens the card again
+	card->failed=true;
+	AlsaMixerRegistry::UnlinkCard(&this->cards, card);
+	card->next=this->failedCards;
+	this->failedCards=card;
+
+	//the card is closed when the last view has released its element
+	views=AlsaMixerRegistry::CollectViews(card->elements, true, &count);
+	for (unsigned int a=0; a<count; a++)
+		views[a]->OnCardRemoved();
+	g_free(views);
+}
+
+unsigned int AlsaMixerRegistry::GetCardOpenCount()
+{
+	return this->cardOpenCnt;
+}
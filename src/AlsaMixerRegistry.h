@@ -0,0 +1,108 @@
+/*
+ * AlsaMixerRegistry.h
+ *
+ *  Created on: 17.10.2026
+ *      Author: joe
+ */
+
+#ifndef SRC_ALSAMIXERREGISTRY_H_
+#define SRC_ALSAMIXERREGISTRY_H_
+
+#include <alsa/asoundlib.h>
+#include <glib.h>
+
+namespace retroradio_controller {
+
+//Opens the mixer of each sound card once and shares it between all mixer controls of that card.
+//Controls acquire a view on a single element and receive the events of this element only.
+//The poll fds of a card are attached to the context of the thread opening it. The registry must be used
+//by the thread driving the mixers only (audio control thread, or the main loop without it).
+class AlsaMixerRegistry {
+public:
+	class IElementView
+	{
+	public:
+		virtual void OnElementEvent(snd_mixer_elem_t *elem, unsigned int mask)=0;
+
+		//the card is gone. The view has to release its element.
+		virtual void OnCardRemoved()=0;
+	};
+
+private:
+	typedef struct ViewLink
+	{
+		IElementView *view;
+		struct ViewLink *next;
+	} ViewLink;
+
+	typedef struct ElementEntry
+	{
+		snd_mixer_elem_t *elem;
+		ViewLink *views;
+		struct ElementEntry *next;
+	} ElementEntry;
+
+	typedef struct CardMixer
+	{
+		char *cardName;
+		snd_mixer_t *handle;
+		GSource **pollSources;
+		int pollSourcesCnt;
+		ElementEntry *elements;
+		//number of views acquired
+		unsigned int refCnt;
+		//removed from the card list after an error, closed once the last view is released
+		bool failed;
+		struct CardMixer *next;
+	} CardMixer;
+
+	static AlsaMixerRegistry *instance;
+
+	//cards opened and not failed
+	CardMixer *cards;
+
+	//failed cards still referenced by views
+	CardMixer *failedCards;
+
+	unsigned int cardOpenCnt;
+
+	static gboolean OnCardFDEvent(gint fd, GIOCondition condition, gpointer user_data);
+
+	static int OnAlsaElementEvent(snd_mixer_elem_t *elem, unsigned int mask);
+
+	CardMixer *FindCard(const char *cardName);
+
+	CardMixer *FindCardOfElement(snd_mixer_elem_t *elem, ElementEntry **entry);
+
+	CardMixer *OpenCard(const char *cardName);
+
+	bool SetupPollFDs(CardMixer *card);
+
+	void CloseCard(CardMixer *card);
+
+	static void UnlinkCard(CardMixer **list, CardMixer *card);
+
+	void ProcessCardEvent(CardMixer *card, GIOCondition condition);
+
+	//copy of the views of one element or of all following elements. Views may release themselves while being called.
+	static IElementView **CollectViews(ElementEntry *entry, bool allElements, unsigned int *count);
+
+	AlsaMixerRegistry();
+
+public:
+	virtual ~AlsaMixerRegistry();
+
+	static AlsaMixerRegistry *Instance();
+
+	//returns NULL if the card can not be opened or does not provide the element
+	snd_mixer_elem_t *Acquire(const char *cardName, const char *mixerName, IElementView *view);
+
+	void Release(snd_mixer_elem_t *elem, IElementView *view);
+
+	//number of times a card mixer has been opened
+	unsigned int GetCardOpenCount();
+};
+
+} /* namespace retroradio_controller */
+
+#endif /* SRC_ALSAMIXERREGISTRY_H_ */
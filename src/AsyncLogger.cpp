@@ -0,0 +1,648 @@
+/*
+ * AsyncLogger.cpp
+ *
+ *  Created on: 17.10.2026
+ *      Author: joe
+ */
+
+#include "AsyncLogger.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+
+#include "Logging.h"
+
+using namespace retroradio_controller;
+
+#define LOG_CONFIG_GROUP					"Logging"
+#define LOG_CONFIG_TAG_BACKEND				"Backend"
+#define LOG_CONFIG_TAG_HISTORY				"ErrorHistorySeconds"
+#define LOG_CONFIG_TAG_RATE_LIMIT			"RateLimit"
+
+#define LOG_BACKEND_ASYNC					"async"
+#define LOG_BACKEND_SYNC					"sync"
+
+#define DEFAULT_LOG_HISTORY_SECONDS			0
+#define DEFAULT_LOG_RATE_LIMIT				20
+
+#define LOG_FLUSH_INTERVAL_MS				200
+#define LOG_FLUSH_THREAD_NICE				10
+#define LOG_FORMAT_BUFFER_SIZE				512
+#define LOG_SPEC_BUFFER_SIZE				32
+
+AsyncLogger *AsyncLogger::instance=NULL;
+
+volatile bool AsyncLogger::running=false;
+
+__thread bool AsyncLogger::nonBlockingThread=false;
+
+volatile gint AsyncLogger::unbufferedDroppedCnt=0;
+
+AsyncLogger::AsyncLogger(Configuration *configuration) :
+		enabled(true),
+		historySeconds(DEFAULT_LOG_HISTORY_SECONDS),
+		rateLimit(DEFAULT_LOG_RATE_LIMIT),
+		writeIdx(0),
+		readIdx(0),
+		droppedCnt(0),
+		contendedCnt(0),
+		errorPending(false),
+		stopRequested(false),
+		flushThread(NULL)
+{
+	g_mutex_init(&this->mutex);
+	g_cond_init(&this->cond);
+	AsyncLogger::instance=this;
+	configuration->AddConfigurationModule(this);
+}
+
+AsyncLogger::~AsyncLogger()
+{
+	this->Stop();
+	AsyncLogger::instance=NULL;
+	g_cond_clear(&this->cond);
+	g_mutex_clear(&this->mutex);
+}
+
+bool AsyncLogger::Start()
+{
+	if (!this->enabled || AsyncLogger::running)
+		return true;
+
+	this->writeIdx=0;
+	this->readIdx=0;
+	this->droppedCnt=0;
+	this->errorPending=false;
+	this->stopRequested=false;
+
+	this->flushThread=g_thread_new("log-flush", AsyncLogger::FlushThreadFunc, this);
+	AsyncLogger::running=true;
+	LogLevelCache::Refresh();
+
+	LOG_DEBUG("AsyncLogger::Start - Logging asynchronously. Error history: %u s, rate limit: %u/s.",
+			this->historySeconds, this->rateLimit);
+	return true;
+}
+
+void AsyncLogger::Stop()
+{
+	if (!AsyncLogger::running)
+		return;
+
+	//log sites write directly again from now on, the thread flushes what is left in the ring
+	AsyncLogger::running=false;
+	LogLevelCache::Refresh();
+
+	g_mutex_lock(&this->mutex);
+	this->stopRequested=true;
+	g_cond_signal(&this->cond);
+	g_mutex_unlock(&this->mutex);
+
+	g_thread_join(this->flushThread);
+	this->flushThread=NULL;
+}
+
+bool AsyncLogger::IsCapturingHistory()
+{
+	return AsyncLogger::running && AsyncLogger::instance->historySeconds>0;
+}
+
+void AsyncLogger::SetCallingThreadNonBlocking()
+{
+	AsyncLogger::nonBlockingThread=true;
+}
+
+unsigned int AsyncLogger::GetUnbufferedDroppedCount()
+{
+	return (unsigned int)g_atomic_int_get(&AsyncLogger::unbufferedDroppedCnt);
+}
+
+void AsyncLogger::RecordUnbuffered(Logger::LogLevel level, const char *format, ...)
+{
+	char buffer[LOG_FORMAT_BUFFER_SIZE];
+	va_list args;
+	int len;
+
+	if (level!=Logger::ERROR)
+	{
+		g_atomic_int_inc(&AsyncLogger::unbufferedDroppedCnt);
+		return;
+	}
+
+	va_start(args, format);
+	len=vsnprintf(buffer, sizeof(buffer)-1, format, args);
+	va_end(args);
+
+	if (len<0)
+		return;
+	if (len>(int)sizeof(buffer)-2)
+		len=sizeof(buffer)-2;
+	buffer[len++]='\n';
+
+	if (write(STDERR_FILENO, buffer, len)!=len)
+		g_atomic_int_inc(&AsyncLogger::unbufferedDroppedCnt);
+}
+
+void AsyncLogger::Record(LogSite *site, Logger::LogLevel level, const char *format, ...)
+{
+	va_list args;
+
+	va_start(args, format);
+	AsyncLogger::instance->DoRecord(site, level, format, args);
+	va_end(args);
+}
+
+bool AsyncLogger::IsRateLimited(LogSite *site, gint64 now)
+{
+	if (this->rateLimit==0)
+		return false;
+
+	if (now-site->windowStart>=G_USEC_PER_SEC)
+	{
+		site->windowStart=now;
+		site->windowCnt=0;
+	}
+
+	return ++site->windowCnt>this->rateLimit;
+}
+
+void AsyncLogger::DoRecord(LogSite *site, Logger::LogLevel level, const char *format, va_list args)
+{
+	LogRecord *record;
+	gint64 now=g_get_monotonic_time();
+	va_list argsCopy;
+
+	//the flush thread runs niced and must not delay a real time thread holding the lock
+	if (!AsyncLogger::nonBlockingThread)
+		g_mutex_lock(&this->mutex);
+	else if (!g_mutex_trylock(&this->mutex))
+	{
+		g_atomic_int_inc(&this->contendedCnt);
+		return;
+	}
+
+	//errors are what the history exists for -> never rate limited
+	if (level!=Logger::ERROR && this->IsRateLimited(site, now))
+	{
+		site->suppressedCnt++;
+		g_mutex_unlock(&this->mutex);
+		return;
+	}
+
+	//unflushed records are never overwritten
+	if (this->writeIdx-this->readIdx==ASYNC_LOG_RING_SIZE)
+	{
+		this->droppedCnt++;
+		g_mutex_unlock(&this->mutex);
+		return;
+	}
+
+	record=&this->records[this->writeIdx%ASYNC_LOG_RING_SIZE];
+	record->timestampUs=now;
+	record->format=format;
+	record->level=level;
+	record->suppressedCnt=site->suppressedCnt;
+	record->emitted=false;
+	site->suppressedCnt=0;
+
+	va_copy(argsCopy, args);
+	record->preformatted=!AsyncLogger::CaptureArgs(record, format, args);
+	//a cut off message is marked to be recognisable
+	if (record->preformatted &&
+			vsnprintf((char *)record->args, ASYNC_LOG_ARGS_SIZE, format, argsCopy)>=ASYNC_LOG_ARGS_SIZE)
+		memcpy(record->args+ASYNC_LOG_ARGS_SIZE-4, "...", 4);
+	va_end(argsCopy);
+
+	this->writeIdx++;
+
+	//the flush thread wakes up periodically. Errors are flushed at once together with their history.
+	if (level==Logger::ERROR)
+	{
+		this->errorPending=true;
+		g_cond_signal(&this->cond);
+	}
+
+	g_mutex_unlock(&this->mutex);
+}
+
+bool AsyncLogger::CaptureArgs(LogRecord *record, const char *format, va_list args)
+{
+	const char *p=format;
+	unsigned char *out=record->args;
+	unsigned int len=0;
+
+#define CAPTURE_ARG(type, value)												\
+	do {																		\
+		type v=(type)(value);													\
+		if (len+sizeof(v)>ASYNC_LOG_ARGS_SIZE) return false;					\
+		memcpy(out+len, &v, sizeof(v));											\
+		len+=sizeof(v);															\
+	} while (0)
+
+	while ((p=strchr(p, '%'))!=NULL)
+	{
+		int lengthMod=0;
+
+		p++;
+		if (*p=='%')
+		{
+			p++;
+			continue;
+		}
+
+		while (*p!='\0' && strchr("-+ #0'", *p)!=NULL) p++;
+
+		if (*p=='*')
+		{
+			CAPTURE_ARG(int, va_arg(args, int));
+			p++;
+		}
+		while (*p>='0' && *p<='9') p++;
+
+		if (*p=='.')
+		{
+			p++;
+			if (*p=='*')
+			{
+				CAPTURE_ARG(int, va_arg(args, int));
+				p++;
+			}
+			while (*p>='0' && *p<='9') p++;
+		}
+
+		//length modifier: 'h' and 'H' (hh) promote to int, 'l', 'q' (ll), 'z' and 'L'
+		if (*p=='h')
+		{
+			p++;
+			if (*p=='h') p++;
+		}
+		else if (*p=='l')
+		{
+			lengthMod='l';
+			p++;
+			if (*p=='l')
+			{
+				lengthMod='q';
+				p++;
+			}
+		}
+		else if (*p=='q' || *p=='j')
+		{
+			lengthMod='q';
+			p++;
+		}
+		else if (*p=='z' || *p=='t')
+		{
+			lengthMod='z';
+			p++;
+		}
+		else if (*p=='L')
+		{
+			lengthMod='L';
+			p++;
+		}
+
+		switch (*p)
+		{
+		case 'd': case 'i': case 'o': case 'u': case 'x': case 'X': case 'c':
+			if (lengthMod=='q')
+				CAPTURE_ARG(long long, va_arg(args, long long));
+			else if (lengthMod=='l')
+				CAPTURE_ARG(long, va_arg(args, long));
+			else if (lengthMod=='z')
+				CAPTURE_ARG(size_t, va_arg(args, size_t));
+			else
+				CAPTURE_ARG(int, va_arg(args, int));
+			break;
+
+		case 'e': case 'E': case 'f': case 'F': case 'g': case 'G': case 'a': case 'A':
+			if (lengthMod=='L')
+				CAPTURE_ARG(double, va_arg(args, long double));
+			else
+				CAPTURE_ARG(double, va_arg(args, double));
+			break;
+
+		case 'p':
+			CAPTURE_ARG(void *, va_arg(args, void *));
+			break;
+
+		case 's':
+		{
+			const char *str=va_arg(args, const char *);
+			size_t strLen;
+
+			if (str==NULL) str="(null)";
+			strLen=strlen(str)+1;
+			if (len+strLen>ASYNC_LOG_ARGS_SIZE) return false;
+			memcpy(out+len, str, strLen);
+			len+=strLen;
+			break;
+		}
+
+		default:
+			return false;
+		}
+
+		p++;
+	}
+
+#undef CAPTURE_ARG
+
+	record->argsLen=len;
+	return true;
+}
+
+void AsyncLogger::FormatRecord(LogRecord *record, char *buffer, size_t bufferSize)
+{
+	const char *p=record->format;
+	const unsigned char *in=record->args;
+	size_t pos=0;
+
+	if (record->preformatted)
+	{
+		snprintf(buffer, bufferSize, "%s", (const char *)record->args);
+		return;
+	}
+
+#define READ_ARG(type, var)					\
+	type var;								\
+	memcpy(&var, in, sizeof(var));			\
+	in+=sizeof(var)
+
+#define PRINT_ARG(value)																			\
+	do {																						\
+		if (starCnt==0)																			\
+			written=snprintf(buffer+pos, bufferSize-pos, spec, value);							\
+		else if (starCnt==1)																	\
+			written=snprintf(buffer+pos, bufferSize-pos, spec, stars[0], value);				\
+		else																					\
+			written=snprintf(buffer+pos, bufferSize-pos, spec, stars[0], stars[1], value);		\
+	} while (0)
+
+	while (*p!='\0' && pos<bufferSize-1)
+	{
+		char spec[LOG_SPEC_BUFFER_SIZE];
+		unsigned int specLen=0;
+		int stars[2];
+		int starCnt=0;
+		int written=0;
+
+		if (*p!='%')
+		{
+			buffer[pos++]=*p++;
+			continue;
+		}
+
+		if (p[1]=='%')
+		{
+			buffer[pos++]='%';
+			p+=2;
+			continue;
+		}
+
+		//copy the conversion specification, the stored arguments are read in the same order as captured
+		spec[specLen++]=*p++;
+		while (*p!='\0' && strchr("diouxXceEfFgGaAps", *p)==NULL && specLen<LOG_SPEC_BUFFER_SIZE-2)
+		{
+			if (*p=='*')
+			{
+				memcpy(&stars[starCnt++], in, sizeof(int));
+				in+=sizeof(int);
+			}
+			//long double arguments are stored as double
+			if (*p!='L')
+				spec[specLen++]=*p;
+			p++;
+		}
+		if (*p=='\0' || strchr("diouxXceEfFgGaAps", *p)==NULL) break;
+		spec[specLen++]=*p;
+		spec[specLen]='\0';
+
+		switch (*p)
+		{
+		case 'd': case 'i': case 'o': case 'u': case 'x': case 'X': case 'c':
+			if (strstr(spec, "ll")!=NULL || strchr(spec, 'q')!=NULL || strchr(spec, 'j')!=NULL)
+			{
+				READ_ARG(long long, value);
+				PRINT_ARG(value);
+			}
+			else if (strchr(spec, 'l')!=NULL)
+			{
+				READ_ARG(long, value);
+				PRINT_ARG(value);
+			}
+			else if (strchr(spec, 'z')!=NULL || strchr(spec, 't')!=NULL)
+			{
+				READ_ARG(size_t, value);
+				PRINT_ARG(value);
+			}
+			else
+			{
+				READ_ARG(int, value);
+				PRINT_ARG(value);
+			}
+			break;
+
+		case 'p':
+		{
+			READ_ARG(void *, value);
+			PRINT_ARG(value);
+			break;
+		}
+
+		case 's':
+		{
+			const char *value=(const char *)in;
+			in+=strlen(value)+1;
+			PRINT_ARG(value);
+			break;
+		}
+
+		default:
+		{
+			READ_ARG(double, value);
+			PRINT_ARG(value);
+			break;
+		}
+		}
+
+		p++;
+		if (written>0)
+			pos+=written;
+	}
+
+#undef PRINT_ARG
+#undef READ_ARG
+
+	if (pos>=bufferSize)
+		pos=bufferSize-1;
+	buffer[pos]='\0';
+}
+
+void AsyncLogger::Emit(LogRecord *record, const char *prefix)
+{
+	char buffer[LOG_FORMAT_BUFFER_SIZE];
+	char suppressed[64]="";
+
+	AsyncLogger::FormatRecord(record, buffer, sizeof(buffer));
+
+	if (record->suppressedCnt>0)
+		snprintf(suppressed, sizeof(suppressed), " (%u similar messages suppressed)", record->suppressedCnt);
+
+	//history records are below the logger's level -> they are written out as part of the error report
+	if (prefix!=NULL)
+		Logger::LogError("%s %.3f s: %s%s", prefix, record->timestampUs/(double)G_USEC_PER_SEC, buffer, suppressed);
+	else if (record->level==Logger::ERROR)
+		Logger::LogError("%s%s", buffer, suppressed);
+	else if (record->level==Logger::INFO)
+		Logger::LogInfo("%s%s", buffer, suppressed);
+	else
+		Logger::LogDebug("%s%s", buffer, suppressed);
+}
+
+void AsyncLogger::CollectHistory(unsigned int errorIdx, gint64 errorTime, LogRecord *history,
+		unsigned int *historyCnt)
+{
+	unsigned int oldestIdx=this->writeIdx>ASYNC_LOG_RING_SIZE ? this->writeIdx-ASYNC_LOG_RING_SIZE : 0;
+	gint64 historyStart=errorTime-(gint64)this->historySeconds*G_USEC_PER_SEC;
+	unsigned int idx=errorIdx;
+	unsigned int cnt=0;
+
+	//walk back to the first record of the history interval
+	while (idx>oldestIdx && this->records[(idx-1)%ASYNC_LOG_RING_SIZE].timestampUs>=historyStart)
+		idx--;
+
+	for (; idx<errorIdx; idx++)
+	{
+		LogRecord *record=&this->records[idx%ASYNC_LOG_RING_SIZE];
+		if (record->emitted) continue;
+		record->emitted=true;
+		history[cnt++]=*record;
+	}
+
+	*historyCnt=cnt;
+}
+
+gpointer AsyncLogger::FlushThreadFunc(gpointer data)
+{
+	AsyncLogger *instance=(AsyncLogger *)data;
+
+	//formatting and syslog writes must not compete with the main loop
+	setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), LOG_FLUSH_THREAD_NICE);
+
+	instance->FlushLoop();
+	return NULL;
+}
+
+void AsyncLogger::FlushLoop()
+{
+	LogRecord *history;
+	unsigned int historyCnt;
+	LogRecord record;
+	unsigned int dropped;
+	gint contended;
+
+	history=g_new(LogRecord, ASYNC_LOG_RING_SIZE);
+
+	g_mutex_lock(&this->mutex);
+
+	while (true)
+	{
+		if (!this->stopRequested && !this->errorPending)
+			g_cond_wait_until(&this->cond, &this->mutex,
+					g_get_monotonic_time()+LOG_FLUSH_INTERVAL_MS*1000);
+
+		this->errorPending=false;
+
+		while (this->readIdx!=this->writeIdx)
+		{
+			unsigned int idx=this->readIdx++;
+			LogRecord *slot=&this->records[idx%ASYNC_LOG_RING_SIZE];
+
+			historyCnt=0;
+			if (slot->level<=Logger::GetLogLevel())
+			{
+				if (slot->level==Logger::ERROR && this->historySeconds>0)
+					this->CollectHistory(idx, slot->timestampUs, history, &historyCnt);
+				slot->emitted=true;
+			}
+			record=*slot;
+			contended=g_atomic_int_get(&this->contendedCnt);
+			if (contended>0)
+				g_atomic_int_add(&this->contendedCnt, -contended);
+			dropped=this->droppedCnt+contended;
+			this->droppedCnt=0;
+
+			if (!record.emitted && historyCnt==0 && dropped==0)
+				continue;
+
+			g_mutex_unlock(&this->mutex);
+
+			if (dropped>0)
+				Logger::LogError("Log ring overflow or contention. Dropped %u messages.", dropped);
+			for (unsigned int a=0; a<historyCnt; a++)
+				AsyncLogger::Emit(&history[a], "history");
+			if (record.emitted)
+				AsyncLogger::Emit(&record, NULL);
+
+			g_mutex_lock(&this->mutex);
+		}
+
+		if (this->stopRequested)
+			break;
+	}
+
+	g_mutex_unlock(&this->mutex);
+	g_free(history);
+}
+
+bool AsyncLogger::ParseConfigFileItem(GKeyFile *confFile, const char *group, const char *key)
+{
+	if (strcasecmp(group, LOG_CONFIG_GROUP)!=0) return true;
+
+	if (strcasecmp(key, LOG_CONFIG_TAG_BACKEND)==0)
+	{
+		char *backend;
+		if (!Configuration::GetStringValueFromKey(confFile, key, group, &backend))
+			return false;
+
+		if (strcasecmp(backend, LOG_BACKEND_ASYNC)==0)
+			this->enabled=true;
+		else if (strcasecmp(backend, LOG_BACKEND_SYNC)==0)
+			this->enabled=false;
+		else
+		{
+			LOG_ERROR("Unknown log backend %s. Use %s or %s.", backend, LOG_BACKEND_ASYNC, LOG_BACKEND_SYNC);
+			free(backend);
+			return false;
+		}
+		free(backend);
+	}
+	else if (strcasecmp(key, LOG_CONFIG_TAG_HISTORY)==0)
+	{
+		int seconds;
+		if (Configuration::GetInt64ValueFromKey(confFile, key, group, &seconds) && seconds>=0)
+			this->historySeconds=seconds;
+		else
+			return false;
+	}
+	else if (strcasecmp(key, LOG_CONFIG_TAG_RATE_LIMIT)==0)
+	{
+		int limit;
+		if (Configuration::GetInt64ValueFromKey(confFile, key, group, &limit) && limit>=0)
+			this->rateLimit=limit;
+		else
+			return false;
+	}
+
+	return true;
+}
+
+bool AsyncLogger::IsConfigFileGroupKnown(const char *group)
+{
+	return strcasecmp(group, LOG_CONFIG_GROUP);
+}
@@ -0,0 +1,152 @@
+/*
+ * AsyncLogger.h
+ *
+ *  Created on: 17.10.2026
+ *      Author: joe
+ */
+
+#ifndef SRC_ASYNCLOGGER_H_
+#define SRC_ASYNCLOGGER_H_
+
+#include <stdarg.h>
+
+#include <glib.h>
+
+#include <cpp-app-utils/Logger.h>
+#include <cpp-app-utils/Configuration.h>
+
+using namespace CppAppUtils;
+
+namespace retroradio_controller {
+
+#define ASYNC_LOG_RING_SIZE			1024
+#define ASYNC_LOG_ARGS_SIZE			112
+
+//Logger backend keeping log sites free of I/O. Log sites store the format string pointer and the raw
+//arguments into a preallocated ring, a low priority thread formats the records and passes them to the logger.
+//Records below the logger's level are kept in the ring and written out for the last seconds before an error.
+class AsyncLogger : public Configuration::IConfigurationParserModule {
+public:
+	//per call site state for rate limiting, one static instance per log macro
+	typedef struct LogSite
+	{
+		gint64 windowStart;
+		unsigned int windowCnt;
+		unsigned int suppressedCnt;
+	} LogSite;
+
+private:
+	typedef struct LogRecord
+	{
+		gint64 timestampUs;
+		const char *format;
+		Logger::LogLevel level;
+		//messages of the same site dropped by the rate limit before this one
+		unsigned int suppressedCnt;
+		//format could not be captured. args holds the formatted message then.
+		bool preformatted;
+		//already passed to the logger
+		bool emitted;
+		unsigned short argsLen;
+		unsigned char args[ASYNC_LOG_ARGS_SIZE];
+	} LogRecord;
+
+	static AsyncLogger *instance;
+
+	static volatile bool running;
+
+	static __thread bool nonBlockingThread;
+
+	//records of non blocking threads dropped while the backend is not running
+	static volatile gint unbufferedDroppedCnt;
+
+	bool enabled;
+
+	unsigned int historySeconds;
+
+	//records per second and log site, errors are not limited
+	unsigned int rateLimit;
+
+	LogRecord records[ASYNC_LOG_RING_SIZE];
+
+	//records between readIdx and writeIdx wait for the flush thread. Records before readIdx are history.
+	unsigned int writeIdx;
+
+	unsigned int readIdx;
+
+	unsigned int droppedCnt;
+
+	//records dropped by non blocking threads finding the ring locked
+	volatile gint contendedCnt;
+
+	bool errorPending;
+
+	bool stopRequested;
+
+	GMutex mutex;
+
+	GCond cond;
+
+	GThread *flushThread;
+
+	static gpointer FlushThreadFunc(gpointer data);
+
+	void FlushLoop();
+
+	bool IsRateLimited(LogSite *site, gint64 now);
+
+	static bool CaptureArgs(LogRecord *record, const char *format, va_list args);
+
+	static void FormatRecord(LogRecord *record, char *buffer, size_t bufferSize);
+
+	void CollectHistory(unsigned int errorIdx, gint64 errorTime, LogRecord *history, unsigned int *historyCnt);
+
+	static void Emit(LogRecord *record, const char *prefix);
+
+	void DoRecord(LogSite *site, Logger::LogLevel level, const char *format, va_list args);
+
+public:
+	AsyncLogger(Configuration *configuration);
+
+	virtual ~AsyncLogger();
+
+	bool Start();
+
+	//flushes pending records and stops the flush thread
+	void Stop();
+
+	static inline bool IsRunning()
+	{
+		return AsyncLogger::running;
+	}
+
+	//records below the logger's level are captured for the error history. Only if ErrorHistorySeconds is configured.
+	static bool IsCapturingHistory();
+
+	//log sites of the calling thread drop records instead of waiting for the ring lock held by another thread.
+	//Without the running backend their records are never written synchronously, see RecordUnbuffered.
+	static void SetCallingThreadNonBlocking();
+
+	static inline bool IsCallingThreadNonBlocking()
+	{
+		return AsyncLogger::nonBlockingThread;
+	}
+
+	//log path of non blocking threads while the backend is not running. Errors are written to stderr with a
+	//single write, bypassing the logger's locks. Less severe records are dropped and counted.
+	static void RecordUnbuffered(Logger::LogLevel level, const char *format, ...)
+		__attribute__((format(printf, 2, 3)));
+
+	static unsigned int GetUnbufferedDroppedCount();
+
+	static void Record(LogSite *site, Logger::LogLevel level, const char *format, ...)
+		__attribute__((format(printf, 3, 4)));
+
+	virtual bool ParseConfigFileItem(GKeyFile *confFile, const char *group, const char *key);
+
+	virtual bool IsConfigFileGroupKnown(const char *group);
+};
+
+} /* namespace retroradio_controller */
+
+#endif /* SRC_ASYNCLOGGER_H_ */
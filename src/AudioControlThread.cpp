@@ -0,0 +1,338 @@
+/*
+ * AudioControlThread.cpp
+ *
+ *  Created on: 17.10.2026
+ *      Author: joe
+ */
+
+#include "AudioControlThread.h"
+
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/eventfd.h>
+
+#include <glib-unix.h>
+
+#include "Logging.h"
+
+using namespace CppAppUtils;
+
+using namespace retroradio_controller;
+
+AudioControlThread *AudioControlThread::instance=NULL;
+
+AudioControlThread::AudioControlThread() :
+		context(NULL),
+		loop(NULL),
+		thread(NULL),
+		timerWheel(NULL),
+		running(false),
+		commandFd(-1),
+		eventFd(-1),
+		commandSource(NULL),
+		eventSourceId(0),
+		volumeKeyHandler(NULL),
+		droppedEventCnt(0),
+		syncDone(false),
+		syncResult(0)
+{
+	g_mutex_init(&this->syncMutex);
+	g_cond_init(&this->syncCond);
+}
+
+AudioControlThread::~AudioControlThread()
+{
+	this->Stop();
+	g_cond_clear(&this->syncCond);
+	g_mutex_clear(&this->syncMutex);
+}
+
+AudioControlThread *AudioControlThread::Instance()
+{
+	if (AudioControlThread::instance==NULL)
+		AudioControlThread::instance=new AudioControlThread();
+
+	return AudioControlThread::instance;
+}
+
+bool AudioControlThread::Start()
+{
+	if (this->running)
+		return true;
+
+	this->commandFd=eventfd(0, EFD_NONBLOCK|EFD_CLOEXEC);
+	this->eventFd=eventfd(0, EFD_NONBLOCK|EFD_CLOEXEC);
+	if (this->commandFd==-1 || this->eventFd==-1)
+	{
+		LOG_ERROR("Failed to create audio control eventfds: %s. Running audio control in main loop.", strerror(errno));
+		if (this->commandFd!=-1) close(this->commandFd);
+		if (this->eventFd!=-1) close(this->eventFd);
+		this->commandFd=-1;
+		this->eventFd=-1;
+		return false;
+	}
+
+	this->context=g_main_context_new();
+	this->loop=g_main_loop_new(this->context, FALSE);
+	this->timerWheel=new TimerWheel(this->context);
+
+	this->commandSource=g_unix_fd_source_new(this->commandFd, G_IO_IN);
+	g_source_set_callback(this->commandSource, (GSourceFunc)AudioControlThread::OnCommandFdEvent, this, NULL);
+	g_source_attach(this->commandSource, this->context);
+
+	this->eventSourceId=g_unix_fd_add(this->eventFd, G_IO_IN, AudioControlThread::OnEventFdEvent, this);
+
+	this->running=true;
+	this->thread=g_thread_new("audio-control", AudioControlThread::ThreadFunc, this);
+
+	LOG_DEBUG("AudioControlThread::Start - Started audio control thread.");
+	return true;
+}
+
+void AudioControlThread::Stop()
+{
+	if (!this->running)
+		return;
+
+	g_main_loop_quit(this->loop);
+	g_thread_join(this->thread);
+	this->thread=NULL;
+	this->running=false;
+
+	//events still queued are dropped, their handlers are deinitialized already
+	g_source_remove(this->eventSourceId);
+	this->eventSourceId=0;
+	g_source_destroy(this->commandSource);
+	g_source_unref(this->commandSource);
+	this->commandSource=NULL;
+
+	delete this->timerWheel;
+	this->timerWheel=NULL;
+	g_main_loop_unref(this->loop);
+	this->loop=NULL;
+	g_main_context_unref(this->context);
+	this->context=NULL;
+
+	close(this->commandFd);
+	close(this->eventFd);
+	this->commandFd=-1;
+	this->eventFd=-1;
+
+	LOG_DEBUG("AudioControlThread::Stop - Stopped audio control thread.");
+}
+
+bool AudioControlThread::IsRunning()
+{
+	return this->running;
+}
+
+bool AudioControlThread::IsCurrentThread()
+{
+	return this->running && g_thread_self()==this->thread;
+}
+
+TimerWheel *AudioControlThread::GetTimerWheel()
+{
+	if (!this->running)
+		return TimerWheel::Instance();
+
+	return this->timerWheel;
+}
+
+gpointer AudioControlThread::ThreadFunc(gpointer data)
+{
+	AudioControlThread *instance=(AudioControlThread *)data;
+
+	instance->SetRealtimePriority();
+	AsyncLogger::SetCallingThreadNonBlocking();
+
+	//fd watches added by the handlers (lirc, mixer events) end up in this context
+	g_main_context_push_thread_default(instance->context);
+	g_main_loop_run(instance->loop);
+	g_main_context_pop_thread_default(instance->context);
+
+	return NULL;
+}
+
+void AudioControlThread::SetRealtimePriority()
+{
+	struct sched_param param;
+	int result;
+
+	memset(&param, 0, sizeof(param));
+	param.sched_priority=AUDIO_CONTROL_THREAD_PRIORITY;
+
+	result=pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+	if (result!=0)
+		LOG_INFO("Unable to run audio control thread with SCHED_FIFO priority %d: %s. Running with normal priority.",
+				AUDIO_CONTROL_THREAD_PRIORITY, strerror(result));
+	else
+		LOG_DEBUG("AudioControlThread::SetRealtimePriority - Running with SCHED_FIFO priority %d.",
+				AUDIO_CONTROL_THREAD_PRIORITY);
+}
+
+void AudioControlThread::Notify(int fd)
+{
+	guint64 value=1;
+
+	if (write(fd, &value, sizeof(value))!=sizeof(value) && errno!=EAGAIN)
+		LOG_ERROR("Failed to signal audio control eventfd: %s", strerror(errno));
+}
+
+void AudioControlThread::ClearNotification(int fd)
+{
+	guint64 value;
+
+	if (read(fd, &value, sizeof(value))!=sizeof(value) && errno!=EAGAIN)
+		LOG_ERROR("Failed to read audio control eventfd: %s", strerror(errno));
+}
+
+void AudioControlThread::Post(IAudioControlHandler *handler, int cmd, long arg, unsigned int tag)
+{
+	Message msg;
+
+	if (!this->running)
+	{
+		handler->OnAudioControlCommand(cmd, arg, tag);
+		return;
+	}
+
+	msg.handler=handler;
+	msg.id=cmd;
+	msg.arg=arg;
+	msg.tag=tag;
+	msg.sync=false;
+
+	if (!this->commands.Push(msg))
+	{
+		LOG_ERROR("Audio control command queue full. Dropping command %d.", cmd);
+		return;
+	}
+
+	AudioControlThread::Notify(this->commandFd);
+}
+
+long AudioControlThread::Invoke(IAudioControlHandler *handler, int cmd, long arg, unsigned int tag)
+{
+	Message msg;
+	long result;
+
+	if (!this->running || this->IsCurrentThread())
+		return handler->OnAudioControlCommand(cmd, arg, tag);
+
+	msg.handler=handler;
+	msg.id=cmd;
+	msg.arg=arg;
+	msg.tag=tag;
+	msg.sync=true;
+
+	//queued commands are executed in order -> the command queue is drained up to here as well
+	while (!this->commands.Push(msg))
+		g_usleep(1000);
+
+	AudioControlThread::Notify(this->commandFd);
+
+	g_mutex_lock(&this->syncMutex);
+	while (!this->syncDone)
+		g_cond_wait(&this->syncCond, &this->syncMutex);
+	this->syncDone=false;
+	result=this->syncResult;
+	g_mutex_unlock(&this->syncMutex);
+
+	return result;
+}
+
+gboolean AudioControlThread::OnCommandFdEvent(gint fd, GIOCondition condition, gpointer user_data)
+{
+	AudioControlThread *instance=(AudioControlThread *)user_data;
+
+	AudioControlThread::ClearNotification(fd);
+	instance->ProcessCommands();
+	return TRUE;
+}
+
+void AudioControlThread::ProcessCommands()
+{
+	Message msg;
+
+	while (this->commands.Pop(&msg))
+	{
+		long result=msg.handler->OnAudioControlCommand(msg.id, msg.arg, msg.tag);
+
+		if (msg.sync)
+		{
+			g_mutex_lock(&this->syncMutex);
+			this->syncResult=result;
+			this->syncDone=true;
+			g_cond_signal(&this->syncCond);
+			g_mutex_unlock(&this->syncMutex);
+		}
+	}
+}
+
+void AudioControlThread::PostEvent(IAudioControlHandler *handler, int event, long arg, unsigned int tag)
+{
+	Message msg;
+
+	if (!this->running)
+	{
+		handler->OnAudioControlEvent(event, arg, tag);
+		return;
+	}
+
+	msg.handler=handler;
+	msg.id=event;
+	msg.arg=arg;
+	msg.tag=tag;
+	msg.sync=false;
+
+	//the thread must not wait for the main loop -> count and report later
+	if (!this->events.Push(msg))
+	{
+		this->droppedEventCnt.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	AudioControlThread::Notify(this->eventFd);
+}
+
+gboolean AudioControlThread::OnEventFdEvent(gint fd, GIOCondition condition, gpointer user_data)
+{
+	AudioControlThread *instance=(AudioControlThread *)user_data;
+
+	AudioControlThread::ClearNotification(fd);
+	instance->ProcessEvents();
+	return TRUE;
+}
+
+void AudioControlThread::ProcessEvents()
+{
+	Message msg;
+	unsigned int dropped;
+
+	dropped=this->droppedEventCnt.exchange(0, std::memory_order_relaxed);
+	if (dropped>0)
+		LOG_ERROR("Audio control event queue overflow. Dropped %u events.", dropped);
+
+	while (this->events.Pop(&msg))
+		msg.handler->OnAudioControlEvent(msg.id, msg.arg, msg.tag);
+}
+
+void AudioControlThread::SetVolumeKeyHandler(IVolumeKeyHandler *handler)
+{
+	this->volumeKeyHandler.store(handler, std::memory_order_release);
+}
+
+bool AudioControlThread::DispatchVolumeKey(bool up)
+{
+	IVolumeKeyHandler *handler=this->volumeKeyHandler.load(std::memory_order_acquire);
+
+	if (handler==NULL)
+		return false;
+
+	handler->OnVolumeKey(up);
+	return true;
+}
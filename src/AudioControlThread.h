@@ -0,0 +1,149 @@
+/*
+ * AudioControlThread.h
+ *
+ *  Created on: 17.10.2026
+ *      Author: joe
+ */
+
+#ifndef SRC_AUDIOCONTROLTHREAD_H_
+#define SRC_AUDIOCONTROLTHREAD_H_
+
+#include <atomic>
+
+#include <glib.h>
+
+#include "SPSCQueue.h"
+#include "TimerWheel.h"
+
+namespace retroradio_controller {
+
+#define AUDIO_CONTROL_QUEUE_SIZE		256
+#define AUDIO_CONTROL_THREAD_PRIORITY	50
+
+//Thread running its own main context with SCHED_FIFO priority for IR input, mixer ramps and the main volume.
+//Blocking work of the main loop (mpd, state commits, handover) does not delay it anymore.
+//The main loop passes commands through a lock free queue, the thread answers with events through another one.
+//Without a running thread commands and events are executed directly by the caller.
+class AudioControlThread {
+public:
+	class IAudioControlHandler
+	{
+	public:
+		//executed by the audio control thread. The result is returned by Invoke.
+		virtual long OnAudioControlCommand(int cmd, long arg, unsigned int tag)=0;
+
+		//executed by the main loop
+		virtual void OnAudioControlEvent(int event, long arg, unsigned int tag)=0;
+	};
+
+	class IVolumeKeyHandler
+	{
+	public:
+		//executed by the audio control thread
+		virtual void OnVolumeKey(bool up)=0;
+	};
+
+private:
+	typedef struct Message
+	{
+		IAudioControlHandler *handler;
+		int id;
+		long arg;
+		//opaque for the thread, passed as is to the handler
+		unsigned int tag;
+		//the main loop waits for the result
+		bool sync;
+	} Message;
+
+	static AudioControlThread *instance;
+
+	GMainContext *context;
+
+	GMainLoop *loop;
+
+	GThread *thread;
+
+	TimerWheel *timerWheel;
+
+	std::atomic<bool> running;
+
+	//main loop -> audio control thread
+	SPSCQueue<Message, AUDIO_CONTROL_QUEUE_SIZE> commands;
+
+	//audio control thread -> main loop
+	SPSCQueue<Message, AUDIO_CONTROL_QUEUE_SIZE> events;
+
+	int commandFd;
+
+	int eventFd;
+
+	GSource *commandSource;
+
+	guint eventSourceId;
+
+	std::atomic<IVolumeKeyHandler *> volumeKeyHandler;
+
+	std::atomic<unsigned int> droppedEventCnt;
+
+	GMutex syncMutex;
+
+	GCond syncCond;
+
+	bool syncDone;
+
+	long syncResult;
+
+	static gpointer ThreadFunc(gpointer data);
+
+	static gboolean OnCommandFdEvent(gint fd, GIOCondition condition, gpointer user_data);
+
+	static gboolean OnEventFdEvent(gint fd, GIOCondition condition, gpointer user_data);
+
+	static void Notify(int fd);
+
+	static void ClearNotification(int fd);
+
+	void SetRealtimePriority();
+
+	void ProcessCommands();
+
+	void ProcessEvents();
+
+	AudioControlThread();
+
+public:
+	virtual ~AudioControlThread();
+
+	static AudioControlThread *Instance();
+
+	bool Start();
+
+	//commands posted afterwards are executed directly by the main loop
+	void Stop();
+
+	bool IsRunning();
+
+	bool IsCurrentThread();
+
+	//wheel of the thread running the handlers
+	TimerWheel *GetTimerWheel();
+
+	//main loop only. Queues a command for the handler.
+	void Post(IAudioControlHandler *handler, int cmd, long arg, unsigned int tag=0);
+
+	//main loop only. Executes a command and waits for its result.
+	long Invoke(IAudioControlHandler *handler, int cmd, long arg, unsigned int tag=0);
+
+	//audio control thread only. Queues an event delivered to the handler by the main loop.
+	void PostEvent(IAudioControlHandler *handler, int event, long arg, unsigned int tag=0);
+
+	//volume keys are handled by the audio control thread directly while a handler is set
+	void SetVolumeKeyHandler(IVolumeKeyHandler *handler);
+
+	//audio control thread only. Returns false if the key needs to be passed to the main loop.
+	bool DispatchVolumeKey(bool up);
+};
+
+} /* namespace retroradio_controller */
+
+#endif /* SRC_AUDIOCONTROLTHREAD_H_ */
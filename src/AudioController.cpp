@@ -9,7 +9,7 @@
 
 #include "RetroradioController.h"
 
-#include <cpp-app-utils/Logger.h>
+#include "Logging.h"
 
 using namespace CppAppUtils;
 
@@ -40,13 +40,14 @@ AudioController::AudioController(IStateListener *stateListener, Configuration *c
 
 AudioController::~AudioController()
 {
+	StateChangeDispatcher::Instance()->Cancel(this);
 	delete this->mainVolumeCtrl;
 	delete this->audioSources;
 }
 
 bool AudioController::Init()
 {
-	Logger::LogDebug("AudioController::Init -> Initializing Audio Controller.");
+	LOG_DEBUG("AudioController::Init -> Initializing Audio Controller.");
 
 	this->state=STARTING_UP;
 	return this->audioSources->Init();
@@ -55,9 +56,10 @@ bool AudioController::Init()
 void AudioController::DeInit()
 {
 	this->state=_NOT_SET;
+	this->UpdateVolumeKeyHandler();
 	this->mainVolumeCtrl->DeInit();
 	this->audioSources->DeInit();
-	Logger::LogDebug("AudioController::DeInit -> Deinitialized Audio controller");
+	LOG_DEBUG("AudioController::DeInit -> Deinitialized Audio controller");
 }
 
 void AudioController::DoChangeToSource()
@@ -70,7 +72,7 @@ void AudioController::DoChangeToSource()
 
 void AudioController::ChangeToNextSource()
 {
-	Logger::LogDebug("AudioController::ChangeToNextSource -> Audio Controller requested to change to next source.");
+	LOG_DEBUG("AudioController::ChangeToNextSource -> Audio Controller requested to change to next source.");
 	this->DoChangeToSource();
 }
 
@@ -93,27 +95,45 @@ bool AudioController::CheckSourcesStartupState()
 	return result;
 }
 
+void AudioController::WaitForSourcesStartup()
+{
+	LOG_DEBUG("AudioController::WaitForSourcesStartup -> Waiting for sources to finish booting.");
+	for (AbstractAudioSource *itr=this->audioSources->GetIterator(); itr!=NULL; itr=itr->GetSuccessor())
+		itr->WaitForStartup();
+}
+
+void AudioController::OnStartupFinished(AbstractAudioSource *src)
+{
+	LOG_DEBUG("AudioController::OnStartupFinished -> Source %s finished booting.", src->GetName());
+	if (this->state != STARTING_UP) return;
+
+	if (this->CheckSourcesStartupState() && this->listener!=NULL)
+		this->listener->OnSourcesStartupFinished();
+}
+
 void AudioController::Mute()
 {
-	Logger::LogDebug("AudioController::Mute -> Audio Controller requested to mute.");
+	LOG_DEBUG("AudioController::Mute -> Audio Controller requested to mute.");
 	if (this->muted) return;
 
 	this->audioSources->GetCurrentSource()->SetMuted(true);
 	this->muted=true;
+	this->UpdateVolumeKeyHandler();
 }
 
 void AudioController::UnMute()
 {
-	Logger::LogDebug("AudioController::UnMute -> Audio Controller requested to unmute.");
+	LOG_DEBUG("AudioController::UnMute -> Audio Controller requested to unmute.");
 	if (!this->muted) return;
 
 	this->audioSources->GetCurrentSource()->SetMuted(false);
 	this->muted=false;
+	this->UpdateVolumeKeyHandler();
 }
 
 void AudioController::ToggleMute()
 {
-	Logger::LogDebug("AudioController::ToggleMute -> Audio Controller requested to toggle mute state.");
+	LOG_DEBUG("AudioController::ToggleMute -> Audio Controller requested to toggle mute state.");
 
 	if (this->muted)
 		this->UnMute();
@@ -123,7 +143,7 @@ void AudioController::ToggleMute()
 
 void AudioController::VolumeUp()
 {
-	Logger::LogDebug("AudioController::VolumeUp -> Audio Controller requested to increase volume.");
+	LOG_DEBUG("AudioController::VolumeUp -> Audio Controller requested to increase volume.");
 	if (this->muted)
 		this->UnMute();
 	this->mainVolumeCtrl->VolumeUp();
@@ -131,7 +151,7 @@ void AudioController::VolumeUp()
 
 void AudioController::VolumeDown()
 {
-	Logger::LogDebug("AudioController::VolumeDown -> Audio Controller requested to decrease volume.");
+	LOG_DEBUG("AudioController::VolumeDown -> Audio Controller requested to decrease volume.");
 	if (this->muted)
 		this->UnMute();
 	this->mainVolumeCtrl->VolumeDown();
@@ -140,13 +160,13 @@ void AudioController::VolumeDown()
 void AudioController::ActivateAudioController(bool need2ReOpenSoundDevices)
 {
 	if (this->state!=DEACTIVATED && this->state!=STARTING_UP) return;
-	Logger::LogDebug("AudioController::ActivateAudioController -> Activating audio controller.");
+	LOG_DEBUG("AudioController::ActivateAudioController -> Activating audio controller.");
 	this->EnterActivatingSources(need2ReOpenSoundDevices);
 }
 
 void AudioController::DeactivateController(bool doMuteRamp)
 {
-	Logger::LogDebug("AudioController::DeactivateAudioController -> DeActivating audio controller.");
+	LOG_DEBUG("AudioController::DeactivateAudioController -> DeActivating audio controller.");
 	//already on deactivation sequence? -> do nothing
 	if (this->state==DEACTIVATED || this->state==DEACTIVATING_SOURCES || this->state==STOPING_PLAYING) return;
 
@@ -158,19 +178,19 @@ void AudioController::DeactivateController(bool doMuteRamp)
 
 void AudioController::TriggerSourceNextPressed()
 {
-	Logger::LogDebug("AudioController::TriggerSourceNextPressed -> Audio controller request to trigger current source that next has pressed.");
+	LOG_DEBUG("AudioController::TriggerSourceNextPressed -> Audio controller request to trigger current source that next has pressed.");
 	this->audioSources->GetCurrentSource()->Next();
 }
 
 void AudioController::TriggerSourcePrevPressed()
 {
-	Logger::LogDebug("AudioController::TriggerSourcePrevPressed -> Audio controller request to trigger current source that prev has pressed.");
+	LOG_DEBUG("AudioController::TriggerSourcePrevPressed -> Audio controller request to trigger current source that prev has pressed.");
 	this->audioSources->GetCurrentSource()->Previous();
 }
 
 void AudioController::TriggerFavPressed(AbstractAudioSource::FavoriteT favorite)
 {
-	Logger::LogDebug("AudioController::TriggerSourcePrevPressed -> Audio controller request to trigger"
+	LOG_DEBUG("AudioController::TriggerSourcePrevPressed -> Audio controller request to trigger"
 			" current source that a favorite key has been pressed. Fav: %d", favorite);
 
 	this->audioSources->GetCurrentSource()->Favorite(favorite);
@@ -178,13 +198,13 @@ void AudioController::TriggerFavPressed(AbstractAudioSource::FavoriteT favorite)
 
 void AudioController::OnStateChanged(AbstractAudioSource *src, AbstractAudioSource::State newState)
 {
-	Logger::LogDebug("AudioController::OnStateChanged -> Audio controller received state change event from source %s. New State: %s",
+	LOG_DEBUG("AudioController::OnStateChanged -> Audio controller received state change event from source %s. New State: %s",
 			src->GetName(), AbstractAudioSource::StateNames[newState]);
 
 	switch(this->state)
 	{
 	case _NOT_SET:
-		Logger::LogError("State Machine Error: Audio controller in state _NOT_SET but source %s changed to state %s.", src->GetName(),
+		LOG_ERROR("State Machine Error: Audio controller in state _NOT_SET but source %s changed to state %s.", src->GetName(),
 				AbstractAudioSource::StateNames[newState]);
 		break;
 
@@ -276,30 +296,31 @@ void AudioController::EnterActivated()
 void AudioController::SetState(State newState)
 {
 	this->state=newState;
-	Logger::LogDebug("AudioController::SetState -> Audio controller entered new state: %s", StateNames[newState]);
+	LOG_DEBUG("AudioController::SetState -> Audio controller entered new state: %s", StateNames[newState]);
+	this->UpdateVolumeKeyHandler();
 
 	if (this->listener != NULL)
-	{
-		StateChangeEvent *event=new StateChangeEvent;
-		event->controller=this;
-		event->newState=newState;
-		g_idle_add(AudioController::NotifyStateChange, event);
-	}
+		StateChangeDispatcher::Instance()->Post(this, newState);
 }
 
-gboolean AudioController::NotifyStateChange(gpointer user_data)
+void AudioController::UpdateVolumeKeyHandler()
 {
-	StateChangeEvent *event=(StateChangeEvent *)user_data;
-	event->controller->listener->OnStateChanged(event->newState);
-	delete event;
+	//while playing unmuted volume keys need nothing from the main loop -> the audio control thread handles them
+	if (this->state==ACTIVATED && !this->muted)
+		AudioControlThread::Instance()->SetVolumeKeyHandler(this->mainVolumeCtrl);
+	else
+		AudioControlThread::Instance()->SetVolumeKeyHandler(NULL);
+}
 
-	return FALSE;
+void AudioController::DeliverStateChange(int newState)
+{
+	this->listener->OnStateChanged((State)newState);
 }
 
 void AudioController::CheckStateMachine(bool passed, const char *stateToEnter)
 {
 	if (!passed)
-		Logger::LogError("AudioController state machine error. Entering state %s from state: %s", stateToEnter,
+		LOG_ERROR("AudioController state machine error. Entering state %s from state: %s", stateToEnter,
 				StateNames[this->state]);
 }
 
@@ -11,12 +11,14 @@
 #include "AudioSources/RetroradioAudioSourceList.h"
 
 #include "MainVolumeControl.h"
+#include "StateChangeDispatcher.h"
 
 
 namespace retroradio_controller
 {
 
-class AudioController : public AbstractAudioSource::IAudioSourceStateListener
+class AudioController : public AbstractAudioSource::IAudioSourceStateListener,
+	public StateChangeDispatcher::IStateChangeSender
 {
 
 public:
@@ -38,15 +40,11 @@ public:
 	{
 	public:
 		virtual void OnStateChanged(State newState)=0;
-	};
 
-private:
-	struct StateChangeEvent
-	{
-		AudioController *controller;
-		State newState;
+		virtual void OnSourcesStartupFinished()=0;
 	};
 
+private:
 	bool muted;
 
 	IStateListener *listener;
@@ -65,9 +63,9 @@ private:
 
 	void SetState(State newState);
 
-	void CheckStateMachine(bool passed, const char *stateToEnter);
+	void UpdateVolumeKeyHandler();
 
-	static gboolean NotifyStateChange(gpointer user_data);
+	void CheckStateMachine(bool passed, const char *stateToEnter);
 
 	const char *ConfigGetMixerName();
 
@@ -83,6 +81,8 @@ public:
 
 	bool CheckSourcesStartupState();
 
+	void WaitForSourcesStartup();
+
 	void ActivateAudioController(bool need2ReOpenSoundDevices);
 
 	void DeactivateController(bool doMuteRamp);
@@ -119,6 +119,11 @@ public:
 
 	virtual void OnStateChanged(AbstractAudioSource *src, AbstractAudioSource::State newState);
 
+	virtual void OnStartupFinished(AbstractAudioSource *src);
+
+	//StateChangeDispatcher::IStateChangeSender
+	virtual void DeliverStateChange(int newState);
+
 	State GetState();
 };
 
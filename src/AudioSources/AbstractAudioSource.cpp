@@ -7,8 +7,9 @@
 
 #include "AbstractAudioSource.h"
 
-#include "cpp-app-utils/Logger.h"
+#include "Logging.h"
 #include "RetroradioControllerConfiguration.h"
+#include "LatencyTracer.h"
 
 using namespace CppAppUtils;
 using namespace retroradio_controller;
@@ -35,11 +36,12 @@ const char *AbstractAudioSource::StateNames[] =
 AbstractAudioSource::AbstractAudioSource(const char *srcName,
 		AbstractAudioSource* predecessor,
 		IAudioSourceStateListener *listener) :
-		listener(listener),
 		name(srcName),
-		successor(NULL),
 		srcState(_NOT_SET),
-		muted(false)
+		muted(false),
+		listener(listener),
+		successor(NULL),
+		startupNotifier(this)
 {
 	this->predecessor=predecessor;
 	if (predecessor!=NULL)
@@ -51,6 +53,8 @@ AbstractAudioSource::AbstractAudioSource(const char *srcName,
 
 AbstractAudioSource::~AbstractAudioSource()
 {
+	StateChangeDispatcher::Instance()->Cancel(this);
+	StateChangeDispatcher::Instance()->Cancel(&this->startupNotifier);
 	delete this->muteRampCtrl;
 	if (this->alsaMixerName!=NULL)
 		free(this->alsaMixerName);
@@ -73,7 +77,7 @@ bool AbstractAudioSource::Init()
 
 void AbstractAudioSource::DeInit()
 {
-	Logger::LogDebug("AbstractAudioSource::DeInit - Deinitializing Audio Source %s.", this->name);
+	LOG_DEBUG("AbstractAudioSource::DeInit - Deinitializing Audio Source %s.", this->name);
 	this->srcState=_NOT_SET;
 }
 
@@ -82,18 +86,18 @@ void AbstractAudioSource::Activate(bool need2ReOpenSoundDevices)
 	if (this->srcState!=DEACTIVATED)
 		return;
 
-	Logger::LogDebug("AbstractAudioSource::Activate - Activating source %s.", this->name);
+	LOG_DEBUG("AbstractAudioSource::Activate - Activating source %s.", this->name);
 	this->EnterActivating(need2ReOpenSoundDevices);
 }
 
 void AbstractAudioSource::DeActivate()
 {
-	Logger::LogDebug("AbstractAudioSource::DeActivate - Requesting source %s to deactivate. Current state: %s",
+	LOG_DEBUG("AbstractAudioSource::DeActivate - Requesting source %s to deactivate. Current state: %s",
 			this->name, StateNames[this->srcState]);
 	if (this->srcState!=ACTIVE_IDLE && this->srcState!=ACTIVATING)
 		return;
 
-	Logger::LogDebug("AbstractAudioSource::DeActivate - Deactivating source %s.", this->name);
+	LOG_DEBUG("AbstractAudioSource::DeActivate - Deactivating source %s.", this->name);
 	this->EnterDeActivating();
 }
 
@@ -102,7 +106,7 @@ void AbstractAudioSource::GoOnline()
 	if (this->srcState!=ACTIVE_IDLE)
 		return;
 
-	Logger::LogDebug("AbstractAudioSource::GoOnline - Source %s is now going online.", this->name);
+	LOG_DEBUG("AbstractAudioSource::GoOnline - Source %s is now going online.", this->name);
 	this->EnterStartPlaying();
 }
 
@@ -111,7 +115,7 @@ void AbstractAudioSource::GoOffline(bool doMuteRamp)
 	if (this->srcState!=PLAYING && this->srcState!=START_PLAYING && this->srcState!=START_PLAYING_RAMP)
 		return;
 
-	Logger::LogDebug("AbstractAudioSource::GoOffline - Source %s is now going offline.", this->name);
+	LOG_DEBUG("AbstractAudioSource::GoOffline - Source %s is now going offline.", this->name);
 
 	if (this->srcState==START_PLAYING_RAMP || this->srcState==PLAYING)
 	{
@@ -131,17 +135,17 @@ void AbstractAudioSource::GoOffline(bool doMuteRamp)
 
 void AbstractAudioSource::Next()
 {
-	Logger::LogDebug("AbstractAudioSource::Next - Source %s received next command.", this->name);
+	LOG_DEBUG("AbstractAudioSource::Next - Source %s received next command.", this->name);
 }
 
 void AbstractAudioSource::Previous()
 {
-	Logger::LogDebug("AbstractAudioSource::Previous - Source %s received previous command.", this->name);
+	LOG_DEBUG("AbstractAudioSource::Previous - Source %s received previous command.", this->name);
 }
 
 void AbstractAudioSource::Favorite(FavoriteT favorite)
 {
-	Logger::LogDebug("AbstractAudioSource::Previous - Source %s received favorite command. Fav: %d", this->name, favorite);
+	LOG_DEBUG("AbstractAudioSource::Previous - Source %s received favorite command. Fav: %d", this->name, favorite);
 }
 
 AbstractAudioSource *AbstractAudioSource::GetSuccessor()
@@ -161,12 +165,12 @@ const char *AbstractAudioSource::GetName()
 
 void AbstractAudioSource::EnterActivating(bool need2ReOpenSoundDevices)
 {
-	Logger::LogDebug("AbstractAudioSource::EnterActivating - Activating source %s.", this->name);
+	LOG_DEBUG("AbstractAudioSource::EnterActivating - Activating source %s.", this->name);
 	this->SetState(ACTIVATING);
 
 	if (need2ReOpenSoundDevices)
 	{
-		Logger::LogDebug("AbstractAudioSource::EnterActivating - Need to initialize mute ramp control.");
+		LOG_DEBUG("AbstractAudioSource::EnterActivating - Need to initialize mute ramp control.");
 		this->muteRampCtrl->DeInit();
 		this->muteRampCtrl->Init(this->soundCardName, this->alsaMixerName);
 	}
@@ -176,7 +180,7 @@ void AbstractAudioSource::EnterActivating(bool need2ReOpenSoundDevices)
 
 void AbstractAudioSource::EnterActivated()
 {
-	Logger::LogDebug("AbstractAudioSource::EnterActivated - Source %s activated.", this->name);
+	LOG_DEBUG("AbstractAudioSource::EnterActivated - Source %s activated.", this->name);
 	this->SetState(ACTIVE_IDLE);
 }
 
@@ -192,14 +196,14 @@ void AbstractAudioSource::SourceActivationFinished()
 
 void AbstractAudioSource::EnterDeActivating()
 {
-	Logger::LogDebug("AbstractAudioSource::EnterDeActivating - DeActivating source %s.", this->name);
+	LOG_DEBUG("AbstractAudioSource::EnterDeActivating - DeActivating source %s.", this->name);
 	this->SetState(DEACTIVATING);
 	this->DoDeActivateSource();
 }
 
 void AbstractAudioSource::EnterDeActivated()
 {
-	Logger::LogDebug("AbstractAudioSource::EnterDeActivated - Source %s deactivated.", this->name);
+	LOG_DEBUG("AbstractAudioSource::EnterDeActivated - Source %s deactivated.", this->name);
 	this->SetState(DEACTIVATED);
 }
 
@@ -215,7 +219,7 @@ void AbstractAudioSource::SourceDeActivationFinished()
 
 void AbstractAudioSource::EnterStartPlaying()
 {
-	Logger::LogDebug("AbstractAudioSource::EnterStartPlaying - Source %s prepares for playing.", this->name);
+	LOG_DEBUG("AbstractAudioSource::EnterStartPlaying - Source %s prepares for playing.", this->name);
 	this->SetState(START_PLAYING);
 	this->DoStartPlaying();
 }
@@ -229,7 +233,7 @@ void AbstractAudioSource::SourceStartPlayingFinished()
 {
 	if (this->muted)
 	{
-		Logger::LogDebug("AbstractAudioSource::SourceStartPlayingFinished - Audio controller muted. Not ramping up volume of source %s.", this->name);
+		LOG_DEBUG("AbstractAudioSource::SourceStartPlayingFinished - Audio controller muted. Not ramping up volume of source %s.", this->name);
 		this->EnterPlaying();
 	}
 	else
@@ -238,27 +242,27 @@ void AbstractAudioSource::SourceStartPlayingFinished()
 
 void AbstractAudioSource::EnterStartPlayingRamp()
 {
-	Logger::LogDebug("AbstractAudioSource::EnterStartPlayingRamp - Source %s ramps up volume.", this->name);
+	LOG_DEBUG("AbstractAudioSource::EnterStartPlayingRamp - Source %s ramps up volume.", this->name);
 	this->SetState(START_PLAYING_RAMP);
 	this->muteRampCtrl->UnmuteAsync(SourceMuteRampCtrl::NORMAL);
 }
 
 void AbstractAudioSource::EnterPlaying()
 {
-	Logger::LogDebug("AbstractAudioSource::EnterPlaying - Source %s now playing.", this->name);
+	LOG_DEBUG("AbstractAudioSource::EnterPlaying - Source %s now playing.", this->name);
 	this->SetState(PLAYING);
 }
 
 void AbstractAudioSource::EnterStopPlayingRamp()
 {
-	Logger::LogDebug("AbstractAudioSource::EnterStopPlayingRamp - Source %s ramps down volume.", this->name);
+	LOG_DEBUG("AbstractAudioSource::EnterStopPlayingRamp - Source %s ramps down volume.", this->name);
 	this->SetState(STOP_PLAYING_RAMP);
 	this->muteRampCtrl->MuteAsync(SourceMuteRampCtrl::NORMAL);
 }
 
 void AbstractAudioSource::EnterStopPlaying()
 {
-	Logger::LogDebug("AbstractAudioSource::EnterStopPlaying - Source %s about to stop playing.", this->name);
+	LOG_DEBUG("AbstractAudioSource::EnterStopPlaying - Source %s about to stop playing.", this->name);
 	this->SetState(STOP_PLAYING);
 	this->DoStopPlaying();
 }
@@ -276,23 +280,14 @@ void AbstractAudioSource::SourceStopPlayingFinished()
 void AbstractAudioSource::SetState(State newState)
 {
 	this->srcState=newState;
-	Logger::LogDebug("AbstractAudioSource::SetState - Source %s now in state: %s", this->name, StateNames[newState]);
+	LOG_DEBUG("AbstractAudioSource::SetState - Source %s now in state: %s", this->name, StateNames[newState]);
 	if (this->listener != NULL)
-	{
-		StateChangeEvent *event=new StateChangeEvent;
-		event->src=this;
-		event->newState=newState;
-		g_idle_add(AbstractAudioSource::NotifyStateChange, event);
-	}
+		StateChangeDispatcher::Instance()->Post(this, newState);
 }
 
-gboolean AbstractAudioSource::NotifyStateChange(gpointer user_data)
+void AbstractAudioSource::DeliverStateChange(int newState)
 {
-	StateChangeEvent *event=(StateChangeEvent *)user_data;
-	event->src->listener->OnStateChanged(event->src, event->newState);
-	delete event;
-
-	return FALSE;
+	this->listener->OnStateChanged(this, (State)newState);
 }
 
 bool AbstractAudioSource::IsPlaying()
@@ -315,7 +310,7 @@ bool AbstractAudioSource::IsActive()
 
 void AbstractAudioSource::StopMuteRamp()
 {
-	Logger::LogDebug("AbstractAudioSource::StopTransition - Source %s requested to stop any transition ongoing.", this->name);
+	LOG_DEBUG("AbstractAudioSource::StopTransition - Source %s requested to stop any transition ongoing.", this->name);
 	this->muteRampCtrl->StopOperation();
 }
 
@@ -326,10 +321,11 @@ AbstractAudioSource::State AbstractAudioSource::GetState()
 
 void AbstractAudioSource::OnRampFinished(bool canceled)
 {
-	Logger::LogDebug("AbstractAudioSource::OnRampFinished - Source %s received a ramp %s signal from ramp control.",
+	LOG_DEBUG("AbstractAudioSource::OnRampFinished - Source %s received a ramp %s signal from ramp control.",
 			this->name, canceled ? "canceled" : "finished");
+	LatencyTracer::Instance()->Mark(LatencyTracer::TRACE_RAMP_FINISHED, canceled);
 
-	Logger::LogDebug("AbstractAudioSource::OnRampFinished - State %s", StateNames[this->srcState]);
+	LOG_DEBUG("AbstractAudioSource::OnRampFinished - State %s", StateNames[this->srcState]);
 
 	if (this->srcState==START_PLAYING_RAMP)
 		this->EnterPlaying();
@@ -339,7 +335,7 @@ void AbstractAudioSource::OnRampFinished(bool canceled)
 
 void AbstractAudioSource::SetMuted(bool muted)
 {
-	Logger::LogDebug("AbstractAudioSource::SetMuted - Source %s received %s request.",
+	LOG_DEBUG("AbstractAudioSource::SetMuted - Source %s received %s request.",
 			this->name, muted ? "mute" : "unmute");
 
 	this->muted=muted;
@@ -384,11 +380,38 @@ bool AbstractAudioSource::IsMuted()
 	return this->muted;
 }
 
+const char *AbstractAudioSource::ConfigGetSoundCardName()
+{
+	return this->soundCardName!=NULL ? this->soundCardName : this->GetDefaultSoundCardName();
+}
+
 bool AbstractAudioSource::IsStartupFinished()
 {
 	return true;
 }
 
+void AbstractAudioSource::WaitForStartup()
+{
+	this->SourceStartupFinished();
+}
+
+void AbstractAudioSource::SourceStartupFinished()
+{
+	LOG_DEBUG("AbstractAudioSource::SourceStartupFinished - Source %s finished starting up.", this->name);
+	if (this->listener != NULL)
+		StateChangeDispatcher::Instance()->Post(&this->startupNotifier, 0);
+}
+
+AbstractAudioSource::StartupNotifier::StartupNotifier(AbstractAudioSource *source) :
+		source(source)
+{
+}
+
+void AbstractAudioSource::StartupNotifier::DeliverStateChange(int newState)
+{
+	this->source->listener->OnStartupFinished(this->source);
+}
+
 bool AbstractAudioSource::IsConfigFileGroupKnown(
 		const char* group)
 {
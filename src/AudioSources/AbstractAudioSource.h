@@ -12,6 +12,7 @@
 
 #include "BasicMixerControl.h"
 #include "AudioSources/SourceMuteRampCtrl.h"
+#include "StateChangeDispatcher.h"
 #include "cpp-app-utils/Configuration.h"
 
 using namespace CppAppUtils;
@@ -19,7 +20,7 @@ using namespace CppAppUtils;
 namespace retroradio_controller {
 
 class AbstractAudioSource : public SourceMuteRampCtrl::IMuteRampCtrlListener,
-	public Configuration::IConfigurationParserModule
+	public Configuration::IConfigurationParserModule, public StateChangeDispatcher::IStateChangeSender
 {
 
 public:
@@ -58,14 +59,24 @@ public:
 	{
 	public:
 		virtual void OnStateChanged(AbstractAudioSource *src, State newState)=0;
+
+		//called once the source is ready for activation after WaitForStartup
+		virtual void OnStartupFinished(AbstractAudioSource *src)=0;
 	};
 
 
 private:
-	struct StateChangeEvent
+	//posts the startup notification through the state change dispatcher. A sender of its own, so it is
+	//not coalesced with the source's state changes.
+	class StartupNotifier : public StateChangeDispatcher::IStateChangeSender
 	{
-		AbstractAudioSource *src;
-		State newState;
+	private:
+		AbstractAudioSource *source;
+
+	public:
+		StartupNotifier(AbstractAudioSource *source);
+
+		virtual void DeliverStateChange(int newState);
 	};
 
 	const char *name;
@@ -86,7 +97,7 @@ private:
 
 	char *soundCardName;
 
-	static gboolean NotifyStateChange(gpointer user_data);
+	StartupNotifier startupNotifier;
 
 	void EnterActivating(bool need2ReOpenSoundDevices);
 
@@ -115,6 +126,10 @@ protected:
 
 	virtual const char *GetDefaultSoundCardName()=0;
 
+	const char *ConfigGetSoundCardName();
+
+	void SourceStartupFinished();
+
 	virtual void DoActivateSource(bool need2ReOpenSoundDevices);
 
 	virtual void SourceActivationFinished();
@@ -160,6 +175,10 @@ public:
 
 	virtual bool IsStartupFinished();
 
+	//starts waiting for the services the source depends on. Readiness is signaled via
+	//IAudioSourceStateListener::OnStartupFinished.
+	virtual void WaitForStartup();
+
 	bool IsPlaying();
 
 	bool IsTransitioningFromOrToPlay();
@@ -186,6 +205,9 @@ public:
 
 	virtual void OnRampFinished(bool canceled);
 
+	//StateChangeDispatcher::IStateChangeSender
+	virtual void DeliverStateChange(int newState);
+
 	bool IsMuted();
 
 	virtual bool ParseConfigFileItem(GKeyFile *confFile, const char *group, const char *key);
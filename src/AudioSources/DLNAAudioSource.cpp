@@ -7,7 +7,7 @@
 
 #include "DLNAAudioSource.h"
 
-#include <cpp-app-utils/Logger.h>
+#include "Logging.h"
 
 using namespace CppAppUtils;
 
@@ -33,7 +33,7 @@ bool DLNAAudioSource::Init()
 	if (!AbstractAudioSource::Init())
 		return false;
 
-	Logger::LogDebug("DLNAAudioSource::Init - Initializing DLNA Audio Source %s.", this->GetName());
+	LOG_DEBUG("DLNAAudioSource::Init - Initializing DLNA Audio Source %s.", this->GetName());
 	return true;
 }
 
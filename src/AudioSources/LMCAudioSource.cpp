@@ -7,7 +7,7 @@
 
 #include "LMCAudioSource.h"
 
-#include <cpp-app-utils/Logger.h>
+#include "Logging.h"
 
 #define LMC_CONFIG_GROUP 				"LMC Source"
 #define LMC_DEFAULT_ALSA_MIXER_NAME		"lmc_vol"
@@ -32,7 +32,7 @@ bool LMCAudioSource::Init()
 {
 	if (!AbstractAudioSource::Init())
 		return false;
-	Logger::LogDebug("LMCAudioSource::Init - Initializing LMC Audio Source %s.", this->GetName());
+	LOG_DEBUG("LMCAudioSource::Init - Initializing LMC Audio Source %s.", this->GetName());
 	return true;
 }
 
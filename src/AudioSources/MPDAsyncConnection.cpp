@@ -0,0 +1,725 @@
+/*
+ * MPDAsyncConnection.cpp
+ *
+ *  Created on: 17.10.2026
+ *      Author: joe
+ */
+
+#include "MPDAsyncConnection.h"
+
+#include "Logging.h"
+#include "TimerWheel.h"
+
+#include <glib-unix.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+using namespace CppAppUtils;
+
+using namespace retroradio_controller;
+
+#define MPD_GREETING_PREFIX		"OK MPD "
+
+//tcp keep alive settings to detect a vanished mpd host within about 25s without polling it
+#define MPD_KEEPALIVE_IDLE_S	10
+#define MPD_KEEPALIVE_INTVL_S	5
+#define MPD_KEEPALIVE_CNT		3
+
+//internal tag of the idle command parking the connection. Its answer is not forwarded to the listener.
+#define MPD_PARK_CMD_TAG		-2
+
+//internal tag of the end of a command list. Mpd answers a whole list with an additional OK.
+#define MPD_LIST_END_CMD_TAG	-3
+
+MPDAsyncConnection::MPDAsyncConnection(IMPDConnectionListener *listener) :
+		listener(listener),
+		state(DISCONNECTED),
+		socketFd(-1),
+		isUnixSocket(false),
+		async(NULL),
+		parser(NULL),
+		fdEventId(0),
+		fdEventCondition((GIOCondition)0),
+		connectTimerId(0),
+		resolveCancellable(NULL),
+		resolvePort(0),
+		connectionGeneration(0),
+		pendingCmdHead(0),
+		pendingCmdCnt(0),
+		parkInIdle(false),
+		commandListActive(false)
+{
+}
+
+MPDAsyncConnection::~MPDAsyncConnection()
+{
+	this->CloseConnection();
+}
+
+bool MPDAsyncConnection::Connect(const char *host, unsigned int port, unsigned int timeoutMs)
+{
+	GInetAddress *address;
+	GResolver *resolver;
+	int result;
+
+	if (this->state!=DISCONNECTED)
+		this->CloseConnection();
+
+	this->isUnixSocket=host[0]=='/';
+	if (this->isUnixSocket)
+	{
+		LOG_DEBUG("MPDAsyncConnection::Connect - Connecting to mpd daemon at %s.", host);
+		result=this->CreateUnixSocket(host);
+	}
+	else if (g_hostname_is_ip_address(host))
+	{
+		LOG_DEBUG("MPDAsyncConnection::Connect - Connecting to mpd daemon at %s:%u.", host, port);
+		address=g_inet_address_new_from_string(host);
+		result=this->CreateTcpSocket(address, port);
+		g_object_unref(address);
+	}
+	else
+	{
+		//getaddrinfo would block the main loop for the whole dns lookup -> connected when resolved
+		LOG_DEBUG("MPDAsyncConnection::Connect - Resolving mpd host %s.", host);
+		this->resolvePort=port;
+		this->resolveCancellable=g_cancellable_new();
+		resolver=g_resolver_get_default();
+		g_resolver_lookup_by_name_async(resolver, host, this->resolveCancellable,
+				MPDAsyncConnection::OnHostResolved, this);
+		g_object_unref(resolver);
+
+		this->state=CONNECTING;
+		this->connectTimerId=TimerWheel::Instance()->Add(timeoutMs, TimerWheel::TIMER_SLACK_LAZY,
+				MPDAsyncConnection::OnConnectTimeout, this);
+		return true;
+	}
+
+	if (result!=0 && errno!=EINPROGRESS && errno!=EAGAIN)
+	{
+		LOG_DEBUG("MPDAsyncConnection::Connect - Unable to connect to mpd daemon: %s", strerror(errno));
+		this->CloseConnection();
+		return false;
+	}
+
+	//connection established immediately (e.g. unix socket) -> socket is writable right away
+	this->state=CONNECTING;
+	this->WatchFd(G_IO_OUT);
+	this->connectTimerId=TimerWheel::Instance()->Add(timeoutMs, TimerWheel::TIMER_SLACK_LAZY,
+			MPDAsyncConnection::OnConnectTimeout, this);
+
+	return true;
+}
+
+void MPDAsyncConnection::OnHostResolved(GObject *source, GAsyncResult *result, gpointer user_data)
+{
+	MPDAsyncConnection *instance;
+	GError *error=NULL;
+	GList *addresses;
+	int connectResult;
+
+	addresses=g_resolver_lookup_by_name_finish(G_RESOLVER(source), result, &error);
+
+	//cancelled by closing the connection. The instance might be deleted already.
+	if (addresses==NULL && g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+	{
+		g_error_free(error);
+		return;
+	}
+
+	instance=(MPDAsyncConnection *)user_data;
+	g_object_unref(instance->resolveCancellable);
+	instance->resolveCancellable=NULL;
+
+	if (addresses==NULL)
+	{
+		LOG_ERROR("Unable to resolve mpd host: %s", error!=NULL ? error->message : "unknown error");
+		if (error!=NULL)
+			g_error_free(error);
+		instance->ConnectionLost("unable to resolve host");
+		return;
+	}
+
+	connectResult=instance->CreateTcpSocket((GInetAddress *)addresses->data, instance->resolvePort);
+	g_resolver_free_addresses(addresses);
+
+	if (connectResult!=0 && errno!=EINPROGRESS && errno!=EAGAIN)
+	{
+		LOG_DEBUG("MPDAsyncConnection::OnHostResolved - Unable to connect to mpd daemon: %s", strerror(errno));
+		instance->ConnectionLost("connect failed");
+		return;
+	}
+
+	instance->WatchFd(G_IO_OUT);
+}
+
+int MPDAsyncConnection::CreateTcpSocket(GInetAddress *address, unsigned int port)
+{
+	GSocketAddress *socketAddress;
+	struct sockaddr_storage addr;
+	socklen_t addrLen;
+	bool converted;
+
+	socketAddress=g_inet_socket_address_new(address, port);
+	addrLen=g_socket_address_get_native_size(socketAddress);
+	converted=g_socket_address_to_native(socketAddress, &addr, sizeof(addr), NULL);
+	g_object_unref(socketAddress);
+	if (!converted)
+	{
+		errno=EAFNOSUPPORT;
+		return -1;
+	}
+
+	this->socketFd=socket(addr.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (this->socketFd==-1)
+	{
+		LOG_ERROR("Unable to create socket for mpd connection: %s", strerror(errno));
+		return -1;
+	}
+
+	return connect(this->socketFd, (struct sockaddr *)&addr, addrLen);
+}
+
+int MPDAsyncConnection::CreateUnixSocket(const char *path)
+{
+	struct sockaddr_un addr;
+
+	if (strlen(path)>=sizeof(addr.sun_path))
+	{
+		LOG_ERROR("Path of mpd socket %s too long.", path);
+		errno=ENAMETOOLONG;
+		return -1;
+	}
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family=AF_UNIX;
+	strcpy(addr.sun_path, path);
+
+	this->socketFd=socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (this->socketFd==-1)
+	{
+		LOG_ERROR("Unable to create socket for mpd connection: %s", strerror(errno));
+		return -1;
+	}
+
+	return connect(this->socketFd, (struct sockaddr *)&addr, sizeof(addr));
+}
+
+void MPDAsyncConnection::Disconnect()
+{
+	if (this->state==DISCONNECTED)
+		return;
+
+	LOG_DEBUG("MPDAsyncConnection::Disconnect - Disconnecting from mpd daemon.");
+	this->CloseConnection();
+}
+
+void MPDAsyncConnection::CloseConnection()
+{
+	if (this->connectTimerId!=0)
+	{
+		TimerWheel::Instance()->Remove(this->connectTimerId);
+		this->connectTimerId=0;
+	}
+
+	if (this->resolveCancellable!=NULL)
+	{
+		g_cancellable_cancel(this->resolveCancellable);
+		g_object_unref(this->resolveCancellable);
+		this->resolveCancellable=NULL;
+	}
+
+	if (this->fdEventId!=0)
+	{
+		g_source_remove(this->fdEventId);
+		this->fdEventId=0;
+		this->fdEventCondition=(GIOCondition)0;
+	}
+
+	if (this->parser!=NULL)
+	{
+		mpd_parser_free(this->parser);
+		this->parser=NULL;
+	}
+
+	//mpd_async_free closes the socket as well
+	if (this->async!=NULL)
+	{
+		mpd_async_free(this->async);
+		this->async=NULL;
+		this->socketFd=-1;
+	}
+
+	if (this->socketFd!=-1)
+	{
+		close(this->socketFd);
+		this->socketFd=-1;
+	}
+
+	this->pendingCmdHead=0;
+	this->pendingCmdCnt=0;
+	this->commandListActive=false;
+	this->state=DISCONNECTED;
+	this->connectionGeneration++;
+}
+
+void MPDAsyncConnection::Abort(const char *reason)
+{
+	if (this->state==DISCONNECTED)
+		return;
+
+	this->ConnectionLost(reason);
+}
+
+void MPDAsyncConnection::ConnectionLost(const char *reason)
+{
+	int cmdTags[MPD_MAX_PENDING_COMMANDS];
+	unsigned int cmdCnt=0;
+	int cmdTag;
+	char reasonCopy[256];
+
+	//reason might point into the async object which is freed when closing the connection
+	snprintf(reasonCopy, sizeof(reasonCopy), "%s", reason!=NULL ? reason : "unknown");
+	reason=reasonCopy;
+
+	LOG_DEBUG("MPDAsyncConnection::ConnectionLost - Connection to mpd daemon lost: %s", reason);
+
+	while ((cmdTag=this->PopPendingCommand())!=-1)
+		if (cmdTag>=0)
+			cmdTags[cmdCnt++]=cmdTag;
+
+	this->CloseConnection();
+
+	if (this->listener==NULL)
+		return;
+
+	//commands not answered anymore are finished with an error to let the listener clean up
+	for (unsigned int a=0; a<cmdCnt; a++)
+		this->listener->OnMPDCommandFinished(this, cmdTags[a], false, reason);
+
+	this->listener->OnMPDConnectionLost(this);
+}
+
+gboolean MPDAsyncConnection::OnConnectTimeout(gpointer user_data)
+{
+	MPDAsyncConnection *instance=(MPDAsyncConnection *)user_data;
+
+	// timer itsself is disabled by returning FALSE here.
+	instance->connectTimerId=0;
+	instance->ConnectionLost("timeout while connecting");
+
+	return FALSE;
+}
+
+gboolean MPDAsyncConnection::OnSocketEvent(gint fd, GIOCondition condition, gpointer user_data)
+{
+	MPDAsyncConnection *instance=(MPDAsyncConnection *)user_data;
+	instance->ProcessSocketEvent(condition);
+	return TRUE;
+}
+
+void MPDAsyncConnection::ProcessSocketEvent(GIOCondition condition)
+{
+	int events=0;
+
+	if (this->state==CONNECTING)
+	{
+		if (!this->FinishConnect())
+			this->ConnectionLost("connect failed");
+		return;
+	}
+
+	if (this->async==NULL)
+		return;
+
+	if ((condition & G_IO_IN)!=0)	events|=MPD_ASYNC_EVENT_READ;
+	if ((condition & G_IO_OUT)!=0)	events|=MPD_ASYNC_EVENT_WRITE;
+	if ((condition & G_IO_HUP)!=0)	events|=MPD_ASYNC_EVENT_HUP;
+	if ((condition & G_IO_ERR)!=0)	events|=MPD_ASYNC_EVENT_ERROR;
+
+	if (!mpd_async_io(this->async, (enum mpd_async_event)events))
+	{
+		this->ConnectionLost(mpd_async_get_error_message(this->async));
+		return;
+	}
+
+	this->ReceiveLines();
+}
+
+bool MPDAsyncConnection::FinishConnect()
+{
+	int error=0;
+	socklen_t len=sizeof(error);
+	int keepAlive=1;
+	int keepAliveIdle=MPD_KEEPALIVE_IDLE_S;
+	int keepAliveIntvl=MPD_KEEPALIVE_INTVL_S;
+	int keepAliveCnt=MPD_KEEPALIVE_CNT;
+
+	if (this->connectTimerId!=0)
+	{
+		TimerWheel::Instance()->Remove(this->connectTimerId);
+		this->connectTimerId=0;
+	}
+
+	if (getsockopt(this->socketFd, SOL_SOCKET, SO_ERROR, &error, &len)!=0 || error!=0)
+	{
+		LOG_DEBUG("MPDAsyncConnection::FinishConnect - Unable to connect to mpd daemon: %s", strerror(error));
+		return false;
+	}
+
+	//a vanished local daemon is reported by the unix socket itsself
+	if (!this->isUnixSocket)
+	{
+		setsockopt(this->socketFd, SOL_SOCKET, SO_KEEPALIVE, &keepAlive, sizeof(keepAlive));
+		setsockopt(this->socketFd, IPPROTO_TCP, TCP_KEEPIDLE, &keepAliveIdle, sizeof(keepAliveIdle));
+		setsockopt(this->socketFd, IPPROTO_TCP, TCP_KEEPINTVL, &keepAliveIntvl, sizeof(keepAliveIntvl));
+		setsockopt(this->socketFd, IPPROTO_TCP, TCP_KEEPCNT, &keepAliveCnt, sizeof(keepAliveCnt));
+	}
+
+	this->async=mpd_async_new(this->socketFd);
+	this->parser=mpd_parser_new();
+	if (this->async==NULL || this->parser==NULL)
+	{
+		LOG_ERROR("Unable to allocate mpd async connection objects.");
+		return false;
+	}
+
+	LOG_DEBUG("MPDAsyncConnection::FinishConnect - Socket connected. Waiting for greeting of mpd daemon.");
+	this->state=WAITING_FOR_GREETING;
+	this->UpdateFdWatch();
+
+	return true;
+}
+
+void MPDAsyncConnection::ReceiveLines()
+{
+	unsigned int generation=this->connectionGeneration;
+	char *line;
+
+	while ((line=mpd_async_recv_line(this->async))!=NULL)
+	{
+		if (!this->ProcessLine(line))
+		{
+			//connection closed by a listener or by a protocol error
+			if (generation==this->connectionGeneration)
+				this->ConnectionLost("malformed response");
+			return;
+		}
+
+		if (generation!=this->connectionGeneration)
+			return;
+	}
+
+	if (mpd_async_get_error(this->async)!=MPD_ERROR_SUCCESS)
+	{
+		this->ConnectionLost(mpd_async_get_error_message(this->async));
+		return;
+	}
+
+	this->ParkIfIdle();
+	this->UpdateFdWatch();
+}
+
+void MPDAsyncConnection::ParkIfIdle()
+{
+	if (!this->parkInIdle || this->state!=CONNECTED || this->pendingCmdCnt!=0)
+		return;
+
+	//"message" events are only sent for subscribed client to client channels. We don't subscribe to any,
+	//so mpd keeps the connection idle until we cancel it with noidle.
+	if (!mpd_async_send_command(this->async, "idle", "message", NULL))
+	{
+		LOG_ERROR("Unable to park mpd connection in idle mode: %s", mpd_async_get_error_message(this->async));
+		return;
+	}
+
+	this->PushPendingCommand(MPD_PARK_CMD_TAG, false);
+}
+
+void MPDAsyncConnection::SetParkInIdle(bool park)
+{
+	this->parkInIdle=park;
+}
+
+bool MPDAsyncConnection::ProcessLine(char *line)
+{
+	enum mpd_parser_result result;
+	int cmdTag;
+
+	if (this->state==WAITING_FOR_GREETING)
+	{
+		if (strncmp(line, MPD_GREETING_PREFIX, strlen(MPD_GREETING_PREFIX))!=0)
+		{
+			LOG_ERROR("Unexpected greeting received from mpd daemon: %s", line);
+			return false;
+		}
+
+		LOG_DEBUG("MPDAsyncConnection::ProcessLine - Connected to mpd daemon version %s.",
+				line+strlen(MPD_GREETING_PREFIX));
+		this->state=CONNECTED;
+		if (this->listener!=NULL)
+			this->listener->OnMPDConnected(this);
+		return true;
+	}
+
+	result=mpd_parser_feed(this->parser, line);
+	cmdTag=this->GetCurrentCommand();
+
+	switch(result)
+	{
+	case MPD_PARSER_PAIR:
+		if (this->listener!=NULL && cmdTag>=0)
+			this->listener->OnMPDResponsePair(this, cmdTag,
+					mpd_parser_get_name(this->parser), mpd_parser_get_value(this->parser));
+		return true;
+
+	case MPD_PARSER_SUCCESS:
+		//"list_OK" finishes a single command of a list, the final "OK" of the list has its own internal tag
+		this->PopPendingCommand();
+		if (this->listener!=NULL && cmdTag>=0)
+			this->listener->OnMPDCommandFinished(this, cmdTag, true, NULL);
+		return true;
+
+	case MPD_PARSER_ERROR:
+		LOG_DEBUG("MPDAsyncConnection::ProcessLine - MPD daemon answered command %d with error: %s",
+				cmdTag, mpd_parser_get_message(this->parser));
+		if (this->pendingCmdCnt!=0 && this->pendingCmds[this->pendingCmdHead].inCommandList)
+		{
+			this->FailCommandList(mpd_parser_get_message(this->parser));
+			return true;
+		}
+
+		this->PopPendingCommand();
+		if (this->listener!=NULL && cmdTag>=0)
+			this->listener->OnMPDCommandFinished(this, cmdTag, false, mpd_parser_get_message(this->parser));
+		return true;
+
+	case MPD_PARSER_MALFORMED:
+		break;
+	}
+
+	LOG_ERROR("Received malformed line from mpd daemon: %s", line);
+	return false;
+}
+
+void MPDAsyncConnection::FailCommandList(const char *errorMsg)
+{
+	int cmdTags[MPD_MAX_PENDING_COMMANDS];
+	unsigned int cmdCnt=0;
+	int cmdTag;
+
+	//the failing command is the first one of the list not answered yet. Mpd skips the rest of the list.
+	do
+	{
+		cmdTag=this->PopPendingCommand();
+		if (cmdTag>=0)
+			cmdTags[cmdCnt++]=cmdTag;
+	} while (cmdTag!=MPD_LIST_END_CMD_TAG && cmdTag!=-1);
+
+	if (this->listener==NULL)
+		return;
+
+	for (unsigned int a=0; a<cmdCnt; a++)
+		this->listener->OnMPDCommandFinished(this, cmdTags[a], false,
+				a==0 ? errorMsg : "skipped due to failure of preceding command in command list");
+}
+
+bool MPDAsyncConnection::CancelParking()
+{
+	//connection parked in idle mode -> cancel it first. The pending idle is answered with OK then.
+	if (this->IsCommandPending(MPD_PARK_CMD_TAG) && !mpd_async_send_command(this->async, "noidle", NULL))
+	{
+		LOG_ERROR("Unable to cancel idle mode of mpd connection: %s", mpd_async_get_error_message(this->async));
+		return false;
+	}
+
+	return true;
+}
+
+bool MPDAsyncConnection::BeginCommandList()
+{
+	if (this->state!=CONNECTED || this->commandListActive)
+		return false;
+
+	//a begun list can't be taken back -> room for at least one command and the end of the list
+	if (this->pendingCmdCnt>=MPD_MAX_PENDING_COMMANDS-1)
+	{
+		LOG_ERROR("Too many mpd commands pending. Not starting command list.");
+		return false;
+	}
+
+	if (!this->CancelParking())
+		return false;
+
+	if (!mpd_async_send_command(this->async, "command_list_ok_begin", NULL))
+	{
+		LOG_ERROR("Unable to start command list: %s", mpd_async_get_error_message(this->async));
+		return false;
+	}
+
+	this->commandListActive=true;
+	return true;
+}
+
+bool MPDAsyncConnection::EndCommandList()
+{
+	if (this->state!=CONNECTED || !this->commandListActive)
+		return false;
+
+	this->commandListActive=false;
+	if (this->pendingCmdCnt>=MPD_MAX_PENDING_COMMANDS ||
+			!mpd_async_send_command(this->async, "command_list_end", NULL))
+	{
+		//the list can't be sent partly -> connection is unusable
+		this->Abort("unable to finish command list");
+		return false;
+	}
+
+	this->PushPendingCommand(MPD_LIST_END_CMD_TAG, true);
+	this->UpdateFdWatch();
+
+	return true;
+}
+
+bool MPDAsyncConnection::SendCommand(int cmdTag, const char *command, ...)
+{
+	va_list args;
+	bool result;
+
+	if (this->state!=CONNECTED)
+	{
+		LOG_DEBUG("MPDAsyncConnection::SendCommand - Not connected. Dropping command %s.", command);
+		return false;
+	}
+
+	//keep one slot for the end of an active command list. A partly sent list makes the connection unusable.
+	if (this->commandListActive && this->pendingCmdCnt>=MPD_MAX_PENDING_COMMANDS-1)
+	{
+		LOG_ERROR("Too many mpd commands pending. Dropping command list.");
+		this->Abort("command list too long");
+		return false;
+	}
+
+	if (this->pendingCmdCnt>=MPD_MAX_PENDING_COMMANDS)
+	{
+		LOG_ERROR("Too many mpd commands pending. Dropping command %s.", command);
+		return false;
+	}
+
+	if (!this->commandListActive && !this->CancelParking())
+		return false;
+
+	va_start(args, command);
+	result=mpd_async_send_command_v(this->async, command, args);
+	va_end(args);
+
+	if (!result)
+	{
+		LOG_ERROR("Unable to send command %s to mpd daemon: %s", command, mpd_async_get_error_message(this->async));
+		if (this->commandListActive)
+			this->Abort("unable to send command list");
+		return false;
+	}
+
+	LOG_DEBUG("MPDAsyncConnection::SendCommand - Sent command %s (tag: %d).", command, cmdTag);
+	this->PushPendingCommand(cmdTag, this->commandListActive);
+
+	//command lists are flushed to the socket when they are complete
+	if (!this->commandListActive)
+		this->UpdateFdWatch();
+
+	return true;
+}
+
+void MPDAsyncConnection::UpdateFdWatch()
+{
+	enum mpd_async_event events;
+	int condition=0;
+
+	if (this->async==NULL)
+		return;
+
+	events=mpd_async_events(this->async);
+	if ((events & MPD_ASYNC_EVENT_READ)!=0)		condition|=G_IO_IN;
+	if ((events & MPD_ASYNC_EVENT_WRITE)!=0)	condition|=G_IO_OUT;
+	if ((events & MPD_ASYNC_EVENT_HUP)!=0)		condition|=G_IO_HUP;
+	if ((events & MPD_ASYNC_EVENT_ERROR)!=0)	condition|=G_IO_ERR;
+
+	this->WatchFd((GIOCondition)condition);
+}
+
+void MPDAsyncConnection::WatchFd(GIOCondition condition)
+{
+	//g_unix_fd_add does not allow to change the condition of an existing source -> re-register on changes only
+	if (this->fdEventId!=0 && this->fdEventCondition==condition)
+		return;
+
+	if (this->fdEventId!=0)
+		g_source_remove(this->fdEventId);
+
+	this->fdEventCondition=condition;
+	this->fdEventId=g_unix_fd_add(this->socketFd, condition, MPDAsyncConnection::OnSocketEvent, this);
+}
+
+void MPDAsyncConnection::PushPendingCommand(int cmdTag, bool inCommandList)
+{
+	PendingCommand *cmd=&this->pendingCmds[(this->pendingCmdHead+this->pendingCmdCnt)%MPD_MAX_PENDING_COMMANDS];
+	cmd->cmdTag=cmdTag;
+	cmd->inCommandList=inCommandList;
+	this->pendingCmdCnt++;
+}
+
+int MPDAsyncConnection::PopPendingCommand()
+{
+	int cmdTag;
+
+	if (this->pendingCmdCnt==0)
+		return -1;
+
+	cmdTag=this->pendingCmds[this->pendingCmdHead].cmdTag;
+	this->pendingCmdHead=(this->pendingCmdHead+1)%MPD_MAX_PENDING_COMMANDS;
+	this->pendingCmdCnt--;
+
+	return cmdTag;
+}
+
+int MPDAsyncConnection::GetCurrentCommand()
+{
+	if (this->pendingCmdCnt==0)
+		return -1;
+
+	return this->pendingCmds[this->pendingCmdHead].cmdTag;
+}
+
+MPDAsyncConnection::State MPDAsyncConnection::GetState()
+{
+	return this->state;
+}
+
+bool MPDAsyncConnection::IsConnected()
+{
+	return this->state==CONNECTED;
+}
+
+bool MPDAsyncConnection::IsCommandPending(int cmdTag)
+{
+	for (unsigned int a=0; a<this->pendingCmdCnt; a++)
+		if (this->pendingCmds[(this->pendingCmdHead+a)%MPD_MAX_PENDING_COMMANDS].cmdTag==cmdTag)
+			return true;
+
+	return false;
+}
+
+unsigned int MPDAsyncConnection::GetPendingCommandCount()
+{
+	return this->pendingCmdCnt;
+}
@@ -0,0 +1,172 @@
+/*
+ * MPDAsyncConnection.h
+ *
+ *  Created on: 17.10.2026
+ *      Author: joe
+ */
+
+#ifndef SRC_AUDIOSOURCES_MPDASYNCCONNECTION_H_
+#define SRC_AUDIOSOURCES_MPDASYNCCONNECTION_H_
+
+#include <mpd/async.h>
+#include <mpd/parser.h>
+
+#include <glib.h>
+#include <gio/gio.h>
+
+namespace retroradio_controller
+{
+
+#define MPD_MAX_PENDING_COMMANDS	32
+
+//Non blocking connection to the mpd daemon. The socket is registered in the glib main loop, commands are
+//pipelined and answered via the listener interface in the order they have been sent.
+class MPDAsyncConnection
+{
+public:
+	enum State
+	{
+		DISCONNECTED,
+		CONNECTING,
+		WAITING_FOR_GREETING,
+		CONNECTED
+	};
+
+	class IMPDConnectionListener
+	{
+	public:
+		virtual void OnMPDConnected(MPDAsyncConnection *con)=0;
+
+		//called when a connect attempt failed or an established connection broke down
+		virtual void OnMPDConnectionLost(MPDAsyncConnection *con)=0;
+
+		//called for each name/value pair of the answer to the command identified by cmdTag
+		virtual void OnMPDResponsePair(MPDAsyncConnection *con, int cmdTag, const char *name, const char *value)=0;
+
+		//called when mpd answered the command identified by cmdTag with OK (success) or ACK (failure)
+		virtual void OnMPDCommandFinished(MPDAsyncConnection *con, int cmdTag, bool success, const char *errorMsg)=0;
+	};
+
+private:
+	struct PendingCommand
+	{
+		int cmdTag;
+		bool inCommandList;
+	};
+
+	IMPDConnectionListener *listener;
+
+	State state;
+
+	int socketFd;
+
+	bool isUnixSocket;
+
+	struct mpd_async *async;
+
+	struct mpd_parser *parser;
+
+	guint fdEventId;
+
+	GIOCondition fdEventCondition;
+
+	guint connectTimerId;
+
+	//pending lookup of a host name, cancelled when the connection is closed
+	GCancellable *resolveCancellable;
+
+	unsigned int resolvePort;
+
+	//incremented each time the connection is closed. Used to detect that a listener
+	//callback closed the connection while we are still processing received lines.
+	unsigned int connectionGeneration;
+
+	PendingCommand pendingCmds[MPD_MAX_PENDING_COMMANDS];
+
+	unsigned int pendingCmdHead;
+
+	unsigned int pendingCmdCnt;
+
+	bool parkInIdle;
+
+	bool commandListActive;
+
+	static gboolean OnSocketEvent(gint fd, GIOCondition condition, gpointer user_data);
+
+	static gboolean OnConnectTimeout(gpointer user_data);
+
+	void ProcessSocketEvent(GIOCondition condition);
+
+	bool CancelParking();
+
+	void FailCommandList(const char *errorMsg);
+
+	static void OnHostResolved(GObject *source, GAsyncResult *result, gpointer user_data);
+
+	int CreateTcpSocket(GInetAddress *address, unsigned int port);
+
+	int CreateUnixSocket(const char *path);
+
+	bool FinishConnect();
+
+	void ReceiveLines();
+
+	bool ProcessLine(char *line);
+
+	void UpdateFdWatch();
+
+	void WatchFd(GIOCondition condition);
+
+	void ParkIfIdle();
+
+	void PushPendingCommand(int cmdTag, bool inCommandList);
+
+	int PopPendingCommand();
+
+	int GetCurrentCommand();
+
+	void CloseConnection();
+
+	void ConnectionLost(const char *reason);
+
+public:
+	MPDAsyncConnection(IMPDConnectionListener *listener);
+
+	virtual ~MPDAsyncConnection();
+
+	//host starting with '/' is taken as path of mpd's unix domain socket, the port is ignored then.
+	//Host names are resolved asynchronously, the timeout includes the lookup.
+	bool Connect(const char *host, unsigned int port, unsigned int timeoutMs);
+
+	void Disconnect();
+
+	//closes the connection like a broken down one. Pending commands are finished with an error.
+	void Abort(const char *reason);
+
+	//keeps an unused connection in mpd's idle mode while no command is pending. Mpd does not close idling
+	//connections after its connection_timeout, so no keep alive polling is needed.
+	void SetParkInIdle(bool park);
+
+	//sends a command with a NULL terminated list of string arguments. The command is answered
+	//asynchronously via the listener using the given cmdTag.
+	bool SendCommand(int cmdTag, const char *command, ...);
+
+	//commands sent between BeginCommandList and EndCommandList are transmitted as one command_list_ok_begin
+	//batch. Each of them is finished individually. Commands after a failing one are finished with an error
+	//since mpd skips them.
+	bool BeginCommandList();
+
+	bool EndCommandList();
+
+	State GetState();
+
+	bool IsConnected();
+
+	bool IsCommandPending(int cmdTag);
+
+	unsigned int GetPendingCommandCount();
+};
+
+} /* namespace retroradio_controller */
+
+#endif /* SRC_AUDIOSOURCES_MPDASYNCCONNECTION_H_ */
@@ -7,22 +7,24 @@
 
 #include "MPDAudioSource.h"
 
-#include <cpp-app-utils/Logger.h>
+#include "Logging.h"
+#include "TimerWheel.h"
 #include "RetroradioController.h"
+#include "LatencyTracer.h"
 
 #include <glib-unix.h>
+#include <stdio.h>
 #include <mpd/status.h>
-#include <mpd/playlist.h>
-#include <mpd/player.h>
-#include <mpd/queue.h>
 
 using namespace CppAppUtils;
 
 using namespace retroradio_controller;
 
-#define MPD_CONNECT_TIMEOUT_MS 			1000
-#define MPD_CONNECT_RETRY_INTERVAL_MS	1000
-#define MPD_ALIVE_WATCHDOG_TIMEOUT_MS	5000
+#define MPD_CONNECT_TIMEOUT_MS 				1000
+#define MPD_CONNECT_RETRY_MIN_INTERVAL_MS	100
+#define MPD_CONNECT_RETRY_MAX_INTERVAL_MS	5000
+//the startup probe connection is closed if the source is not activated within this time
+#define MPD_PROBE_IDLE_TIMEOUT_MS			30000
 
 #define MPC_CONFIG_GROUP 				"MPD Source"
 #define MPC_DEFAULT_ALSA_MIXER_NAME		"mpc_vol"
@@ -34,30 +36,78 @@ using namespace retroradio_controller;
 #define MPD_CONFIG_TAG_PORT						"MpdPort"
 #define MPD_DEFAULT_RADIO_STATION_PLAYLIST		"radio"
 #define MPD_CONFIG_TAG_PLAYLIST					"RadioStationPlaylist"
+#define MPD_DEFAULT_AUDIO_START_TIMEOUT_MS		3000
+#define MPD_CONFIG_TAG_AUDIO_START_TIMEOUT		"AudioStartTimeout"
+#define MPD_CONFIG_TAG_STANDBY_HOST				"StandbyMpdHost"
+#define MPD_DEFAULT_STANDBY_PORT				6601
+#define MPD_CONFIG_TAG_STANDBY_PORT				"StandbyMpdPort"
+#define MPD_DEFAULT_STANDBY_ALSA_MIXER_NAME		"mpc2_vol"
+#define MPD_CONFIG_TAG_STANDBY_ALSA_MIXER		"StandbyAlsaMixerName"
+
+//interval mpd's state is polled while waiting for audio after a track change
+#define MPD_AUDIO_POLL_INTERVAL_MS		50
 
 //TODO: adapt to be a bit more robust when connection is lost
 
 MPDAudioSource::MPDAudioSource(const char *srcName, AbstractAudioSource *predecessor,
 		IAudioSourceStateListener *srcListener) :
 		AbstractAudioSource(srcName, predecessor, srcListener),
-		mpdCon(NULL),
-		pollSourceId(0),
-		mpdWatchdogTimerId(0),
-		trackNr(0),
-		queueLength(0),
 		mpdHost(NULL),
 		mpdPort(MPD_DEFAULT_PORT),
-		mpdStationPlayList(NULL)
+		mpdStationPlayList(NULL),
+		audioStartTimeoutMs(MPD_DEFAULT_AUDIO_START_TIMEOUT_MS),
+		standbyMpdHost(NULL),
+		standbyMpdPort(MPD_DEFAULT_STANDBY_PORT),
+		standbyAlsaMixerName(NULL),
+		standbyDeck(NULL),
+		standbyBridgeActive(false),
+		preRollForward(true),
+		pendingStatus(NULL),
+		statusRefreshNeeded(false),
+		queueCacheRefreshNeeded(false),
+		trackNr(0),
+		queueLength(0),
+		repeatEnabled(true),
+		trackChangeTarget(_NO_TRACK_SET_),
+		trackChangePlayTime(0),
+		audioStatus(NULL),
+		audioPollTimerId(0),
+		pollSourceId(0),
+		waitingForStartup(false),
+		startupProbed(false),
+		probeIdleTimerId(0),
+		retryIntervalMs(MPD_CONNECT_RETRY_MIN_INTERVAL_MS),
+		playListLoaded(false),
+		playListFound(false),
+		queueVersion(0),
+		activationStartTime(0)
 {
-
+	this->mpdCon=new MPDAsyncConnection(this);
+	this->mpdCon->SetParkInIdle(true);
+	this->mpdIdleCon=new MPDAsyncConnection(this);
+	this->playListLastModified[0]='\0';
 }
 
 MPDAudioSource::~MPDAudioSource()
 {
+	delete this->mpdIdleCon;
+	delete this->mpdCon;
+	this->StopAudioPolling();
+	this->StopProbeIdleTimer();
+	if (this->pendingStatus!=NULL)
+		mpd_status_free(this->pendingStatus);
+	if (this->audioStatus!=NULL)
+		mpd_status_free(this->audioStatus);
 	if (this->mpdHost!=NULL)
 		free(this->mpdHost);
 	if (this->mpdStationPlayList!=NULL)
 		free(this->mpdStationPlayList);
+	if (this->standbyDeck!=NULL)
+		delete this->standbyDeck;
+	if (this->standbyMpdHost!=NULL)
+		free(this->standbyMpdHost);
+	if (this->standbyAlsaMixerName!=NULL)
+		free(this->standbyAlsaMixerName);
 }
 
 bool MPDAudioSource::Init()
@@ -68,80 +118,191 @@ bool MPDAudioSource::Init()
 	this->trackChangeTransition.Reset();
 	this->trackNr=RetroradioController::Instance()->GetPersistentState()->GetMPDCurrentTrackNr();
 
-	Logger::LogDebug("MPDAudioSource::Init - Initializing MPD Audio Source %s.", this->GetName());
+	LOG_DEBUG("MPDAudioSource::Init - Initializing MPD Audio Source %s.", this->GetName());
+
+	if (this->standbyMpdHost!=NULL && this->standbyDeck==NULL)
+	{
+		LOG_DEBUG("MPDAudioSource::Init - Using standby mpd instance at %s for station changes.",
+				this->standbyMpdHost);
+		this->standbyDeck=new MPDStandbyDeck(this);
+		this->standbyDeck->SetPlayList(this->ConfigGetRadioStationPlaylistName());
+	}
 
 	return true;
 }
 
 void MPDAudioSource::DeInit()
 {
+	this->waitingForStartup=false;
+	this->StopPollingMPD();
 	this->DisconnectFromMPD();
-	Logger::LogDebug("MPDAudioSource::DeInit - Uninitiated MPD Audio Source %s.", this->GetName());
+	LOG_DEBUG("MPDAudioSource::DeInit - Uninitiated MPD Audio Source %s.", this->GetName());
 }
 
 bool MPDAudioSource::IsStartupFinished()
 {
-	bool result=true;
-
-	struct mpd_connection *con;
-	Logger::LogDebug("MPDAudioSource::IsStartupFinished - Checking if mpd server is available.");
+	//the probe connection is kept for sending commands after activation until it is idle for too long
+	return this->startupProbed || this->mpdCon->IsConnected();
+}
 
-	con=mpd_connection_new(this->ConfigGetMPDHost(), this->ConfigGetMPDPort(), MPD_CONNECT_TIMEOUT_MS);
-	if (mpd_connection_get_error(con)!=MPD_ERROR_SUCCESS)
+void MPDAudioSource::WaitForStartup()
+{
+	if (this->startupProbed || this->mpdCon->IsConnected())
 	{
-		Logger::LogDebug("MPDAudioSource::ConnectToMPD - MPD daemon not yet available");
-		result=false;
+		this->SourceStartupFinished();
+		return;
 	}
-	else
+
+	this->waitingForStartup=true;
+	this->ProbeMPD();
+}
+
+void MPDAudioSource::ProbeMPD()
+{
+	LOG_DEBUG("MPDAudioSource::ProbeMPD - Checking if mpd server is available.");
+	if (this->mpdCon->GetState()==MPDAsyncConnection::DISCONNECTED &&
+			!this->mpdCon->Connect(this->ConfigGetMPDHost(), this->ConfigGetMPDPort(), MPD_CONNECT_TIMEOUT_MS))
 	{
-		struct mpd_status *statusResult;
-		statusResult=mpd_run_status(con);
-		if (statusResult==NULL)
-		{
-			Logger::LogDebug("MPDAudioSource::ConnectToMPD - MPD daemon does not answer properly a status request.");
-			result=false;
-		}
-		else
-		{
-			mpd_status_free(statusResult);
-		}
+		LOG_DEBUG("MPDAudioSource::ProbeMPD - MPD daemon not yet available");
+		this->StartPollingMPD();
 	}
+}
 
-	mpd_connection_free(con);
-	return result;
+void MPDAudioSource::StartProbeIdleTimer()
+{
+	if (this->probeIdleTimerId!=0)
+		return;
+
+	this->probeIdleTimerId=TimerWheel::Instance()->Add(MPD_PROBE_IDLE_TIMEOUT_MS, TimerWheel::TIMER_SLACK_LAZY,
+			MPDAudioSource::OnProbeIdleTimerElapsed, this);
+}
+
+void MPDAudioSource::StopProbeIdleTimer()
+{
+	if (this->probeIdleTimerId==0)
+		return;
+
+	TimerWheel::Instance()->Remove(this->probeIdleTimerId);
+	this->probeIdleTimerId=0;
 }
 
+gboolean MPDAudioSource::OnProbeIdleTimerElapsed(gpointer data)
+{
+	MPDAudioSource *instance=(MPDAudioSource *)data;
+
+	instance->probeIdleTimerId=0;
+
+	//source activated in the meanwhile -> the connection is in use
+	if (instance->GetState()!=DEACTIVATED)
+		return FALSE;
+
+	LOG_DEBUG("MPDAudioSource::OnProbeIdleTimerElapsed - Source not activated. Closing probe connection.");
+	instance->mpdCon->Disconnect();
+
+	return FALSE;
+}
 
 void MPDAudioSource::DoActivateSource(bool need2ReOpenSoundDevices)
 {
-	Logger::LogDebug("MPDAudioSource::DoActivateSource - About to activate source.");
-	if (this->ConnectToMPD())
-		this->SourceActivationFinished();
-	else
+	LOG_DEBUG("MPDAudioSource::DoActivateSource - About to activate source.");
+	this->StopProbeIdleTimer();
+	this->activationStartTime=g_get_monotonic_time();
+	this->playListLoaded=false;
+	this->standbyBridgeActive=false;
+	if (this->standbyDeck!=NULL && need2ReOpenSoundDevices)
+		this->standbyDeck->InitMixer(this->ConfigGetSoundCardName(), this->ConfigGetStandbyAlsaMixerName());
+	this->ConnectToMPD();
+
+	//connection of the startup probe still established -> no need to wait for connecting
+	if (this->mpdCon->IsConnected())
+		this->RequestQueueState();
+}
+
+void MPDAudioSource::ConnectToMPD()
+{
+	LOG_DEBUG("MPDAudioSource::ConnectToMPD - Connecting to mpd daemon.");
+	if (this->mpdCon->GetState()==MPDAsyncConnection::DISCONNECTED &&
+			!this->mpdCon->Connect(this->ConfigGetMPDHost(), this->ConfigGetMPDPort(), MPD_CONNECT_TIMEOUT_MS))
+	{
+		LOG_DEBUG("MPDAudioSource::ConnectToMPD - Unable to connect to mpd daemon. Retrying ...");
+		this->StartPollingMPD();
+	}
+
+	if (this->mpdIdleCon->GetState()==MPDAsyncConnection::DISCONNECTED &&
+			!this->mpdIdleCon->Connect(this->ConfigGetMPDHost(), this->ConfigGetMPDPort(), MPD_CONNECT_TIMEOUT_MS))
+	{
+		LOG_DEBUG("MPDAudioSource::ConnectToMPD - Unable to open idle connection to mpd daemon. Retrying ...");
+		this->StartPollingMPD();
+	}
+
+	if (this->standbyDeck!=NULL && this->standbyDeck->GetConnectionState()==MPDAsyncConnection::DISCONNECTED &&
+			!this->standbyDeck->Connect(this->standbyMpdHost, this->standbyMpdPort, MPD_CONNECT_TIMEOUT_MS))
+	{
+		LOG_DEBUG("MPDAudioSource::ConnectToMPD - Unable to connect to standby mpd daemon. Retrying ...");
 		this->StartPollingMPD();
+	}
 }
 
-bool MPDAudioSource::ConnectToMPD()
+void MPDAudioSource::OnMPDConnected(MPDAsyncConnection *con)
 {
-	struct mpd_connection *con;
+	this->retryIntervalMs=MPD_CONNECT_RETRY_MIN_INTERVAL_MS;
 
-	Logger::LogDebug("MPDAudioSource::ConnectToMPD - Connecting to mpd daemon.");
-	con=mpd_connection_new(this->ConfigGetMPDHost(), this->ConfigGetMPDPort(), MPD_CONNECT_TIMEOUT_MS);
-	if (mpd_connection_get_error(con)!=MPD_ERROR_SUCCESS)
+	if (con==this->mpdIdleCon)
 	{
-		Logger::LogDebug("MPDAudioSource::ConnectToMPD - Unable to connect to mpd daemon. Retrying ...");
-		Logger::LogDebug("MPDAudioSource::ConnectToMPD - Error: %s",  mpd_connection_get_error_message(con));
-		mpd_connection_free(con);
-		return false;
+		LOG_DEBUG("MPDAudioSource::OnMPDConnected - Idle connection to mpd daemon established.");
+		this->statusRefreshNeeded=true;
+		this->queueCacheRefreshNeeded=true;
+		this->WaitForMPDChanges();
+		return;
 	}
 
-	mpd_connection_set_keepalive(con,true);
-	this->mpdCon=con;
-	Logger::LogDebug("MPDAudioSource::ConnectToMPD - Connected to mpd daemon.");
+	LOG_DEBUG("MPDAudioSource::OnMPDConnected - Connected to mpd daemon.");
 
-	this->ArmMPDAliveWatchdog();
+	if (this->waitingForStartup)
+	{
+		this->waitingForStartup=false;
+		this->startupProbed=true;
+		if (this->GetState()==DEACTIVATED)
+			this->StartProbeIdleTimer();
+		this->SourceStartupFinished();
+	}
 
-	return true;
+	//playlist is loaded within the same command list as the first play command if the queue is outdated
+	if (this->GetState()==ACTIVATING)
+		this->RequestQueueState();
+}
+
+void MPDAudioSource::OnMPDConnectionLost(MPDAsyncConnection *con)
+{
+	LOG_DEBUG("MPDAudioSource::OnMPDConnectionLost - Unable to connect to mpd daemon or connection lost. Retrying ...");
+
+	if (con==this->mpdIdleCon)
+	{
+		if (this->pendingStatus!=NULL)
+		{
+			mpd_status_free(this->pendingStatus);
+			this->pendingStatus=NULL;
+		}
+
+		//changes of the queue are not reported while disconnected
+		this->queueCache.FinishUpdate(false);
+		this->queueCache.Invalidate();
+	}
+
+	if ((this->GetState()==DEACTIVATED || this->GetState()==DEACTIVATING) && !this->waitingForStartup)
+		return;
+
+	this->StartPollingMPD();
+}
+
+void MPDAudioSource::OnStandbyDeckConnectionLost(MPDStandbyDeck *deck)
+{
+	this->standbyBridgeActive=false;
+
+	if (this->GetState()==DEACTIVATED || this->GetState()==DEACTIVATING)
+		return;
+
+	this->StartPollingMPD();
 }
 
 void MPDAudioSource::StartPollingMPD()
@@ -150,26 +311,32 @@ void MPDAudioSource::StartPollingMPD()
 	if (this->pollSourceId!=0)
 		return;
 
-	this->pollSourceId=g_timeout_add(MPD_CONNECT_RETRY_INTERVAL_MS, MPDAudioSource::RetryConnect, this);
+	LOG_DEBUG("MPDAudioSource::StartPollingMPD - Next connect attempt in %u ms.", this->retryIntervalMs);
+	this->pollSourceId=TimerWheel::Instance()->Add(this->retryIntervalMs, TimerWheel::TIMER_SLACK_LAZY,
+			MPDAudioSource::RetryConnect, this);
+
+	//exponential backoff while the daemon is not available
+	this->retryIntervalMs*=2;
+	if (this->retryIntervalMs>MPD_CONNECT_RETRY_MAX_INTERVAL_MS)
+		this->retryIntervalMs=MPD_CONNECT_RETRY_MAX_INTERVAL_MS;
 }
 
 void MPDAudioSource::StopPollingMPD()
 {
 	if (this->pollSourceId==0)
 		return;
-	Logger::LogDebug("MPDAudioSource::StopPollingMPD - Stop polling for connecting to the MPD daemon.");
+	LOG_DEBUG("MPDAudioSource::StopPollingMPD - Stop polling for connecting to the MPD daemon.");
 
-	g_source_remove(this->pollSourceId);
+	TimerWheel::Instance()->Remove(this->pollSourceId);
 	this->pollSourceId=0;
 }
 
 void MPDAudioSource::DoDeActivateSource()
 {
-	Logger::LogDebug("MPDAudioSource::DoDeActivateSource - About to deactivate source.");
-	if (this->mpdCon==NULL)
-		this->StopPollingMPD();
-	else
-		this->DisconnectFromMPD();
+	LOG_DEBUG("MPDAudioSource::DoDeActivateSource - About to deactivate source.");
+	this->StopPollingMPD();
+	this->StopAudioPolling();
+	this->DisconnectFromMPD();
 	this->SourceDeActivationFinished();
 }
 
@@ -177,167 +344,253 @@ gboolean MPDAudioSource::RetryConnect(gpointer data)
 {
 	MPDAudioSource *instance=(MPDAudioSource *)data;
 
-	//state change in the meanwhile -> stop timer
-	if (instance->GetState()==DEACTIVATED || instance->GetState()==DEACTIVATING)
+	// timer itsself is disabled by returning FALSE here. The connection attempt runs asynchronously
+	// and restarts the timer in case it fails again.
+	instance->pollSourceId=0;
+
+	if (instance->waitingForStartup)
 	{
-		instance->StopPollingMPD();
+		instance->ProbeMPD();
 		return FALSE;
 	}
 
-	if (instance->ConnectToMPD())
-	{
-		if (instance->GetState()==ACTIVATING)
-			instance->SourceActivationFinished();
-		instance->StopPollingMPD();
+	//state change in the meanwhile -> stop retrying
+	if (instance->GetState()==DEACTIVATED || instance->GetState()==DEACTIVATING)
 		return FALSE;
-	}
 
-	return TRUE;
+	instance->ConnectToMPD();
+
+	return FALSE;
 }
 
 void MPDAudioSource::DisconnectFromMPD()
 {
-	if (this->mpdCon==NULL)
-		return;
-	Logger::LogDebug("MPDAudioSource::DisconnectFromMPD - Disconnecting from MPD daemon.");
+	LOG_DEBUG("MPDAudioSource::DisconnectFromMPD - Disconnecting from MPD daemon.");
+	this->StopProbeIdleTimer();
 
-	this->DisarmMPDAliveWatchdog();
-	mpd_connection_free(this->mpdCon);
-	this->mpdCon=NULL;
+	this->mpdCon->Disconnect();
+	this->mpdIdleCon->Disconnect();
+	if (this->standbyDeck!=NULL)
+		this->standbyDeck->Disconnect();
+	this->standbyBridgeActive=false;
+
+	if (this->pendingStatus!=NULL)
+	{
+		mpd_status_free(this->pendingStatus);
+		this->pendingStatus=NULL;
+	}
 }
 
-void MPDAudioSource::ArmMPDAliveWatchdog()
+void MPDAudioSource::WaitForMPDChanges()
 {
-	Logger::LogDebug("MPDAudioSource::ArmMPDAliveWatchdog - Starting mpd connection watchdog.");
-	//mpdWatchdogTimerId != 0 -> already polling
-	if (this->mpdWatchdogTimerId!=0)
-		return;
+	//connection liveness is detected by the socket itsself (tcp keep alive, hang up or error on the fd)
+	if (this->statusRefreshNeeded)
+	{
+		this->statusRefreshNeeded=false;
+		this->mpdIdleCon->SendCommand(CMD_TAG_IDLE_STATUS, "status", NULL);
+	}
+
+	if (this->queueCacheRefreshNeeded)
+	{
+		this->queueCacheRefreshNeeded=false;
+		this->queueCache.BeginUpdate();
+		this->mpdIdleCon->SendCommand(CMD_TAG_IDLE_PLAYLISTINFO, "playlistinfo", NULL);
+	}
 
-	this->mpdWatchdogTimerId=g_timeout_add(MPD_ALIVE_WATCHDOG_TIMEOUT_MS, MPDAudioSource::MPDConnectionWatchdog, this);
+	this->mpdIdleCon->SendCommand(CMD_TAG_IDLE, "idle", "player", "playlist", "mixer", NULL);
 }
 
-void MPDAudioSource::DisarmMPDAliveWatchdog()
+void MPDAudioSource::ProcessIdleResponsePair(const char *name, const char *value)
 {
-	if (this->mpdWatchdogTimerId==0) return;
-	Logger::LogDebug("MPDAudioSource::DisarmMPDAliveWatchdog - Stopping mpd connection watchdog.");
+	if (strcmp(name, "changed")!=0)
+		return;
 
-	g_source_remove(this->mpdWatchdogTimerId);
-	this->mpdWatchdogTimerId=0;
+	LOG_DEBUG("MPDAudioSource::ProcessIdleResponsePair - MPD reports changed subsystem: %s", value);
+	if (strcmp(value, "player")==0 || strcmp(value, "playlist")==0)
+		this->statusRefreshNeeded=true;
+
+	if (strcmp(value, "playlist")==0)
+	{
+		this->queueCache.Invalidate();
+		this->queueCacheRefreshNeeded=true;
+	}
 }
 
-void MPDAudioSource::CheckMPDAliveAndReadTrackPos()
+void MPDAudioSource::ProcessStatusResponse()
 {
-	struct mpd_status *statusResult;
-
-	Logger::LogDebug("MPDAudioSource::CheckMPDAlive - Checking connection to mpd daemon.");
+	int lTrackNr;
 
-	if (this->mpdCon==NULL)
-	{
-		Logger::LogDebug("MPDAudioSource::CheckMPDAlive - Seems we have a state machine error, mpd connection object already null. Disarming watchdog.");
-		this->DisarmMPDAliveWatchdog();
+	if (this->pendingStatus==NULL)
 		return;
-	}
 
-	statusResult=mpd_run_status(this->mpdCon);
-	if (statusResult!=NULL)
+	lTrackNr=mpd_status_get_song_pos(this->pendingStatus);
+	if (lTrackNr!=-1)
 	{
-		int lTrackNr=mpd_status_get_song_pos(statusResult);
-		Logger::LogDebug("MPDAudioSource::CheckMPDAlive - MPD answers. Everything ok.");
-		if (lTrackNr!=-1)
+		if (this->trackNr!=(unsigned int)lTrackNr)
 		{
-			if (this->trackNr!=lTrackNr)
-			{
-				this->trackNr=lTrackNr;
-				RetroradioController::Instance()->GetPersistentState()->SetMPDCurrentTrackNr(this->trackNr);
-			}
-			Logger::LogDebug("MPDAudioSource::CheckMPDAlive - Currently playing track: %d", this->trackNr);
+			this->trackNr=lTrackNr;
+			RetroradioController::Instance()->GetPersistentState()->SetMPDCurrentTrackNr(this->trackNr);
 		}
-
-		this->queueLength=mpd_status_get_queue_length(statusResult);
-
-		mpd_status_free(statusResult);
-		return;
+		LOG_DEBUG("MPDAudioSource::ProcessStatusResponse - Currently playing track: %d", this->trackNr);
 	}
 
-	//no answer -> disconnect & try reconnect again
-	Logger::LogDebug("MPDAudioSource::CheckMPDAlive - MPD does not answers. Closing connection and try to reopen again.");
-	this->DisarmMPDAliveWatchdog();
-	mpd_connection_free(this->mpdCon);
-	this->mpdCon=NULL;
+	this->queueLength=mpd_status_get_queue_length(this->pendingStatus);
+	this->repeatEnabled=mpd_status_get_repeat(this->pendingStatus);
 
-	if (!this->ConnectToMPD())
-		this->StartPollingMPD();
+	mpd_status_free(this->pendingStatus);
+	this->pendingStatus=NULL;
 }
 
-gboolean MPDAudioSource::MPDConnectionWatchdog(gpointer data)
+void MPDAudioSource::SendLoadPlayListCommands()
 {
-	MPDAudioSource *instance=(MPDAudioSource *)data;
-
-	instance->CheckMPDAliveAndReadTrackPos();
+	const char *playlist=ConfigGetRadioStationPlaylistName();
+	LOG_DEBUG("MPDAudioSource::SendLoadPlayListCommands - Loading radio station playlist: %s", playlist);
 
-	return TRUE;
+	this->mpdCon->SendCommand(CMD_TAG_CLEAR_QUEUE, "clear", NULL);
+	this->mpdCon->SendCommand(CMD_TAG_LOAD_PLAYLIST, "load", playlist, NULL);
+	this->mpdCon->SendCommand(CMD_TAG_SET_REPEAT, "repeat", "1", NULL);
 }
 
-void MPDAudioSource::LoadPlayList()
+void MPDAudioSource::RequestQueueState()
 {
-	const char *playlist=ConfigGetRadioStationPlaylistName();
-	Logger::LogDebug("MPDAudioSource::LoadPlayListAndTrack - Loading radio station playlist: %s", playlist);
-
-	if (!mpd_run_clear(this->mpdCon))
-		Logger::LogError("Unable to clear queue: %s",  mpd_connection_get_error_message (this->mpdCon));
+	this->playListFound=false;
+	this->playListLastModified[0]='\0';
+
+	//modification time of the stored playlist and the queue version in a single round trip
+	if (!this->mpdCon->BeginCommandList() ||
+			!this->mpdCon->SendCommand(CMD_TAG_LIST_PLAYLISTS, "listplaylists", NULL) ||
+			!this->mpdCon->SendCommand(CMD_TAG_QUEUE_STATUS, "status", NULL) ||
+			!this->mpdCon->EndCommandList())
+	{
+		//connection broke down -> state is requested again after reconnecting
+		if (this->mpdCon->IsConnected())
+			this->OnQueueStateReceived(false);
+	}
+}
 
-	if (!mpd_run_load(this->mpdCon,playlist))
+void MPDAudioSource::ProcessListPlaylistsPair(const char *name, const char *value)
+{
+	//each playlist entry starts with its name followed by its attributes
+	if (strcmp(name, "playlist")==0)
 	{
-		Logger::LogError("Unable to load playlist: %s",  mpd_connection_get_error_message (this->mpdCon));
+		this->playListFound=strcmp(value, this->ConfigGetRadioStationPlaylistName())==0;
 		return;
 	}
 
-	if (!mpd_run_repeat(this->mpdCon,true))
+	if (this->playListFound && strcmp(name, "Last-Modified")==0)
 	{
-		Logger::LogError("Unable to set player into repeat mode: %s",  mpd_connection_get_error_message (this->mpdCon));
+		strncpy(this->playListLastModified, value, sizeof(this->playListLastModified)-1);
+		this->playListLastModified[sizeof(this->playListLastModified)-1]='\0';
+		this->playListFound=false;
+	}
+}
+
+void MPDAudioSource::ProcessQueueStatusPair(const char *name, const char *value)
+{
+	if (strcmp(name, "playlist")==0)
+		this->queueVersion=strtoul(value, NULL, 10);
+	else if (strcmp(name, "playlistlength")==0)
+		this->queueLength=strtoul(value, NULL, 10);
+	else if (strcmp(name, "repeat")==0)
+		this->repeatEnabled=strcmp(value, "1")==0;
+}
+
+void MPDAudioSource::OnQueueStateReceived(bool success)
+{
+	RetroradioPersistentState *persState=RetroradioController::Instance()->GetPersistentState();
+
+	if (this->GetState()==ACTIVATING)
+	{
+		this->playListLoaded=success && this->IsQueueCurrent();
+		if (this->playListLoaded)
+			LOG_DEBUG("MPDAudioSource::OnQueueStateReceived - MPD queue is current. Skip reloading playlist.");
+		AbstractAudioSource::SourceActivationFinished();
 		return;
 	}
+
+	//status requested after loading the playlist -> remember what is in the queue now
+	if (success && this->playListLoaded)
+		persState->SetMPDQueueFingerprint(this->ConfigGetRadioStationPlaylistName(), this->playListLastModified,
+				this->queueVersion, this->queueLength);
+}
+
+bool MPDAudioSource::IsQueueCurrent()
+{
+	//playlist not stored in mpd -> nothing to compare the queue with
+	if (this->playListLastModified[0]=='\0')
+		return false;
+
+	return RetroradioController::Instance()->GetPersistentState()->IsMPDQueueFingerprintEqual(
+			this->ConfigGetRadioStationPlaylistName(), this->playListLastModified, this->queueVersion, this->queueLength);
 }
 
 void MPDAudioSource::DoStartPlaying()
 {
+	char trackStr[16];
+	bool result;
+
 	this->trackNr=RetroradioController::Instance()->GetPersistentState()->GetMPDCurrentTrackNr();
-	if (this->mpdCon==NULL)
+	if (!this->mpdCon->IsConnected())
 	{
-		Logger::LogError("MPD sources assumed to be in state START_PLAYING but mpd connection object found to be NULL.");
+		LOG_ERROR("MPD sources assumed to be in state START_PLAYING but mpd connection not established.");
 		return;
 	}
 
-	Logger::LogDebug("MPDAudioSource::DoStartPlaying - Start playing track %d", trackNr);
+	LOG_DEBUG("MPDAudioSource::DoStartPlaying - Start playing track %d", trackNr);
+
+	snprintf(trackStr, sizeof(trackStr), "%u", this->trackNr);
+	if (this->playListLoaded)
+	{
+		result=this->mpdCon->SendCommand(CMD_TAG_START_PLAYING, "play", trackStr, NULL);
+	}
+	else
+	{
+		//clear, load, repeat and play are sent as one command list -> a single round trip to mpd.
+		//The final status is used to fingerprint the new queue.
+		result=this->mpdCon->BeginCommandList();
+		if (result)
+		{
+			RetroradioController::Instance()->GetPersistentState()->ResetMPDQueueFingerprint();
+			this->SendLoadPlayListCommands();
+			this->mpdCon->SendCommand(CMD_TAG_START_PLAYING, "play", trackStr, NULL);
+			this->mpdCon->SendCommand(CMD_TAG_QUEUE_STATUS, "status", NULL);
+			result=this->mpdCon->EndCommandList();
+		}
+	}
 
-	mpd_run_play_pos(this->mpdCon, this->trackNr);
-	this->SourceStartPlayingFinished();
+	if (!result)
+		this->SourceStartPlayingFinished();
 }
 
 void MPDAudioSource::DoStopPlaying()
 {
-	Logger::LogDebug("MPDAudioSource::DoStopPlaying - About to stop source %s.", this->GetName());
-	if (this->mpdCon==NULL)
+	LOG_DEBUG("MPDAudioSource::DoStopPlaying - About to stop source %s.", this->GetName());
+	if (!this->mpdCon->IsConnected())
 	{
-		Logger::LogError("MPD sources assumed to be in state STOP_PLAYING but mpd connection object found to be NULL.");
+		LOG_ERROR("MPD sources assumed to be in state STOP_PLAYING but mpd connection not established.");
 		return;
 	}
 
-	Logger::LogDebug("MPDAudioSource::DoStopPlaying - Checking for pending track change commands.");
+	LOG_DEBUG("MPDAudioSource::DoStopPlaying - Checking for pending track change commands.");
 	if (this->trackChangeTransition.GetState()==TrackChangeTransition::RAMPING_DOWN)
 	{
 		this->ProcessPendingTrackChangeCommands();
 		this->trackChangeTransition.Finished();
 	}
+	this->StopAudioPolling();
+
+	if (this->standbyDeck!=NULL)
+		this->standbyDeck->Stop();
+	this->standbyBridgeActive=false;
 
-	Logger::LogDebug("MPDAudioSource::DoStopPlaying - Stop playing track %d", this->PersGetTrackNumber());
-	mpd_run_stop(this->mpdCon);
-	this->SourceStopPlayingFinished();
+	LOG_DEBUG("MPDAudioSource::DoStopPlaying - Stop playing track %d", this->PersGetTrackNumber());
+	if (!this->mpdCon->SendCommand(CMD_TAG_STOP_PLAYING, "stop", NULL))
+		this->SourceStopPlayingFinished();
 }
 
 void MPDAudioSource::Next()
 {
-	Logger::LogDebug("MPDAudioSource::Next - MPD source received next command.");
+	LOG_DEBUG("MPDAudioSource::Next - MPD source received next command.");
 	if (this->GetState()==PLAYING)
 	{
 		switch(this->trackChangeTransition.GetState())
@@ -348,20 +601,16 @@ void MPDAudioSource::Next()
 			//No break by intention: Need to set first next call as well after kicking off the ramp
 		case TrackChangeTransition::RAMPING_DOWN:
 			this->trackChangeTransition.NextPressed();
+			this->preRollForward=true;
+			this->UpdateStandbyBridge();
 			break;
 		}
 	}
 }
 
-void MPDAudioSource::SourceActivationFinished()
-{
-	this->LoadPlayList();
-	AbstractAudioSource::SourceActivationFinished();
-}
-
 void MPDAudioSource::Previous()
 {
-	Logger::LogDebug("MPDAudioSource::Previous - MPD source received Previous command.");
+	LOG_DEBUG("MPDAudioSource::Previous - MPD source received Previous command.");
 	if (this->GetState()==PLAYING)
 	{
 		switch(this->trackChangeTransition.GetState())
@@ -372,6 +621,8 @@ void MPDAudioSource::Previous()
 			//No break by intention: Need to set first next call as well after kicking off the ramp
 		case TrackChangeTransition::RAMPING_DOWN:
 			this->trackChangeTransition.PreviousPressed();
+			this->preRollForward=false;
+			this->UpdateStandbyBridge();
 			break;
 		}
 	}
@@ -379,20 +630,21 @@ void MPDAudioSource::Previous()
 
 void MPDAudioSource::Favorite(FavoriteT favorite)
 {
-	Logger::LogDebug("MPDAudioSource::Previous - MPD source received favorite command. Fav: %d", favorite);
+	LOG_DEBUG("MPDAudioSource::Previous - MPD source received favorite command. Fav: %d", favorite);
 	if (this->GetState()==PLAYING)
 	{
-
-		this->CheckMPDAliveAndReadTrackPos();
-		if (favorite<0 || favorite>this->queueLength-1)
+		//queue is cached by the idle connection. No need to ask mpd here.
+		if (this->queueCache.IsValid() ? !this->queueCache.IsPositionValid(favorite) :
+				(favorite<0 || favorite>(int)this->queueLength-1))
 		{
-			Logger::LogInfo("Ignoring favorite %d since it is out of mpd queue range (0-%d).", favorite, this->queueLength-1);
+			LOG_INFO("Ignoring favorite %d since it is out of mpd queue range (0-%d).", favorite,
+					(this->queueCache.IsValid() ? (int)this->queueCache.GetLength() : (int)this->queueLength)-1);
 			return;
 		}
 
 		if (favorite==this->trackNr)
 		{
-			Logger::LogInfo("Ignoring favorite %d since it is currently played.", favorite);
+			LOG_INFO("Ignoring favorite %d since it is currently played.", favorite);
 			return;
 		}
 
@@ -404,6 +656,7 @@ void MPDAudioSource::Favorite(FavoriteT favorite)
 			//No break by intention: Need to set first next call as well after kicking off the ramp
 		case TrackChangeTransition::RAMPING_DOWN:
 			this->trackChangeTransition.TrackSelected((unsigned int)favorite);
+			this->UpdateStandbyBridge();
 			break;
 		}
 	}
@@ -411,41 +664,141 @@ void MPDAudioSource::Favorite(FavoriteT favorite)
 
 void MPDAudioSource::ProcessPendingTrackChangeCommands()
 {
-	this->ProcessPendingSelectTrackCommand();
-	this->ProcessPendingNextPrevCommands();
+	char trackStr[16];
+	int trackNo;
+
+	//all key presses of a burst are resolved to one absolute position -> a single play command
+	trackNo=this->trackChangeTransition.ResolveTargetTrack(this->trackNr, this->queueLength, this->repeatEnabled);
+	if (this->mpdCon->IsConnected() && trackNo!=_NO_TRACK_SET_ && trackNo!=(int)this->trackNr)
+	{
+		snprintf(trackStr, sizeof(trackStr), "%d", trackNo);
+		if (this->mpdCon->SendCommand(CMD_TAG_TRACK_CHANGE, "play", trackStr, NULL))
+		{
+			this->trackChangeTarget=trackNo;
+			this->trackChangePlayTime=g_get_monotonic_time();
+			LOG_DEBUG("MPDAudioSource::ProcessPendingTrackChangeCommands - MPD source changes to track %d.", trackNo);
+		}
+	}
+
+	//the transition goes on when mpd answered the track change command
+	if (!this->mpdCon->IsCommandPending(CMD_TAG_TRACK_CHANGE))
+		this->OnTrackChangeCommandsProcessed();
 }
 
-void MPDAudioSource::ProcessPendingSelectTrackCommand()
+void MPDAudioSource::OnTrackChangeCommandsProcessed()
 {
-	int trackNo=this->trackChangeTransition.GetSelectedTrack(true);
-	if (this->mpdCon==NULL || trackNo==_NO_TRACK_SET_)
+	if (this->GetState()!=PLAYING || this->trackChangeTransition.GetState()!=TrackChangeTransition::RAMPING_DOWN)
 		return;
 
-	mpd_run_play_pos(this->mpdCon, trackNo);
- 	Logger::LogDebug("MPDAudioSource::ProcessPendingSelectTrackCommand - MPD source changed to track %d.",trackNo);
-	this->CheckMPDAliveAndReadTrackPos();
-	RetroradioController::Instance()->GetPersistentState()->SetMPDCurrentTrackNr(this->trackNr);
+	//further keys pressed while mpd was processing the last track change -> process them as well before ramping up
+	if (this->trackChangeTransition.NextCallsPending() || this->trackChangeTransition.PreviousCallsPending() ||
+			this->trackChangeTransition.TrackSelectionPending())
+	{
+		this->ProcessPendingTrackChangeCommands();
+		return;
+	}
+
+	//new track selected -> keep muted until mpd produces audio, streams need to buffer first
+	if (this->trackChangePlayTime!=0 && this->mpdCon->IsConnected())
+	{
+		if ((g_get_monotonic_time()-this->trackChangePlayTime)/1000<this->ConfigGetAudioStartTimeout())
+		{
+			this->RequestAudioStatus();
+			return;
+		}
+
+		LOG_INFO("MPD source %s did not start playing within %u ms after track change. Ramping up anyway.",
+				this->GetName(), this->ConfigGetAudioStartTimeout());
+	}
+
+	this->FinalizeChangeTrackTransition();
 }
 
-void MPDAudioSource::ProcessPendingNextPrevCommands()
+void MPDAudioSource::RequestAudioStatus()
 {
-	bool changeForward=this->trackChangeTransition.NextCallsPending();
-	while (this->trackChangeTransition.OneChangeProcessed())
+	if (this->audioPollTimerId!=0 || this->mpdCon->IsCommandPending(CMD_TAG_AUDIO_STATUS))
+		return;
+
+	if (!this->mpdCon->SendCommand(CMD_TAG_AUDIO_STATUS, "status", NULL))
 	{
-		if (this->mpdCon==NULL) continue;
-		if (changeForward)
-			mpd_run_next(this->mpdCon);
-		else
-			mpd_run_previous(this->mpdCon);
-		Logger::LogDebug("MPDAudioSource::ProcessPendingNextPrevCommands - MPD source changed to %s track.",
-				changeForward ? "next" : "previous");
+		this->trackChangePlayTime=0;
+		this->FinalizeChangeTrackTransition();
 	}
-	this->CheckMPDAliveAndReadTrackPos();
-	RetroradioController::Instance()->GetPersistentState()->SetMPDCurrentTrackNr(this->trackNr);
+}
+
+void MPDAudioSource::OnAudioStatusReceived(bool success)
+{
+	bool audioStarted=false;
+
+	if (success && this->audioStatus!=NULL)
+		audioStarted=mpd_status_get_state(this->audioStatus)==MPD_STATE_PLAY &&
+				(mpd_status_get_elapsed_ms(this->audioStatus)>0 || mpd_status_get_kbit_rate(this->audioStatus)>0);
+
+	if (this->audioStatus!=NULL)
+	{
+		mpd_status_free(this->audioStatus);
+		this->audioStatus=NULL;
+	}
+
+	if (this->trackChangePlayTime==0)
+		return;
+
+	if (audioStarted)
+	{
+		LOG_INFO("MPD source %s: first audio %lld ms after track change.", this->GetName(),
+				(long long)(g_get_monotonic_time()-this->trackChangePlayTime)/1000);
+		this->trackChangePlayTime=0;
+		this->OnTrackChangeCommandsProcessed();
+		return;
+	}
+
+	//connection broke down -> nothing to wait for anymore
+	if (!this->mpdCon->IsConnected())
+	{
+		this->trackChangePlayTime=0;
+		this->OnTrackChangeCommandsProcessed();
+		return;
+	}
+
+	this->audioPollTimerId=TimerWheel::Instance()->Add(MPD_AUDIO_POLL_INTERVAL_MS, TimerWheel::TIMER_SLACK_NORMAL,
+			MPDAudioSource::OnAudioPollTimerElapsed, this);
+}
+
+gboolean MPDAudioSource::OnAudioPollTimerElapsed(gpointer data)
+{
+	MPDAudioSource *instance=(MPDAudioSource *)data;
+
+	// timer itsself is disabled by returning FALSE here.
+	instance->audioPollTimerId=0;
+
+	//further keys pressed in the meanwhile are processed there as well
+	instance->OnTrackChangeCommandsProcessed();
+
+	return FALSE;
+}
+
+void MPDAudioSource::StopAudioPolling()
+{
+	if (this->audioPollTimerId!=0)
+	{
+		TimerWheel::Instance()->Remove(this->audioPollTimerId);
+		this->audioPollTimerId=0;
+	}
+
+	this->trackChangePlayTime=0;
 }
 
 void MPDAudioSource::FinalizeChangeTrackTransition()
 {
+	this->StopAudioPolling();
+
+	//main instance plays the new track -> cross fade back from the standby deck and let it pre-roll the next one
+	if (this->standbyBridgeActive)
+	{
+		this->standbyBridgeActive=false;
+		this->standbyDeck->FadeOut(SourceMuteRampCtrl::NORMAL);
+	}
+	this->PreRollNeighbourStation();
 	this->trackChangeTransition.Finalize();
 	if (!this->IsMuted())
 		this->StartUnMuteRamp(SourceMuteRampCtrl::NORMAL);
@@ -453,6 +806,48 @@ void MPDAudioSource::FinalizeChangeTrackTransition()
 		this->trackChangeTransition.Finished();
 }
 
+void MPDAudioSource::PreRollNeighbourStation()
+{
+	if (this->standbyDeck==NULL || this->queueLength==0)
+		return;
+
+	//the deck holds one station. Users browse in one direction -> the neighbour in the last direction
+	//is the one most likely selected. The first press against it ramps over silence.
+	if (this->preRollForward)
+		this->standbyDeck->PreRoll((this->trackNr+1)%this->queueLength);
+	else
+		this->standbyDeck->PreRoll((this->trackNr+this->queueLength-1)%this->queueLength);
+}
+
+void MPDAudioSource::UpdateStandbyBridge()
+{
+	int trackNo;
+
+	if (this->standbyDeck==NULL)
+		return;
+
+	trackNo=this->trackChangeTransition.PeekTargetTrack(this->trackNr, this->queueLength, this->repeatEnabled);
+	if (!this->standbyBridgeActive)
+	{
+		//standby deck already plays the selected station -> cross fade to it while the main instance switches
+		if (!this->IsMuted() && this->standbyDeck->IsPreRolled(trackNo))
+		{
+			LOG_DEBUG("MPDAudioSource::UpdateStandbyBridge - Cross fading to pre-rolled track %d.", trackNo);
+			this->standbyBridgeActive=true;
+			this->standbyDeck->FadeIn(SourceMuteRampCtrl::FAST);
+		}
+		return;
+	}
+
+	//further keys pressed -> the standby deck plays the wrong station now
+	if (!this->standbyDeck->IsPreRolled(trackNo) && this->standbyDeck->GetFadeState()!=MPDStandbyDeck::MUTED)
+	{
+		LOG_DEBUG("MPDAudioSource::UpdateStandbyBridge - Target changed to track %d. Fading out standby deck.", trackNo);
+		this->standbyBridgeActive=false;
+		this->standbyDeck->FadeOut(SourceMuteRampCtrl::FAST);
+	}
+}
+
 void MPDAudioSource::KickOffChangeTrackTransition()
 {
 	this->trackChangeTransition.StartNew();
@@ -465,14 +860,145 @@ void MPDAudioSource::OnRampFinished(bool canceled)
 	if (this->GetState()!=PLAYING) return;
 
 	if (this->trackChangeTransition.GetState()==TrackChangeTransition::RAMPING_DOWN)
-	{
 		this->ProcessPendingTrackChangeCommands();
-		this->FinalizeChangeTrackTransition();
-	}
 	else if (this->trackChangeTransition.GetState()==TrackChangeTransition::RAMPING_UP)
 		this->trackChangeTransition.Finished();
 }
 
+void MPDAudioSource::OnMPDResponsePair(MPDAsyncConnection *con, int cmdTag, const char *name, const char *value)
+{
+	struct mpd_pair pair;
+
+	if (cmdTag==CMD_TAG_IDLE)
+	{
+		this->ProcessIdleResponsePair(name, value);
+		return;
+	}
+
+	if (cmdTag==CMD_TAG_AUDIO_STATUS)
+	{
+		if (this->audioStatus==NULL)
+			this->audioStatus=mpd_status_begin();
+
+		pair.name=name;
+		pair.value=value;
+		mpd_status_feed(this->audioStatus, &pair);
+		return;
+	}
+
+	if (cmdTag==CMD_TAG_IDLE_PLAYLISTINFO)
+	{
+		this->queueCache.FeedPair(name, value);
+		return;
+	}
+
+	if (cmdTag==CMD_TAG_LIST_PLAYLISTS)
+	{
+		this->ProcessListPlaylistsPair(name, value);
+		return;
+	}
+
+	if (cmdTag==CMD_TAG_QUEUE_STATUS)
+	{
+		this->ProcessQueueStatusPair(name, value);
+		return;
+	}
+
+	if (cmdTag!=CMD_TAG_IDLE_STATUS)
+		return;
+
+	if (this->pendingStatus==NULL)
+		this->pendingStatus=mpd_status_begin();
+
+	pair.name=name;
+	pair.value=value;
+	mpd_status_feed(this->pendingStatus, &pair);
+}
+
+void MPDAudioSource::OnMPDCommandFinished(MPDAsyncConnection *con, int cmdTag, bool success, const char *errorMsg)
+{
+	if (!success)
+		LOG_ERROR("MPD command %d failed: %s", cmdTag, errorMsg);
+
+	switch(cmdTag)
+	{
+	case CMD_TAG_CLEAR_QUEUE:
+	case CMD_TAG_SET_REPEAT:
+		break;
+
+	case CMD_TAG_LOAD_PLAYLIST:
+		this->playListLoaded=success;
+		break;
+
+	case CMD_TAG_TRACK_CHANGE:
+		LatencyTracer::Instance()->Mark(LatencyTracer::TRACE_MPD_CMD_FINISHED, cmdTag);
+		//next transition is resolved relative to the new track even if the idle connection did not report it yet
+		if (success && this->trackChangeTarget!=_NO_TRACK_SET_ && (int)this->trackNr!=this->trackChangeTarget)
+		{
+			this->trackNr=this->trackChangeTarget;
+			RetroradioController::Instance()->GetPersistentState()->SetMPDCurrentTrackNr(this->trackNr);
+		}
+		this->trackChangeTarget=_NO_TRACK_SET_;
+		if (!this->mpdCon->IsCommandPending(CMD_TAG_TRACK_CHANGE))
+			this->OnTrackChangeCommandsProcessed();
+		break;
+
+	case CMD_TAG_LIST_PLAYLISTS:
+		break;
+
+	case CMD_TAG_QUEUE_STATUS:
+		//connection broke down while activating -> state is requested again after reconnecting
+		if (success || con->IsConnected())
+			this->OnQueueStateReceived(success);
+		break;
+
+	case CMD_TAG_AUDIO_STATUS:
+		this->OnAudioStatusReceived(success);
+		break;
+
+	case CMD_TAG_IDLE_PLAYLISTINFO:
+		this->queueCache.FinishUpdate(success);
+		break;
+
+	case CMD_TAG_IDLE_STATUS:
+		if (success)
+			this->ProcessStatusResponse();
+		break;
+
+	case CMD_TAG_IDLE:
+		//idle answered -> mpd reported changes. Read them and wait for the next ones.
+		if (con->IsConnected())
+			this->WaitForMPDChanges();
+		break;
+
+	case CMD_TAG_START_PLAYING:
+		LatencyTracer::Instance()->Mark(LatencyTracer::TRACE_MPD_CMD_FINISHED, cmdTag);
+		if (success)
+			this->PreRollNeighbourStation();
+		if (success && this->activationStartTime!=0)
+		{
+			LOG_INFO("MPD source %s playing %lld ms after activation.", this->GetName(),
+					(long long)(g_get_monotonic_time()-this->activationStartTime)/1000);
+			this->activationStartTime=0;
+		}
+		if (this->GetState()==START_PLAYING)
+			this->SourceStartPlayingFinished();
+		break;
+
+	case CMD_TAG_STOP_PLAYING:
+		if (this->GetState()==STOP_PLAYING)
+			this->SourceStopPlayingFinished();
+		break;
+	}
+
+	//a failed status request leaves the status object incomplete
+	if (this->pendingStatus!=NULL && cmdTag==CMD_TAG_IDLE_STATUS)
+	{
+		mpd_status_free(this->pendingStatus);
+		this->pendingStatus=NULL;
+	}
+}
+
 bool MPDAudioSource::IsMuteDownRampAllowed()
 {
 	return AbstractAudioSource::IsMuteDownRampAllowed();
@@ -495,6 +1021,16 @@ unsigned int MPDAudioSource::ConfigGetMPDPort()
 	return this->mpdPort;
 }
 
+unsigned int MPDAudioSource::ConfigGetAudioStartTimeout()
+{
+	return this->audioStartTimeoutMs;
+}
+
+const char* MPDAudioSource::ConfigGetStandbyAlsaMixerName()
+{
+	return this->standbyAlsaMixerName!=NULL ? this->standbyAlsaMixerName : MPD_DEFAULT_STANDBY_ALSA_MIXER_NAME;
+}
+
 const char* MPDAudioSource::ConfigGetRadioStationPlaylistName()
 {
 	return this->mpdStationPlayList!=NULL ? this->mpdStationPlayList : MPD_DEFAULT_RADIO_STATION_PLAYLIST;
@@ -549,6 +1085,46 @@ bool MPDAudioSource::ParseConfigFileItem(GKeyFile* confFile, const char* group,
 		else
 			result=false;
 	}
+	else if (strcasecmp(key, MPD_CONFIG_TAG_AUDIO_START_TIMEOUT)==0)
+	{
+		int timeout;
+		if (Configuration::GetInt64ValueFromKey(confFile,key,groupName, &timeout) && timeout>=0)
+			this->audioStartTimeoutMs=timeout;
+		else
+			result=false;
+	}
+	else if (strcasecmp(key, MPD_CONFIG_TAG_STANDBY_HOST)==0)
+	{
+		char *host;
+		if (Configuration::GetStringValueFromKey(confFile,key,groupName, &host))
+		{
+			if (this->standbyMpdHost)
+				free(this->standbyMpdHost);
+			this->standbyMpdHost=host;
+		}
+		else
+			result=false;
+	}
+	else if (strcasecmp(key, MPD_CONFIG_TAG_STANDBY_PORT)==0)
+	{
+		int port;
+		if (Configuration::GetInt64ValueFromKey(confFile,key,groupName, &port))
+			this->standbyMpdPort=port;
+		else
+			result=false;
+	}
+	else if (strcasecmp(key, MPD_CONFIG_TAG_STANDBY_ALSA_MIXER)==0)
+	{
+		char *mixerName;
+		if (Configuration::GetStringValueFromKey(confFile,key,groupName, &mixerName))
+		{
+			if (this->standbyAlsaMixerName)
+				free(this->standbyAlsaMixerName);
+			this->standbyAlsaMixerName=mixerName;
+		}
+		else
+			result=false;
+	}
 	else if (strcasecmp(key, MPD_CONFIG_TAG_PLAYLIST)==0)
 	{
 		char *playlist;
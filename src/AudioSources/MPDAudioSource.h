@@ -8,39 +8,134 @@
 #ifndef SRC_AUDIOSOURCES_MPDAUDIOSOURCE_H_
 #define SRC_AUDIOSOURCES_MPDAUDIOSOURCE_H_
 
-#include <mpd/connection.h>
+#include <mpd/status.h>
 
 #include <glib.h>
 
 #include "TrackChangeTransition.h"
+#include "MPDAsyncConnection.h"
+#include "MPDQueueCache.h"
+#include "MPDStandbyDeck.h"
 
 #include "AbstractAudioSource.h"
 
 namespace retroradio_controller
 {
 
-class MPDAudioSource: public AbstractAudioSource
+class MPDAudioSource: public AbstractAudioSource, public MPDAsyncConnection::IMPDConnectionListener,
+	public MPDStandbyDeck::IMPDStandbyDeckListener
 {
 private:
+	enum MPDCommandTag
+	{
+		CMD_TAG_CLEAR_QUEUE,
+		CMD_TAG_LOAD_PLAYLIST,
+		CMD_TAG_SET_REPEAT,
+		CMD_TAG_START_PLAYING,
+		CMD_TAG_STOP_PLAYING,
+		CMD_TAG_TRACK_CHANGE,
+		CMD_TAG_IDLE,
+		CMD_TAG_IDLE_STATUS,
+		CMD_TAG_LIST_PLAYLISTS,
+		CMD_TAG_QUEUE_STATUS,
+		CMD_TAG_IDLE_PLAYLISTINFO,
+		CMD_TAG_AUDIO_STATUS
+	};
+
 	char *mpdHost;
 
 	unsigned int mpdPort;
 
 	char *mpdStationPlayList;
 
+	unsigned int audioStartTimeoutMs;
+
+	//optional second mpd instance used for cross fading station changes
+	char *standbyMpdHost;
+
+	unsigned int standbyMpdPort;
+
+	char *standbyAlsaMixerName;
+
+	MPDStandbyDeck *standbyDeck;
+
+	//standby deck audible while the main instance changes the track
+	bool standbyBridgeActive;
+
+	//direction of the last station change. The standby deck pre-rolls the neighbour in this direction.
+	bool preRollForward;
+
 	TrackChangeTransition trackChangeTransition;
 
-	struct mpd_connection *mpdCon;
+	//connection used for sending commands to mpd
+	MPDAsyncConnection *mpdCon;
+
+	//dedicated connection waiting for player, playlist and mixer changes using mpd's idle command
+	MPDAsyncConnection *mpdIdleCon;
+
+	//collects the pairs of a status response on the idle connection until the command is finished
+	struct mpd_status *pendingStatus;
+
+	bool statusRefreshNeeded;
+
+	//songs of the mpd queue, refreshed by the idle connection after playlist changes
+	MPDQueueCache queueCache;
+
+	bool queueCacheRefreshNeeded;
 
 	unsigned int trackNr;
 
 	unsigned int queueLength;
 
+	bool repeatEnabled;
+
+	//queue position requested by the last track change command
+	int trackChangeTarget;
+
+	//monotonic time mpd was asked to play the new track. The ramp up waits until mpd produces audio.
+	gint64 trackChangePlayTime;
+
+	struct mpd_status *audioStatus;
+
+	guint audioPollTimerId;
+
 	guint pollSourceId;
 
-	guint mpdWatchdogTimerId;
+	//connection is probed until mpd is available after startup
+	bool waitingForStartup;
+
+	//mpd was reachable once. Startup stays finished when the probe connection is closed.
+	bool startupProbed;
+
+	//closes the probe connection if the source is not activated in time
+	guint probeIdleTimerId;
+
+	//delay of the next connect attempt. Doubled after each failed attempt.
+	unsigned int retryIntervalMs;
+
+	//the radio station playlist is loaded together with the first play command after activation
+	//unless the queue still holds it unchanged
+	bool playListLoaded;
+
+	//modification time of the radio station playlist as reported by listplaylists
+	char playListLastModified[32];
+
+	bool playListFound;
+
+	unsigned int queueVersion;
+
+	//monotonic time the activation started. Used to log the time until mpd acknowledged playing.
+	gint64 activationStartTime;
 
-	bool ConnectToMPD();
+	void ConnectToMPD();
+
+	void ProbeMPD();
+
+	void StartProbeIdleTimer();
+
+	void StopProbeIdleTimer();
+
+	static gboolean OnProbeIdleTimerElapsed(gpointer data);
 
 	void DisconnectFromMPD();
 
@@ -48,11 +143,15 @@ private:
 
 	unsigned int ConfigGetMPDPort();
 
-	void ArmMPDAliveWatchdog();
+	unsigned int ConfigGetAudioStartTimeout();
 
-	void DisarmMPDAliveWatchdog();
+	const char *ConfigGetStandbyAlsaMixerName();
 
-	void CheckMPDAliveAndReadTrackPos();
+	void WaitForMPDChanges();
+
+	void ProcessIdleResponsePair(const char *name, const char *value);
+
+	void ProcessStatusResponse();
 
 	void StartPollingMPD();
 
@@ -60,22 +159,40 @@ private:
 
 	static gboolean RetryConnect(gpointer data);
 
-	static gboolean MPDConnectionWatchdog(gpointer data);
+	void SendLoadPlayListCommands();
 
-	void LoadPlayList();
+	void RequestQueueState();
 
-	virtual void OnRampFinished(bool canceled);
+	void ProcessListPlaylistsPair(const char *name, const char *value);
 
-	void KickOffChangeTrackTransition();
+	void ProcessQueueStatusPair(const char *name, const char *value);
+
+	void OnQueueStateReceived(bool success);
+
+	bool IsQueueCurrent();
 
-	void ProcessPendingSelectTrackCommand();
+	virtual void OnRampFinished(bool canceled);
 
-	void ProcessPendingNextPrevCommands();
+	void KickOffChangeTrackTransition();
 
 	void ProcessPendingTrackChangeCommands();
 
+	void OnTrackChangeCommandsProcessed();
+
 	void FinalizeChangeTrackTransition();
 
+	void PreRollNeighbourStation();
+
+	void UpdateStandbyBridge();
+
+	void RequestAudioStatus();
+
+	void OnAudioStatusReceived(bool success);
+
+	void StopAudioPolling();
+
+	static gboolean OnAudioPollTimerElapsed(gpointer data);
+
 protected:
 	virtual const char *GetConfigGroupName();
 
@@ -91,8 +208,6 @@ protected:
 
 	virtual bool IsMuteUpRampAllowed();
 
-	virtual void SourceActivationFinished();
-
 public:
 	MPDAudioSource(const char *srcName, AbstractAudioSource *predecessor,
 			IAudioSourceStateListener *srcListener);
@@ -105,6 +220,8 @@ public:
 
 	virtual bool IsStartupFinished();
 
+	virtual void WaitForStartup();
+
 	virtual void DoActivateSource(bool need2ReOpenSoundDevices);
 
 	virtual void DoDeActivateSource();
@@ -120,6 +237,18 @@ public:
 	virtual void Favorite(FavoriteT favorite);
 
 	virtual bool ParseConfigFileItem(GKeyFile *confFile, const char *group, const char *key);
+
+	//MPDAsyncConnection::IMPDConnectionListener
+	virtual void OnMPDConnected(MPDAsyncConnection *con);
+
+	virtual void OnMPDConnectionLost(MPDAsyncConnection *con);
+
+	virtual void OnMPDResponsePair(MPDAsyncConnection *con, int cmdTag, const char *name, const char *value);
+
+	virtual void OnMPDCommandFinished(MPDAsyncConnection *con, int cmdTag, bool success, const char *errorMsg);
+
+	//MPDStandbyDeck::IMPDStandbyDeckListener
+	virtual void OnStandbyDeckConnectionLost(MPDStandbyDeck *deck);
 };
 
 } /* namespace retroradio_controller */
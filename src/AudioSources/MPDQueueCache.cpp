@@ -0,0 +1,111 @@
+/*
+ * MPDQueueCache.cpp
+ *
+ *  Created on: 17.10.2026
+ *      Author: joe
+ */
+
+#include "MPDQueueCache.h"
+
+#include "Logging.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+using namespace CppAppUtils;
+
+using namespace retroradio_controller;
+
+MPDQueueCache::MPDQueueCache() :
+		valid(false),
+		updating(false)
+{
+}
+
+MPDQueueCache::~MPDQueueCache()
+{
+}
+
+void MPDQueueCache::Invalidate()
+{
+	LOG_DEBUG("MPDQueueCache::Invalidate - MPD queue cache invalidated.");
+	this->valid=false;
+	this->entries.clear();
+}
+
+void MPDQueueCache::BeginUpdate()
+{
+	this->newEntries.clear();
+	this->updating=true;
+}
+
+void MPDQueueCache::FeedPair(const char *name, const char *value)
+{
+	Entry *entry;
+
+	if (!this->updating)
+		return;
+
+	//each song of a playlistinfo response starts with its uri
+	if (strcmp(name, "file")==0)
+	{
+		Entry newEntry;
+		newEntry.songId=0;
+		newEntry.pos=this->newEntries.size();
+		newEntry.uri=value;
+		this->newEntries.push_back(newEntry);
+		return;
+	}
+
+	if (this->newEntries.empty())
+		return;
+
+	entry=&this->newEntries.back();
+	if (strcmp(name, "Id")==0)
+		entry->songId=strtoul(value, NULL, 10);
+	else if (strcmp(name, "Pos")==0)
+		entry->pos=strtoul(value, NULL, 10);
+	else if (strcmp(name, "Name")==0)
+		entry->name=value;
+	else if (strcmp(name, "Title")==0 && entry->name.empty())
+		entry->name=value;
+}
+
+void MPDQueueCache::FinishUpdate(bool success)
+{
+	if (!this->updating)
+		return;
+
+	this->updating=false;
+	if (!success)
+	{
+		this->newEntries.clear();
+		return;
+	}
+
+	this->entries.swap(this->newEntries);
+	this->newEntries.clear();
+	this->valid=true;
+
+	LOG_DEBUG("MPDQueueCache::FinishUpdate - MPD queue cache holds %u entries.", (unsigned int)this->entries.size());
+}
+
+bool MPDQueueCache::IsValid()
+{
+	return this->valid;
+}
+
+bool MPDQueueCache::IsUpdating()
+{
+	return this->updating;
+}
+
+unsigned int MPDQueueCache::GetLength()
+{
+	return this->entries.size();
+}
+
+bool MPDQueueCache::IsPositionValid(int pos)
+{
+	return pos>=0 && pos<(int)this->entries.size();
+}
@@ -0,0 +1,68 @@
+/*
+ * MPDQueueCache.h
+ *
+ *  Created on: 17.10.2026
+ *      Author: joe
+ */
+
+#ifndef SRC_AUDIOSOURCES_MPDQUEUECACHE_H_
+#define SRC_AUDIOSOURCES_MPDQUEUECACHE_H_
+
+#include <string>
+#include <vector>
+
+namespace retroradio_controller
+{
+
+//Local copy of the mpd queue. It is filled from the pairs of a playlistinfo response and invalidated when
+//mpd reports a playlist change, so lookups on the input path don't need a round trip to mpd.
+class MPDQueueCache
+{
+public:
+	typedef struct Entry
+	{
+		unsigned int songId;
+
+		unsigned int pos;
+
+		std::string uri;
+
+		//stream name or title, empty if mpd does not know any
+		std::string name;
+	} Entry;
+
+private:
+	std::vector<Entry> entries;
+
+	std::vector<Entry> newEntries;
+
+	bool valid;
+
+	bool updating;
+
+public:
+	MPDQueueCache();
+
+	virtual ~MPDQueueCache();
+
+	void Invalidate();
+
+	void BeginUpdate();
+
+	void FeedPair(const char *name, const char *value);
+
+	//takes over the collected entries if the playlistinfo command succeeded
+	void FinishUpdate(bool success);
+
+	bool IsValid();
+
+	bool IsUpdating();
+
+	unsigned int GetLength();
+
+	bool IsPositionValid(int pos);
+};
+
+} /* namespace retroradio_controller */
+
+#endif /* SRC_AUDIOSOURCES_MPDQUEUECACHE_H_ */
@@ -0,0 +1,236 @@
+/*
+ * MPDStandbyDeck.cpp
+ *
+ *  Created on: 17.10.2026
+ *      Author: joe
+ */
+
+#include "MPDStandbyDeck.h"
+#include "TrackChangeTransition.h"
+
+#include "Logging.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace CppAppUtils;
+
+using namespace retroradio_controller;
+
+MPDStandbyDeck::MPDStandbyDeck(IMPDStandbyDeckListener *listener) :
+		listener(listener),
+		playList(NULL),
+		playListLoaded(false),
+		fadeState(MUTED),
+		preRolledTrackNr(_NO_TRACK_SET_),
+		preRollFinished(false),
+		pendingPreRollTrackNr(_NO_TRACK_SET_),
+		stopPending(false)
+{
+	this->mpdCon=new MPDAsyncConnection(this);
+	this->mpdCon->SetParkInIdle(true);
+	this->rampCtrl=new SourceMuteRampCtrl(this);
+}
+
+MPDStandbyDeck::~MPDStandbyDeck()
+{
+	delete this->mpdCon;
+	delete this->rampCtrl;
+	if (this->playList!=NULL)
+		free(this->playList);
+}
+
+bool MPDStandbyDeck::InitMixer(const char *cardName, const char *mixerName)
+{
+	LOG_DEBUG("MPDStandbyDeck::InitMixer - Initializing standby deck mixer. Card: %s, Mixer: %s", cardName, mixerName);
+
+	//mixer starts muted, the deck only becomes audible by fading in
+	this->rampCtrl->DeInit();
+	this->fadeState=MUTED;
+	return this->rampCtrl->Init(cardName, mixerName);
+}
+
+void MPDStandbyDeck::SetPlayList(const char *playList)
+{
+	if (this->playList!=NULL)
+		free(this->playList);
+	this->playList=strdup(playList);
+}
+
+bool MPDStandbyDeck::Connect(const char *host, unsigned int port, unsigned int timeoutMs)
+{
+	return this->mpdCon->Connect(host, port, timeoutMs);
+}
+
+void MPDStandbyDeck::Disconnect()
+{
+	this->mpdCon->Disconnect();
+	this->playListLoaded=false;
+	this->preRolledTrackNr=_NO_TRACK_SET_;
+	this->preRollFinished=false;
+	this->pendingPreRollTrackNr=_NO_TRACK_SET_;
+	this->stopPending=false;
+}
+
+MPDAsyncConnection::State MPDStandbyDeck::GetConnectionState()
+{
+	return this->mpdCon->GetState();
+}
+
+void MPDStandbyDeck::PreRoll(int trackNr)
+{
+	this->stopPending=false;
+	this->pendingPreRollTrackNr=trackNr;
+	this->DoPreRoll();
+}
+
+void MPDStandbyDeck::DoPreRoll()
+{
+	char trackStr[16];
+
+	//switching the stream while the deck is audible would be heard
+	if (!this->mpdCon->IsConnected() || !this->playListLoaded || this->fadeState!=MUTED ||
+			this->pendingPreRollTrackNr==_NO_TRACK_SET_)
+		return;
+
+	if (this->pendingPreRollTrackNr==this->preRolledTrackNr)
+	{
+		this->pendingPreRollTrackNr=_NO_TRACK_SET_;
+		return;
+	}
+
+	snprintf(trackStr, sizeof(trackStr), "%d", this->pendingPreRollTrackNr);
+	if (!this->mpdCon->SendCommand(DECK_CMD_TAG_PLAY, "play", trackStr, NULL))
+		return;
+
+	LOG_DEBUG("MPDStandbyDeck::DoPreRoll - Pre-rolling track %d on standby deck.", this->pendingPreRollTrackNr);
+	this->preRolledTrackNr=this->pendingPreRollTrackNr;
+	this->preRollFinished=false;
+	this->pendingPreRollTrackNr=_NO_TRACK_SET_;
+}
+
+bool MPDStandbyDeck::IsPreRolled(int trackNr)
+{
+	return trackNr!=_NO_TRACK_SET_ && this->preRollFinished && this->preRolledTrackNr==trackNr &&
+			this->fadeState==MUTED;
+}
+
+void MPDStandbyDeck::FadeIn(SourceMuteRampCtrl::RampSpeed speed)
+{
+	LOG_DEBUG("MPDStandbyDeck::FadeIn - Standby deck fading in track %d.", this->preRolledTrackNr);
+	this->fadeState=FADING_IN;
+	this->rampCtrl->UnmuteAsync(speed);
+}
+
+void MPDStandbyDeck::FadeOut(SourceMuteRampCtrl::RampSpeed speed)
+{
+	if (this->fadeState==MUTED)
+		return;
+
+	LOG_DEBUG("MPDStandbyDeck::FadeOut - Standby deck fading out.");
+	this->fadeState=FADING_OUT;
+	this->rampCtrl->MuteAsync(speed);
+}
+
+void MPDStandbyDeck::Stop()
+{
+	this->pendingPreRollTrackNr=_NO_TRACK_SET_;
+	if (this->fadeState!=MUTED)
+	{
+		this->stopPending=true;
+		this->FadeOut(SourceMuteRampCtrl::FAST);
+		return;
+	}
+
+	this->DoStop();
+}
+
+void MPDStandbyDeck::DoStop()
+{
+	this->stopPending=false;
+	this->preRolledTrackNr=_NO_TRACK_SET_;
+	this->preRollFinished=false;
+	if (this->mpdCon->IsConnected())
+		this->mpdCon->SendCommand(DECK_CMD_TAG_STOP, "stop", NULL);
+}
+
+MPDStandbyDeck::FadeState MPDStandbyDeck::GetFadeState()
+{
+	return this->fadeState;
+}
+
+void MPDStandbyDeck::OnRampFinished(bool canceled)
+{
+	if (this->fadeState==FADING_IN)
+	{
+		this->fadeState=AUDIBLE;
+		return;
+	}
+
+	if (this->fadeState!=FADING_OUT)
+		return;
+
+	this->fadeState=MUTED;
+	if (this->stopPending)
+		this->DoStop();
+	else
+		this->DoPreRoll();
+}
+
+void MPDStandbyDeck::OnMPDConnected(MPDAsyncConnection *con)
+{
+	LOG_DEBUG("MPDStandbyDeck::OnMPDConnected - Connected to standby mpd daemon. Loading playlist %s.",
+			this->playList);
+
+	//the standby instance does not share the queue of the main instance -> load the same playlist
+	if (!this->mpdCon->BeginCommandList())
+		return;
+	this->mpdCon->SendCommand(DECK_CMD_TAG_CLEAR_QUEUE, "clear", NULL);
+	this->mpdCon->SendCommand(DECK_CMD_TAG_LOAD_PLAYLIST, "load", this->playList, NULL);
+	this->mpdCon->SendCommand(DECK_CMD_TAG_SET_REPEAT, "repeat", "1", NULL);
+	this->mpdCon->EndCommandList();
+}
+
+void MPDStandbyDeck::OnMPDConnectionLost(MPDAsyncConnection *con)
+{
+	LOG_DEBUG("MPDStandbyDeck::OnMPDConnectionLost - Connection to standby mpd daemon lost.");
+
+	this->playListLoaded=false;
+	this->preRolledTrackNr=_NO_TRACK_SET_;
+	this->preRollFinished=false;
+	this->FadeOut(SourceMuteRampCtrl::FAST);
+
+	if (this->listener!=NULL)
+		this->listener->OnStandbyDeckConnectionLost(this);
+}
+
+void MPDStandbyDeck::OnMPDResponsePair(MPDAsyncConnection *con, int cmdTag, const char *name, const char *value)
+{
+}
+
+void MPDStandbyDeck::OnMPDCommandFinished(MPDAsyncConnection *con, int cmdTag, bool success, const char *errorMsg)
+{
+	if (!success)
+		LOG_ERROR("Standby MPD command %d failed: %s", cmdTag, errorMsg);
+
+	switch(cmdTag)
+	{
+	case DECK_CMD_TAG_CLEAR_QUEUE:
+	case DECK_CMD_TAG_SET_REPEAT:
+	case DECK_CMD_TAG_STOP:
+		break;
+
+	case DECK_CMD_TAG_LOAD_PLAYLIST:
+		this->playListLoaded=success;
+		if (success)
+			this->DoPreRoll();
+		break;
+
+	case DECK_CMD_TAG_PLAY:
+		this->preRollFinished=success;
+		if (!success)
+			this->preRolledTrackNr=_NO_TRACK_SET_;
+		break;
+	}
+}
@@ -0,0 +1,116 @@
+/*
+ * MPDStandbyDeck.h
+ *
+ *  Created on: 17.10.2026
+ *      Author: joe
+ */
+
+#ifndef SRC_AUDIOSOURCES_MPDSTANDBYDECK_H_
+#define SRC_AUDIOSOURCES_MPDSTANDBYDECK_H_
+
+#include "MPDAsyncConnection.h"
+#include "SourceMuteRampCtrl.h"
+
+namespace retroradio_controller
+{
+
+//Second mpd instance playing on its own softvol mixer. It pre-rolls the station most likely selected next
+//while muted, so a station change can cross fade to it instead of ramping over silence.
+class MPDStandbyDeck: public MPDAsyncConnection::IMPDConnectionListener,
+	public SourceMuteRampCtrl::IMuteRampCtrlListener
+{
+public:
+	enum FadeState
+	{
+		MUTED,
+		FADING_IN,
+		AUDIBLE,
+		FADING_OUT
+	};
+
+	class IMPDStandbyDeckListener
+	{
+	public:
+		virtual void OnStandbyDeckConnectionLost(MPDStandbyDeck *deck)=0;
+	};
+
+private:
+	enum DeckCommandTag
+	{
+		DECK_CMD_TAG_CLEAR_QUEUE,
+		DECK_CMD_TAG_LOAD_PLAYLIST,
+		DECK_CMD_TAG_SET_REPEAT,
+		DECK_CMD_TAG_PLAY,
+		DECK_CMD_TAG_STOP
+	};
+
+	IMPDStandbyDeckListener *listener;
+
+	MPDAsyncConnection *mpdCon;
+
+	SourceMuteRampCtrl *rampCtrl;
+
+	char *playList;
+
+	bool playListLoaded;
+
+	FadeState fadeState;
+
+	//track played muted, _NO_TRACK_SET_ if none
+	int preRolledTrackNr;
+
+	bool preRollFinished;
+
+	//track to pre-roll as soon as the deck is muted and the playlist is loaded
+	int pendingPreRollTrackNr;
+
+	bool stopPending;
+
+	void DoPreRoll();
+
+	void DoStop();
+
+public:
+	MPDStandbyDeck(IMPDStandbyDeckListener *listener);
+
+	virtual ~MPDStandbyDeck();
+
+	bool InitMixer(const char *cardName, const char *mixerName);
+
+	void SetPlayList(const char *playList);
+
+	bool Connect(const char *host, unsigned int port, unsigned int timeoutMs);
+
+	void Disconnect();
+
+	MPDAsyncConnection::State GetConnectionState();
+
+	void PreRoll(int trackNr);
+
+	bool IsPreRolled(int trackNr);
+
+	void FadeIn(SourceMuteRampCtrl::RampSpeed speed);
+
+	void FadeOut(SourceMuteRampCtrl::RampSpeed speed);
+
+	//fades out if audible and stops playing
+	void Stop();
+
+	FadeState GetFadeState();
+
+	//SourceMuteRampCtrl::IMuteRampCtrlListener
+	virtual void OnRampFinished(bool canceled);
+
+	//MPDAsyncConnection::IMPDConnectionListener
+	virtual void OnMPDConnected(MPDAsyncConnection *con);
+
+	virtual void OnMPDConnectionLost(MPDAsyncConnection *con);
+
+	virtual void OnMPDResponsePair(MPDAsyncConnection *con, int cmdTag, const char *name, const char *value);
+
+	virtual void OnMPDCommandFinished(MPDAsyncConnection *con, int cmdTag, bool success, const char *errorMsg);
+};
+
+} /* namespace retroradio_controller */
+
+#endif /* SRC_AUDIOSOURCES_MPDSTANDBYDECK_H_ */
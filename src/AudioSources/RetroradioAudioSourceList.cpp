@@ -9,7 +9,7 @@
 
 #include <stdlib.h>
 
-#include <cpp-app-utils/Logger.h>
+#include "Logging.h"
 
 #include "RetroradioController.h"
 
@@ -100,7 +100,7 @@ void RetroradioAudioSourceList::ChangeToSource(const char* sourceName)
 		}
 	}
 
-	Logger::LogError("Change to unknown Source %s requested.", sourceName);
+	LOG_ERROR("Change to unknown Source %s requested.", sourceName);
 }
 
 void RetroradioAudioSourceList::ChangeToNextSource()
@@ -7,23 +7,62 @@
 
 #include "SourceMuteRampCtrl.h"
 
-#include "cpp-app-utils/Logger.h"
+#include <math.h>
+
+#include "Logging.h"
 
 using namespace retroradio_controller;
 using namespace CppAppUtils;
 
-#define NUMBER_VOL_STEPS	20
+//gain of a ramp never written below this attenuation except for the final mute
+#define RAMP_FLOOR_CENTI_DB		(-5000)
+
+//Gain curve over the ramp position in 0.01 dB relative to full volume. The ramp is linear in dB, which
+//is perceived as even, with eased ends. Generated at compile time, the position between two points is interpolated.
+template<unsigned int POINTS>
+struct RampCurve
+{
+	short centiDb[POINTS+1];
 
-const int SourceMuteRampCtrl::RAMP_STEP_DELAY_MS[]={15,30,45};
+	constexpr RampCurve() :
+			centiDb()
+	{
+		for (unsigned int a=0; a<=POINTS; a++)
+		{
+			double pos=(double)a/POINTS;
+			double eased=pos*pos*(3-2*pos);
+			this->centiDb[a]=(short)(RAMP_FLOOR_CENTI_DB*(1-eased));
+		}
+	}
+};
+
+//dB steps are perceived evenly -> fewer points than the former 20 raw steps give the same smoothness
+static constexpr RampCurve<12> fastRampCurve;
+static constexpr RampCurve<16> normalRampCurve;
+static constexpr RampCurve<20> slowRampCurve;
+
+const short *const SourceMuteRampCtrl::RAMP_CURVES[]={ fastRampCurve.centiDb, normalRampCurve.centiDb, slowRampCurve.centiDb };
+
+const unsigned int SourceMuteRampCtrl::RAMP_CURVE_POINTS[]={ 12, 16, 20 };
+
+//full ramp from mute to full volume
+const unsigned int SourceMuteRampCtrl::RAMP_DURATION_MS[]={ 300, 600, 900 };
 
 SourceMuteRampCtrl::SourceMuteRampCtrl(IMuteRampCtrlListener* listener) :
 		BasicMixerControl(),
-		listener(listener),
-		state(_NOT_SET),
-		timerId(-1),
+		requestSeq(0),
+		rampPending(false),
+		initialized(false),
+		initCardName(NULL),
+		initMixerName(NULL),
+		rampSeq(0),
 		curVolReal(0),
+		rampStartTime(0),
+		rampStartPos(0),
 		curRampSpeed(SLOW),
-		volumeStep(1)
+		listener(listener),
+		state(_NOT_SET),
+		timerId(-1)
 {
 }
 
@@ -33,100 +72,232 @@ SourceMuteRampCtrl::~SourceMuteRampCtrl()
 
 bool SourceMuteRampCtrl::Init(const char* cardName, const char* mixerName)
 {
-	if (!BasicMixerControl::Init(cardName, mixerName))
+	//a ramp still running is dropped silently
+	this->requestSeq++;
+	this->rampPending=false;
+
+	this->initCardName=cardName;
+	this->initMixerName=mixerName;
+	this->initialized=AudioControlThread::Instance()->Invoke(this, RAMP_CMD_INIT, 0)!=0;
+
+	return this->initialized;
+}
+
+bool SourceMuteRampCtrl::DoInit()
+{
+	this->DoStop();
+
+	if (!BasicMixerControl::Init(this->initCardName, this->initMixerName))
 		return false;
 
-	Logger::LogDebug("SourceMuteRampCtrl::Init - Initializing source mute ramp. Card: %s, Mixer: %s", cardName, mixerName);
+	LOG_DEBUG("SourceMuteRampCtrl::Init - Initializing source mute ramp. Card: %s, Mixer: %s",
+			this->initCardName, this->initMixerName);
 
 	this->state=IDLE;
 	this->curVolReal=rangeMin;
 	this->SetVolumeReal(this->rangeMin);
 	this->curRampSpeed=SLOW;
 
-	this->volumeStep=(this->rangeMax-this->rangeMin)/NUMBER_VOL_STEPS;
-	if (this->volumeStep==0)
-		this->volumeStep=1;
-
 	return true;
 }
 
 void SourceMuteRampCtrl::DeInit()
 {
+	this->requestSeq++;
+	this->rampPending=false;
+	AudioControlThread::Instance()->Invoke(this, RAMP_CMD_DEINIT, 0);
+}
+
+void SourceMuteRampCtrl::DoDeInit()
+{
+	this->DoStop();
 }
 
 void SourceMuteRampCtrl::MuteAsync(RampSpeed speed)
 {
-	if (this->state==_NOT_SET) return;
+	if (!this->initialized) return;
 
-	if (this->state!=IDLE)
-	{
-		// in case we are in the middle of an unmute ramp, just change the state to muting. The rest is already set up.
-		if (this->state==UNMUTING)
-			this->state=MUTING;
+	this->requestSeq++;
+	this->rampPending=true;
+	AudioControlThread::Instance()->Post(this, RAMP_CMD_MUTE, speed, this->requestSeq);
+}
 
-		if (this->curRampSpeed==speed) return;
-		// speed is different, change timer in this case
-	}
-	else
+void SourceMuteRampCtrl::UnmuteAsync(RampSpeed speed)
+{
+	if (!this->initialized) return;
+
+	this->requestSeq++;
+	this->rampPending=true;
+	AudioControlThread::Instance()->Post(this, RAMP_CMD_UNMUTE, speed, this->requestSeq);
+}
+
+void SourceMuteRampCtrl::StopOperation()
+{
+	if (!this->rampPending)
+		return;
+
+	//the listener is notified at once like before, a finish event already on its way is dropped
+	this->requestSeq++;
+	this->rampPending=false;
+	AudioControlThread::Instance()->Post(this, RAMP_CMD_STOP, 0, this->requestSeq);
+
+	if (this->listener!=NULL)
+		this->listener->OnRampFinished(false);
+}
+
+long SourceMuteRampCtrl::OnAudioControlCommand(int cmd, long arg, unsigned int tag)
+{
+	switch((Command)cmd)
 	{
-		//update from actual volume set currently
-		this->curVolReal=this->GetVolumeReal();
-		this->state=MUTING;
-		Logger::LogDebug("SourceMuteRampCtrl::MuteAsync - Starting a mute ramp for mixer %s. Current volume: %ld",
-				this->mixerName, this->curVolReal);
+	case RAMP_CMD_INIT:
+		return this->DoInit() ? 1 : 0;
+
+	case RAMP_CMD_DEINIT:
+		this->DoDeInit();
+		break;
+
+	case RAMP_CMD_MUTE:
+		this->rampSeq=tag;
+		this->DoMute((RampSpeed)arg);
+		break;
+
+	case RAMP_CMD_UNMUTE:
+		this->rampSeq=tag;
+		this->DoUnmute((RampSpeed)arg);
+		break;
+
+	case RAMP_CMD_STOP:
+		this->DoStop();
+		break;
 	}
 
-	this->SetupRampTimer(speed);
+	return 0;
 }
 
-void SourceMuteRampCtrl::UnmuteAsync(RampSpeed speed)
+void SourceMuteRampCtrl::OnAudioControlEvent(int event, long arg, unsigned int tag)
+{
+	if (event!=RAMP_EVT_FINISHED || tag!=this->requestSeq)
+		return;
+
+	this->rampPending=false;
+	if (this->listener!=NULL)
+		this->listener->OnRampFinished(arg!=0);
+}
+
+void SourceMuteRampCtrl::DoMute(RampSpeed speed)
 {
+	this->StartRamp(MUTING, speed);
+}
+
+void SourceMuteRampCtrl::DoUnmute(RampSpeed speed)
+{
+	this->StartRamp(UNMUTING, speed);
+}
+
+void SourceMuteRampCtrl::StartRamp(State direction, RampSpeed speed)
+{
+	gint64 now=g_get_monotonic_time();
+	double pos;
+
 	if (this->state==_NOT_SET) return;
 
 	if (this->state!=IDLE)
 	{
-		// in case we are in the middle of an unmute ramp, just change the state to muting. The rest is already set up.
-		if (this->state==MUTING)
-			this->state=UNMUTING;
+		if (this->state==direction && this->curRampSpeed==speed) return;
 
-		if (this->curRampSpeed==speed) return;
-		// speed is different, change timer in this case
+		// direction or speed changes in the middle of a ramp -> continue from the current point of the curve
+		pos=this->GetRampPosition(now);
 	}
 	else
 	{
 		//update from actual volume set currently
 		this->curVolReal=this->GetVolumeReal();
-		this->state=UNMUTING;
-		Logger::LogDebug("SourceMuteRampCtrl::UnMuteAsync - Starting a unmute ramp for mixer %s. Current volume: %ld",
-				this->mixerName, this->curVolReal);
+		pos=this->GetPositionFromVolume(this->curVolReal);
+		LOG_DEBUG("SourceMuteRampCtrl::StartRamp - Starting a %s ramp for mixer %s. Current volume: %ld",
+				direction==MUTING ? "mute" : "unmute", this->mixerName, this->curVolReal);
 	}
 
+	this->state=direction;
+	this->rampStartTime=now;
+	this->rampStartPos=pos;
 	this->SetupRampTimer(speed);
 }
 
+double SourceMuteRampCtrl::GetRampPosition(gint64 now)
+{
+	double delta=(double)(now-this->rampStartTime)/(RAMP_DURATION_MS[this->curRampSpeed]*1000);
+	double pos=this->state==MUTING ? this->rampStartPos-delta : this->rampStartPos+delta;
+
+	if (pos<0) pos=0;
+	if (pos>1) pos=1;
+	return pos;
+}
+
+long SourceMuteRampCtrl::GetVolumeAtPosition(double pos)
+{
+	const short *curve=RAMP_CURVES[this->curRampSpeed];
+	unsigned int points=RAMP_CURVE_POINTS[this->curRampSpeed];
+	unsigned int idx;
+	double frac;
+
+	if (pos<=0) return this->rangeMin;
+	if (pos>=1) return this->rangeMax;
+
+	idx=(unsigned int)(pos*points);
+	frac=pos*points-idx;
+	return this->DbToMixerVol(lround(curve[idx]+(curve[idx+1]-curve[idx])*frac));
+}
+
+double SourceMuteRampCtrl::GetPositionFromVolume(long volReal)
+{
+	unsigned int points=RAMP_CURVE_POINTS[this->curRampSpeed];
+	long lower=this->rangeMin;
+
+	if (volReal<=this->rangeMin) return 0;
+	if (volReal>=this->rangeMax) return 1;
+
+	//the curve is monotonic -> look up the segment and interpolate in mixer units
+	for (unsigned int a=1; a<=points; a++)
+	{
+		long upper=a==points ? this->rangeMax : this->GetVolumeAtPosition((double)a/points);
+		if (volReal<=upper)
+		{
+			if (upper==lower) return (double)a/points;
+			return ((a-1)+(double)(volReal-lower)/(upper-lower))/points;
+		}
+		lower=upper;
+	}
+
+	return 1;
+}
+
 void SourceMuteRampCtrl::SetupRampTimer(RampSpeed speed)
 {
 	this->curRampSpeed=speed;
 	if (this->timerId!=-1)
 		this->CleanUpTimer();
 
-	this->timerId=g_timeout_add(RAMP_STEP_DELAY_MS[speed], SourceMuteRampCtrl::OnRampTimerElapsed, this);
+	//ticks only sample the curve, the position is taken from the elapsed time. Late ticks jump ahead.
+	this->timerId=AudioControlThread::Instance()->GetTimerWheel()->Add(
+			RAMP_DURATION_MS[speed]/RAMP_CURVE_POINTS[speed], TimerWheel::TIMER_SLACK_PRECISE,
+			SourceMuteRampCtrl::OnRampTimerElapsed, this);
 }
 
-void SourceMuteRampCtrl::StopOperation()
+void SourceMuteRampCtrl::DoStop()
 {
 	if (this->timerId==-1)
 		return;
 
-	Logger::LogDebug("SourceMuteRampCtrl::StopOperation - Canceling current mute operation for mixer %s. Current volume: %ld",
+	LOG_DEBUG("SourceMuteRampCtrl::StopOperation - Canceling current mute operation for mixer %s. Current volume: %ld",
 			this->mixerName, this->curVolReal);
-	this->RampFinished(false);
+	this->CleanUpTimer();
+	this->state=IDLE;
 }
 
 void SourceMuteRampCtrl::CleanUpTimer()
 {
-	Logger::LogDebug("SourceMuteRampCtrl::CleanUpTimer - Ramp done for mixer %s. Cleaning up ramp timer", this->mixerName);
-	g_source_remove(this->timerId);
+	LOG_DEBUG("SourceMuteRampCtrl::CleanUpTimer - Ramp done for mixer %s. Cleaning up ramp timer", this->mixerName);
+	AudioControlThread::Instance()->GetTimerWheel()->Remove(this->timerId);
 	this->timerId=-1;
 }
 
@@ -134,6 +305,8 @@ gboolean SourceMuteRampCtrl::OnRampTimerElapsed(gpointer user_data)
 {
 	SourceMuteRampCtrl *instance=(SourceMuteRampCtrl *)user_data;
 	gboolean result=TRUE;
+	double pos;
+	long volReal;
 
 	switch(instance->state)
 	{
@@ -143,23 +316,15 @@ gboolean SourceMuteRampCtrl::OnRampTimerElapsed(gpointer user_data)
 		break;
 
 	case MUTING:
-		instance->curVolReal-=instance->volumeStep;
-		if (instance->curVolReal<instance->rangeMin)
-			instance->curVolReal=instance->rangeMin;
-		instance->SetVolumeReal(instance->curVolReal);
-		if (instance->curVolReal==0)
+	case UNMUTING:
+		pos=instance->GetRampPosition(g_get_monotonic_time());
+		volReal=instance->GetVolumeAtPosition(pos);
+		if (volReal!=instance->curVolReal)
 		{
-			instance->RampFinished(false);
-			result=FALSE;
+			instance->curVolReal=volReal;
+			instance->SetVolumeReal(volReal);
 		}
-		break;
-
-	case UNMUTING:
-		instance->curVolReal+=instance->volumeStep;
-		if (instance->curVolReal>instance->rangeMax)
-			instance->curVolReal=instance->rangeMax;
-		instance->SetVolumeReal(instance->curVolReal);
-		if (instance->curVolReal==instance->rangeMax)
+		if ((instance->state==MUTING && pos<=0) || (instance->state==UNMUTING && pos>=1))
 		{
 			instance->RampFinished(false);
 			result=FALSE;
@@ -179,6 +344,5 @@ void SourceMuteRampCtrl::RampFinished(bool canceled)
 {
 	this->CleanUpTimer();
 	this->state=IDLE;
-	if (this->listener!=NULL)
-		this->listener->OnRampFinished(canceled);
+	AudioControlThread::Instance()->PostEvent(this, RAMP_EVT_FINISHED, canceled ? 1 : 0, this->rampSeq);
 }
@@ -9,13 +9,16 @@
 #define SRC_AUDIOSOURCES_SOURCEMUTERAMPCTRL_H_
 
 #include "BasicMixerControl.h"
+#include "AudioControlThread.h"
 
 #include <glib.h>
 
 namespace retroradio_controller
 {
 
-class SourceMuteRampCtrl: public BasicMixerControl
+//Ramps are executed by the audio control thread. The public methods are called by the main loop,
+//IMuteRampCtrlListener is notified by the main loop as well.
+class SourceMuteRampCtrl: public BasicMixerControl, public AudioControlThread::IAudioControlHandler
 {
 public:
 	enum RampSpeed
@@ -40,12 +43,51 @@ public:
 	};
 
 private:
-	static const int RAMP_STEP_DELAY_MS[];
+	enum Command
+	{
+		RAMP_CMD_INIT,
+		RAMP_CMD_DEINIT,
+		RAMP_CMD_MUTE,
+		RAMP_CMD_UNMUTE,
+		RAMP_CMD_STOP
+	};
+
+	enum Event
+	{
+		RAMP_EVT_FINISHED
+	};
+
+	static const short *const RAMP_CURVES[];
+
+	static const unsigned int RAMP_CURVE_POINTS[];
+
+	static const unsigned int RAMP_DURATION_MS[];
+
+	//main loop: sequence number of the last request. Finish events of superseded requests are dropped.
+	unsigned int requestSeq;
+
+	//main loop: a ramp has been requested and its finish was not signaled yet
+	bool rampPending;
+
+	//main loop: mixer initialized successfully
+	bool initialized;
+
+	//passed to the audio control thread on init
+	const char *initCardName;
+
+	const char *initMixerName;
 
-	long volumeStep;
+	//audio control thread: request sequence number the running ramp reports back
+	unsigned int rampSeq;
 
+	//audio control thread: last volume written
 	long curVolReal;
 
+	gint64 rampStartTime;
+
+	//ramp position (0: muted, 1: full volume) at rampStartTime
+	double rampStartPos;
+
 	RampSpeed curRampSpeed;
 
 	IMuteRampCtrlListener *listener;
@@ -54,6 +96,14 @@ private:
 
 	guint timerId;
 
+	void StartRamp(State direction, RampSpeed speed);
+
+	double GetRampPosition(gint64 now);
+
+	long GetVolumeAtPosition(double pos);
+
+	double GetPositionFromVolume(long volReal);
+
 	void SetupRampTimer(RampSpeed speed);
 
 	static gboolean OnRampTimerElapsed(gpointer user_data);
@@ -62,6 +112,16 @@ private:
 
 	void RampFinished(bool canceled);
 
+	bool DoInit();
+
+	void DoDeInit();
+
+	void DoMute(RampSpeed speed);
+
+	void DoUnmute(RampSpeed speed);
+
+	void DoStop();
+
 public:
 	SourceMuteRampCtrl(IMuteRampCtrlListener *listener);
 
@@ -77,6 +137,11 @@ public:
 
 	void StopOperation();
 
+	//AudioControlThread::IAudioControlHandler
+	virtual long OnAudioControlCommand(int cmd, long arg, unsigned int tag);
+
+	virtual void OnAudioControlEvent(int event, long arg, unsigned int tag);
+
 };
 
 } /* namespace retroradio_controller */
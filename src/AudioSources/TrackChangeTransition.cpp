@@ -32,16 +32,41 @@ void TrackChangeTransition::StartNew()
 	this->state=RAMPING_DOWN;
 }
 
-bool TrackChangeTransition::OneChangeProcessed()
+int TrackChangeTransition::ResolveTargetTrack(unsigned int currentTrackNo, unsigned int queueLength, bool repeat)
 {
-	if (this->noPendingTrackChanges<0)
-		this->noPendingTrackChanges++;
-	else if (this->noPendingTrackChanges>0)
-		this->noPendingTrackChanges--;
-	else
-		return false;
+	int trackNo=this->PeekTargetTrack(currentTrackNo, queueLength, repeat);
+
+	this->noPendingTrackChanges=0;
+	this->trackNoSelected=_NO_TRACK_SET_;
 
-	return true;
+	return trackNo;
+}
+
+int TrackChangeTransition::PeekTargetTrack(unsigned int currentTrackNo, unsigned int queueLength, bool repeat)
+{
+	int trackNo;
+
+	if (this->trackNoSelected==_NO_TRACK_SET_ && this->noPendingTrackChanges==0)
+		return _NO_TRACK_SET_;
+
+	if (queueLength==0)
+		return _NO_TRACK_SET_;
+
+	trackNo=this->trackNoSelected!=_NO_TRACK_SET_ ? this->trackNoSelected : (int)currentTrackNo;
+	trackNo+=this->noPendingTrackChanges;
+
+	if (repeat)
+	{
+		trackNo%=(int)queueLength;
+		if (trackNo<0)
+			trackNo+=queueLength;
+	}
+	else if (trackNo<0)
+		trackNo=0;
+	else if (trackNo>=(int)queueLength)
+		trackNo=queueLength-1;
+
+	return trackNo;
 }
 
 void TrackChangeTransition::Finalize()
@@ -39,7 +39,13 @@ public:
 
 	void StartNew();
 
-	bool OneChangeProcessed();
+	//consumes the pending selection and next/prev calls and returns the resulting queue position or
+	//_NO_TRACK_SET_ if nothing is pending. Relative changes are applied on top of a selected track.
+	//With repeat the position wraps around at the queue boundaries, otherwise it is limited to them.
+	int ResolveTargetTrack(unsigned int currentTrackNo, unsigned int queueLength, bool repeat);
+
+	//same as ResolveTargetTrack but keeps the pending changes
+	int PeekTargetTrack(unsigned int currentTrackNo, unsigned int queueLength, bool repeat);
 
 	void Finalize();
 
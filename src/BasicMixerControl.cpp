@@ -7,22 +7,32 @@
 
 #include "BasicMixerControl.h"
 
-#include "cpp-app-utils/Logger.h"
-#include <glib-unix.h>
+#include <math.h>
+
+#include "Logging.h"
+#include "LatencyTracer.h"
 
 using namespace CppAppUtils;
 
 namespace retroradio_controller {
 
+std::atomic<unsigned long> BasicMixerControl::alsaCallCnt(0);
+
 BasicMixerControl::BasicMixerControl() :
-		mixerName(NULL),
+		shadowVol(0),
+		shadowValid(false),
+		writePending(false),
+		echoVol(0),
+		echoPending(false),
+		flushSource(NULL),
 		cardName(NULL),
-		mixerElement(NULL),
-		mixerHandle(NULL),
+		mixerName(NULL),
 		rangeMin(0),
 		rangeMax(100),
-		alsaPollEventIds(NULL),
-		alsaPollEventIdsCnt(-1)
+		dbRangeValid(false),
+		dbMin(0),
+		dbMax(0),
+		mixerElement(NULL)
 {
 }
 
@@ -32,168 +42,126 @@ BasicMixerControl::~BasicMixerControl()
 
 bool BasicMixerControl::Init(const char *cardName, const char *mixerName)
 {
-    snd_mixer_selem_id_t *mixerId;
-
-    if (this->mixerHandle!=NULL)
+    if (this->mixerElement!=NULL)
     	this->DeInit();
 
     this->mixerName=mixerName;
     this->cardName=cardName;
+    this->shadowValid=false;
+    this->echoPending=false;
 
-    if (snd_mixer_open(&this->mixerHandle, 0)!=0)
-	{
-		Logger::LogError("Unable to get handle for alsa mixer API.");
-		return false;
-	}
-
-    if (snd_mixer_attach(this->mixerHandle, this->cardName)!=0)
-	{
-		Logger::LogError("Unable to attach handle to card %s.", this->cardName);
-		return false;
-	}
-
-    if (snd_mixer_selem_register(this->mixerHandle, NULL, NULL)!=0)
-	{
-		Logger::LogError("Unable register mixer simple element class.");
-		return false;
-	}
-
-    if (snd_mixer_load(this->mixerHandle)!=0)
-	{
-		Logger::LogError("Unable load mixer element.");
-		return false;
-	}
-
-    snd_mixer_selem_id_alloca(&mixerId);
-
-	snd_mixer_selem_id_set_index(mixerId, 0);
-    snd_mixer_selem_id_set_name(mixerId, this->mixerName);
-    this->mixerElement=snd_mixer_find_selem(this->mixerHandle, mixerId);
-
+    this->mixerElement=AlsaMixerRegistry::Instance()->Acquire(this->cardName, this->mixerName, this);
     if (this->mixerElement == NULL)
-	{
-		Logger::LogError("Unable to find mixer element %s.", this->mixerName);
 		return false;
-	}
-
-	snd_mixer_elem_set_callback_private(this->mixerElement, this);
-	snd_mixer_elem_set_callback(this->mixerElement, OnAlsaMixerEvent);
 
     if (snd_mixer_selem_get_playback_volume_range(this->mixerElement, &this->rangeMin, &this->rangeMax)!=0)
     {
-		Logger::LogInfo("Unable to determine range of mixer: %s. Taking 0 and 100 as range.", this->mixerName);
+		LOG_INFO("Unable to determine range of mixer: %s. Taking 0 and 100 as range.", this->mixerName);
 		this->rangeMin=0;
 		this->rangeMin=100;
     }
 
-    if (!this->SetupAlsaPollFDs())
-    {
-		Logger::LogError("Unable to register alsa event file descriptors for mixer: %s.", this->mixerName);
-		return false;
-    }
+    this->dbRangeValid=snd_mixer_selem_get_playback_dB_range(this->mixerElement, &this->dbMin, &this->dbMax)==0 &&
+    		this->dbMax>this->dbMin;
 
-	Logger::LogDebug("BasicMixerControl::Init() - Initialized mixer %s of card %s. Volume range: %ld-%ld",
+	LOG_DEBUG("BasicMixerControl::Init() - Initialized mixer %s of card %s. Volume range: %ld-%ld",
 			this->mixerName, this->cardName, this->rangeMin, this->rangeMax);
 
 	return true;
 }
 
-gboolean BasicMixerControl::OnAlsaFDEvent(gint fd, GIOCondition condition,
-		gpointer user_data)
+void BasicMixerControl::OnCardRemoved()
 {
-	BasicMixerControl *instance=(BasicMixerControl *)user_data;
-	instance->ProcessAlsaEvent(condition);
-	return TRUE;
+	LOG_ERROR("Sound card of mixer %s removed. Deinitializing mixer.", this->mixerName);
+	this->DeInit();
 }
 
-void BasicMixerControl::ProcessAlsaEvent(GIOCondition condition)
+void BasicMixerControl::OnElementEvent(snd_mixer_elem_t *elem, unsigned int mask)
 {
-	if ((condition & G_IO_ERR)!=0)
+	long mixerVolReal;
+
+	if (mask!=SND_CTL_EVENT_MASK_REMOVE && (mask & SND_CTL_EVENT_MASK_VALUE)!=0 && !this->writePending)
 	{
-		Logger::LogError("Poll FD of mixer %s released with condition==G_IO_ERR. Sound card removed. Deinitializing mixer.",
-				this->mixerName);
-		this->DeInit();
+		//alsa-lib has updated the element already, reading it does not reach the driver
+		if (snd_mixer_selem_get_playback_volume(elem, SND_MIXER_SCHN_FRONT_LEFT, &mixerVolReal)==0)
+		{
+			this->shadowVol=mixerVolReal;
+			this->shadowValid=true;
+
+			if (this->echoPending && mixerVolReal==this->echoVol)
+			{
+				this->echoPending=false;
+				return;
+			}
+		}
+		else
+			this->shadowValid=false;
 	}
-	else if (this->mixerHandle)
-		snd_mixer_handle_events(this->mixerHandle);
+
+	this->OnMixerEvent(mask);
 }
 
-bool BasicMixerControl::SetupAlsaPollFDs()
+void BasicMixerControl::SetVolumeReal(long volReal)
 {
-	struct pollfd *fds = NULL;
-	int count,rc;
-	long mixerVol;
+	if (this->mixerElement==NULL) return;
+
+	if (volReal<this->rangeMin) volReal=rangeMin;
+	if (volReal>this->rangeMax) volReal=rangeMax;
 
-	Logger::LogDebug("BasicMixerControl::SetupAlsaPollFDs() - Setting up alsa event poll fds in main loop.");
+	if (this->shadowValid && this->shadowVol==volReal)
+		return;
 
-	count = snd_mixer_poll_descriptors_count(this->mixerHandle);
-	if (count < 0)
-	{
-		Logger::LogError("snd_mixer_poll_descriptors_count() failed\n");
-		return false;
-	}
+	this->shadowVol=volReal;
+	this->shadowValid=true;
+	this->writePending=true;
 
-	fds = (struct pollfd *)alloca(count*sizeof(struct pollfd));
-	rc = snd_mixer_poll_descriptors (this->mixerHandle, fds, count);
-	if (rc < 0)
+	//written once the current loop iteration is done -> a burst of writes ends up as one
+	if (this->flushSource==NULL)
 	{
-		Logger::LogError("snd_mixer_poll_descriptors() failed\n");
-		return false;
+		this->flushSource=g_idle_source_new();
+		g_source_set_priority(this->flushSource, G_PRIORITY_HIGH);
+		g_source_set_callback(this->flushSource, BasicMixerControl::OnFlushWrites, this, NULL);
+		g_source_attach(this->flushSource, g_main_context_get_thread_default());
 	}
+}
 
-	this->RegisterEventFDs(fds, count);
+gboolean BasicMixerControl::OnFlushWrites(gpointer user_data)
+{
+	BasicMixerControl *instance=(BasicMixerControl *)user_data;
 
-	return true;
+	g_source_unref(instance->flushSource);
+	instance->flushSource=NULL;
+	instance->FlushWrites();
+	return FALSE;
 }
 
-void BasicMixerControl::RegisterEventFDs(struct pollfd *fds, int count)
+void BasicMixerControl::FlushWrites()
 {
-	this->DestroyEventFDs();
+	if (!this->writePending || this->mixerElement==NULL)
+		return;
 
-	this->alsaPollEventIdsCnt=count;
-	this->alsaPollEventIds=new guint[count];
+	this->writePending=false;
 
-	for (int a=0;a<count;a++)
-	{
-	    GIOCondition con=(GIOCondition)fds[a].events; //take care: assumes that glib2.0 uses same bitmask as poll which is currently actually the case
-		Logger::LogDebug("BasicMixerControl::RegisterEventFDs() - Adding poll fd with event mask: 0x%X.", con);
-	    this->alsaPollEventIds[a]=g_unix_fd_add(fds[a].fd,con,BasicMixerControl::OnAlsaFDEvent,this);
-	}
-}
+	LOG_DEBUG("BasicMixerControl::SetVolumeReal - now setting volume to %ld", this->shadowVol);
 
-void BasicMixerControl::DestroyEventFDs()
-{
-	if (this->alsaPollEventIdsCnt!=-1)
+	this->alsaCallCnt.fetch_add(1, std::memory_order_relaxed);
+    if (snd_mixer_selem_set_playback_volume_all(this->mixerElement,this->shadowVol)!=0)
+    {
+		LOG_ERROR("Unable to set volume of mixer %s to mixerVolume %ld",
+				this->mixerName, this->shadowVol);
+		this->shadowValid=false;
+    }
+	else
 	{
-		Logger::LogDebug("BasicMixerControl::DestroyEventFDs() - Removing alsa event fds from main loop.");
-		for (int a=0;a<alsaPollEventIdsCnt;a++)
-			g_source_remove(this->alsaPollEventIds[a]);
-
-		delete this->alsaPollEventIds;
-		this->alsaPollEventIdsCnt=-1;
+		this->echoVol=this->shadowVol;
+		this->echoPending=true;
+		LatencyTracer::Instance()->Mark(LatencyTracer::TRACE_MIXER_WRITE, (int)this->shadowVol);
 	}
 }
 
-int BasicMixerControl::OnAlsaMixerEvent(snd_mixer_elem_t *elem,
-		unsigned int mask)
-{
-	BasicMixerControl *instance=(BasicMixerControl *)snd_mixer_elem_get_callback_private(elem);
-	instance->OnMixerEvent(mask);
-	return 0;
-}
-
-void BasicMixerControl::SetVolumeReal(long volReal)
+unsigned long BasicMixerControl::GetAlsaCallCount()
 {
-	if (this->mixerElement==NULL) return;
-
-	if (volReal<this->rangeMin) volReal=rangeMin;
-	if (volReal>this->rangeMax) volReal=rangeMax;
-
-	Logger::LogDebug("BasicMixerControl::SetVolumeReal - now setting volume to %ld", volReal);
-
-    if (snd_mixer_selem_set_playback_volume_all(this->mixerElement,volReal)!=0)
-		Logger::LogError("Unable to set volume of mixer %s to mixerVolume %ld",
-				this->mixerName, volReal);
+	return BasicMixerControl::alsaCallCnt.load(std::memory_order_relaxed);
 }
 
 void BasicMixerControl::SetVolumeNormalized(int volNorm)
@@ -207,13 +175,19 @@ long BasicMixerControl::GetVolumeReal()
 
 	if (this->mixerElement==NULL) return -1;
 
+	if (this->shadowValid)
+		return this->shadowVol;
+
+	this->alsaCallCnt.fetch_add(1, std::memory_order_relaxed);
 	if (snd_mixer_selem_get_playback_volume(this->mixerElement,
 			SND_MIXER_SCHN_FRONT_LEFT,&mixerVolReal)!=0)
 	{
-		Logger::LogError("Unable to read volume from mixer %s", this->mixerName);
+		LOG_ERROR("Unable to read volume from mixer %s", this->mixerName);
 		return this->rangeMin;
 	}
 
+	this->shadowVol=mixerVolReal;
+	this->shadowValid=true;
 	return mixerVolReal;
 }
 
@@ -230,20 +204,26 @@ int BasicMixerControl::GetVolumeNormalized()
 
 void BasicMixerControl::DeInit()
 {
-	this->DestroyEventFDs();
+	//the last volume set (e.g. mute before closing) still needs to reach the mixer
+	if (this->flushSource!=NULL)
+	{
+		g_source_destroy(this->flushSource);
+		g_source_unref(this->flushSource);
+		this->flushSource=NULL;
+	}
+	this->FlushWrites();
+	this->shadowValid=false;
+	this->echoPending=false;
 
 	if (this->mixerElement!=NULL)
-		snd_mixer_elem_set_callback(this->mixerElement, NULL);
-
-	if (this->mixerHandle!=NULL)
 	{
-	    snd_mixer_close(this->mixerHandle);
+		AlsaMixerRegistry::Instance()->Release(this->mixerElement, this);
 	    this->mixerName=NULL;
 	    this->cardName=NULL;
-	    this->mixerHandle=NULL;
 	    this->mixerElement=NULL;
 	    this->rangeMin=0;
 	    this->rangeMax=100;
+	    this->dbRangeValid=false;
 	}
 }
 
@@ -262,4 +242,20 @@ long BasicMixerControl::PercentToMixerVol(int vol)
 	return this->rangeMin+(vol*(this->rangeMax-this->rangeMin)/100);
 }
 
+long BasicMixerControl::DbToMixerVol(long centiDb)
+{
+	long mixerVol;
+
+	if (this->dbRangeValid)
+	{
+		if (this->dbMax+centiDb<=this->dbMin)
+			return this->rangeMin;
+		if (snd_mixer_selem_ask_playback_dB_vol(this->mixerElement, this->dbMax+centiDb, 1, &mixerVol)==0)
+			return mixerVol;
+	}
+
+	//no dB information -> the raw range is taken as linear amplitude
+	return this->rangeMin+lround((this->rangeMax-this->rangeMin)*pow(10.0, centiDb/2000.0));
+}
+
 } /* namespace retroradio_controller */
@@ -8,30 +8,41 @@
 #ifndef SRC_BASICMIXERCONTROL_H_
 #define SRC_BASICMIXERCONTROL_H_
 
+#include <atomic>
+
 #include <alsa/asoundlib.h>
 #include <glib.h>
 
+#include "AlsaMixerRegistry.h"
+
 namespace retroradio_controller {
 
-class BasicMixerControl {
+//Volume reads are answered from a shadow of the element's volume. Writes within one main loop iteration
+//are coalesced into a single write at its end, writes not changing the volume are dropped.
+//Mixer events caused by our own writes are not passed to OnMixerEvent.
+//The card's mixer is shared with the other controls of the card through the AlsaMixerRegistry.
+class BasicMixerControl : public AlsaMixerRegistry::IElementView {
 
 private:
-	gint alsaPollEventIdsCnt;
+	static std::atomic<unsigned long> alsaCallCnt;
+
+	//volume last written or read, includes a pending write
+	long shadowVol;
 
-	guint *alsaPollEventIds;
+	bool shadowValid;
 
-	static gboolean OnAlsaFDEvent(gint fd,
-            GIOCondition condition, gpointer user_data);
+	bool writePending;
 
-	static int OnAlsaMixerEvent(snd_mixer_elem_t *elem, unsigned int mask);
+	//value of the last write whose mixer event has not been received yet
+	long echoVol;
 
-	void ProcessAlsaEvent(GIOCondition condition);
+	bool echoPending;
 
-	bool SetupAlsaPollFDs();
+	GSource *flushSource;
 
-	void RegisterEventFDs(struct pollfd *fds, int count);
+	static gboolean OnFlushWrites(gpointer user_data);
 
-	void DestroyEventFDs();
+	void FlushWrites();
 
 protected:
 	const char *cardName;
@@ -42,14 +53,22 @@ protected:
 
 	long rangeMax;
 
-    snd_mixer_elem_t* mixerElement;
+	//dB range of the mixer in 0.01 dB, valid if the driver provides it
+	bool dbRangeValid;
+
+	long dbMin;
 
-    snd_mixer_t *mixerHandle;
+	long dbMax;
+
+    snd_mixer_elem_t* mixerElement;
 
     int MixerVolToPercent(long mixerVol);
 
     long PercentToMixerVol(int vol);
 
+    //attenuation in 0.01 dB relative to the maximum volume -> mixer volume
+    long DbToMixerVol(long centiDb);
+
 	virtual void SetVolumeReal(long volReal);
 
 	virtual void SetVolumeNormalized(int volNorm);
@@ -69,6 +88,13 @@ public:
 
 	void DeInit();
 
+	//number of volume reads and writes passed to alsa by all mixers
+	static unsigned long GetAlsaCallCount();
+
+	//AlsaMixerRegistry::IElementView
+	virtual void OnElementEvent(snd_mixer_elem_t *elem, unsigned int mask);
+
+	virtual void OnCardRemoved();
 };
 
 } /* namespace retroradio_controller */
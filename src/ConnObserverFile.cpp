@@ -9,7 +9,7 @@
 
 #include <string.h>
 
-#include "cpp-app-utils/Logger.h"
+#include "Logging.h"
 
 #define CONNECTED_SIGNAL_DIR "/run"
 #define CONNECTED_SIGNAL_PATH "/run/wifi-connected"
@@ -35,13 +35,13 @@ bool ConnObserverFile::Init()
 	GError *err=NULL;
 	GFile *file;
 
-	Logger::LogDebug("ConnObserverFile::Init -> Starting inotify of /run to detect wifi-connected file appearing.");
+	LOG_DEBUG("ConnObserverFile::Init -> Starting inotify of /run to detect wifi-connected file appearing.");
 
 	file=g_file_new_for_path(CONNECTED_SIGNAL_DIR);
 	this->fileMonitor = g_file_monitor_directory(file, G_FILE_MONITOR_NONE, NULL,&err);
 	if (err!=NULL)
 	{
-		Logger::LogError("Unable to observe file %s: %s",CONNECTED_SIGNAL_PATH,err->message);
+		LOG_ERROR("Unable to observe file %s: %s",CONNECTED_SIGNAL_PATH,err->message);
 		g_error_free(err);
 		return false;
 	}
@@ -52,7 +52,7 @@ bool ConnObserverFile::Init()
 	this->connected = g_file_query_exists(file, NULL);
 	g_object_unref(file);
 
-	Logger::LogDebug("ConnObserverFile::Init -> Already connected: %s", this->connected ? "true" : "false");
+	LOG_DEBUG("ConnObserverFile::Init -> Already connected: %s", this->connected ? "true" : "false");
 
 	return true;
 }
@@ -78,10 +78,10 @@ void ConnObserverFile::OnChanges(GFileMonitor *monitor, GFile *file,
 	char *path;
 	ConnObserverFile *instance =(ConnObserverFile *)user_data;
 	path=g_file_get_path(file);
-	Logger::LogDebug("ConnObserverFile::OnChanges -> Signaled file event: %s",path);
+	LOG_DEBUG("ConnObserverFile::OnChanges -> Signaled file event: %s",path);
 	if (strcmp(path,CONNECTED_SIGNAL_PATH)==0)
 	{
-		Logger::LogDebug("ConnObserverFile::OnChanges -> Signaled file creation or remove of %s",
+		LOG_DEBUG("ConnObserverFile::OnChanges -> Signaled file creation or remove of %s",
 			CONNECTED_SIGNAL_PATH);
 		if (event_type==G_FILE_MONITOR_EVENT_CREATED)
 			instance->connected=true;
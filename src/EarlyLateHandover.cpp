@@ -0,0 +1,154 @@
+/*
+ * EarlyLateHandover.cpp
+ *
+ *  Created on: 17.10.2026
+ *      Author: joe
+ */
+
+#include "EarlyLateHandover.h"
+
+#include "Logging.h"
+#include "TimerWheel.h"
+
+#include <glib-unix.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+using namespace CppAppUtils;
+
+using namespace retroradio_controller;
+
+#define HANDOVER_DIR				"/run"
+#define HANDOVER_FILE_NAME			"system_start_complete"
+#define HANDOVER_FILE				HANDOVER_DIR "/" HANDOVER_FILE_NAME
+
+//time the early process gets to exit and remove the handover file
+#define HANDOVER_DEADLINE_MS		1000
+
+EarlyLateHandover::EarlyLateHandover(IHandoverListener *listener) :
+		listener(listener),
+		inotifyFd(-1),
+		inotifyEventId(0),
+		deadlineTimerId(0)
+{
+}
+
+EarlyLateHandover::~EarlyLateHandover()
+{
+	this->CleanUp();
+}
+
+bool EarlyLateHandover::Start()
+{
+	struct stat r;
+	int f;
+
+	LOG_DEBUG("EarlyLateHandover::Start -> Doing hand over handshake with early process.");
+	this->CleanUp();
+
+	//watch is set up before creating the file. Otherwise a fast early process could remove it unnoticed.
+	this->inotifyFd=inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (this->inotifyFd==-1 || inotify_add_watch(this->inotifyFd, HANDOVER_DIR, IN_DELETE)==-1)
+	{
+		LOG_ERROR("Unable to watch %s for the early process hand over: %s", HANDOVER_DIR, strerror(errno));
+		this->CleanUp();
+		return false;
+	}
+
+	//create file /run/system_start_complete to inform rr-early-setup process that system start is complete
+	f=open(HANDOVER_FILE, O_CREAT, 0666);
+	if (f!=-1)
+		close(f);
+
+	this->inotifyEventId=g_unix_fd_add(this->inotifyFd, G_IO_IN, EarlyLateHandover::OnInotifyEvent, this);
+	this->deadlineTimerId=TimerWheel::Instance()->Add(HANDOVER_DEADLINE_MS, TimerWheel::TIMER_SLACK_NORMAL,
+			EarlyLateHandover::OnDeadlineElapsed, this);
+
+	//early process already gone in the meanwhile
+	if (stat(HANDOVER_FILE, &r)!=0)
+		this->Finished(false);
+
+	return true;
+}
+
+bool EarlyLateHandover::IsRunning()
+{
+	return this->deadlineTimerId!=0;
+}
+
+gboolean EarlyLateHandover::OnInotifyEvent(gint fd, GIOCondition condition, gpointer user_data)
+{
+	EarlyLateHandover *instance=(EarlyLateHandover *)user_data;
+
+	if (instance->IsHandoverFileRemoved(fd))
+		instance->Finished(false);
+
+	return TRUE;
+}
+
+bool EarlyLateHandover::IsHandoverFileRemoved(int fd)
+{
+	char buffer[sizeof(struct inotify_event)+NAME_MAX+1] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+	const struct inotify_event *event;
+	ssize_t len;
+	bool removed=false;
+
+	while ((len=read(fd, buffer, sizeof(buffer)))>0)
+	{
+		for (char *ptr=buffer; ptr<buffer+len; ptr+=sizeof(struct inotify_event)+event->len)
+		{
+			event=(const struct inotify_event *)ptr;
+			if (event->len>0 && strcmp(event->name, HANDOVER_FILE_NAME)==0)
+				removed=true;
+		}
+	}
+
+	return removed;
+}
+
+gboolean EarlyLateHandover::OnDeadlineElapsed(gpointer user_data)
+{
+	EarlyLateHandover *instance=(EarlyLateHandover *)user_data;
+
+	// timer itsself is disabled by returning FALSE here.
+	instance->deadlineTimerId=0;
+	LOG_ERROR("Early setup process did not remove file %s within %d ms.", HANDOVER_FILE, HANDOVER_DEADLINE_MS);
+	instance->Finished(true);
+
+	return FALSE;
+}
+
+void EarlyLateHandover::CleanUp()
+{
+	if (this->deadlineTimerId!=0)
+	{
+		TimerWheel::Instance()->Remove(this->deadlineTimerId);
+		this->deadlineTimerId=0;
+	}
+
+	if (this->inotifyEventId!=0)
+	{
+		g_source_remove(this->inotifyEventId);
+		this->inotifyEventId=0;
+	}
+
+	if (this->inotifyFd!=-1)
+	{
+		close(this->inotifyFd);
+		this->inotifyFd=-1;
+	}
+}
+
+void EarlyLateHandover::Finished(bool timedOut)
+{
+	LOG_DEBUG("EarlyLateHandover::Finished -> Hand over with early process %s.", timedOut ? "timed out" : "done");
+	this->CleanUp();
+	if (this->listener!=NULL)
+		this->listener->OnHandoverFinished(timedOut);
+}
@@ -0,0 +1,56 @@
+/*
+ * EarlyLateHandover.h
+ *
+ *  Created on: 17.10.2026
+ *      Author: joe
+ */
+
+#ifndef SRC_EARLYLATEHANDOVER_H_
+#define SRC_EARLYLATEHANDOVER_H_
+
+#include <glib.h>
+
+namespace retroradio_controller {
+
+//Handshake with the early setup process controlling the LEDs during boot. The handover file is created and
+//its removal by the exiting early process is awaited via inotify without blocking the main loop.
+class EarlyLateHandover {
+public:
+	class IHandoverListener
+	{
+	public:
+		virtual void OnHandoverFinished(bool timedOut)=0;
+	};
+
+private:
+	IHandoverListener *listener;
+
+	int inotifyFd;
+
+	guint inotifyEventId;
+
+	guint deadlineTimerId;
+
+	static gboolean OnInotifyEvent(gint fd, GIOCondition condition, gpointer user_data);
+
+	static gboolean OnDeadlineElapsed(gpointer user_data);
+
+	bool IsHandoverFileRemoved(int fd);
+
+	void CleanUp();
+
+	void Finished(bool timedOut);
+
+public:
+	EarlyLateHandover(IHandoverListener *listener);
+
+	virtual ~EarlyLateHandover();
+
+	bool Start();
+
+	bool IsRunning();
+};
+
+} /* namespace retroradio_controller */
+
+#endif /* SRC_EARLYLATEHANDOVER_H_ */
@@ -9,7 +9,8 @@
 
 #include <string.h>
 
-#include "cpp-app-utils/Logger.h"
+#include "Logging.h"
+#include "TimerWheel.h"
 #include "AudioSources/RetroradioAudioSourceList.h"
 
 using namespace retroradio_controller;
@@ -32,7 +33,9 @@ GPIOOutput::BlinkSequence WaitingForWIFIBinkSEQ(0, (const int []){500,500},2);
 
 GPIOController::GPIOController(IBtnListener *btnListener) :
 		btnListener(btnListener),
-		btnEventDelayTimerSet(false)
+		btnEventDelayTimerSet(false),
+		ledsOwned(true),
+		powerLedMode(POWER_OFF)
 {
 	this->powerBtnGPIO=new GPIOInput(PBTN_GPIO_NR, GPIO_EXPORT_TIMEOUT_MS, this);
 	this->powerLedGPIO=new GPIOOutput(POWER_LED_GPIO_NR, GPIO_EXPORT_TIMEOUT_MS, false);
@@ -55,12 +58,16 @@ void GPIOController::CreateSourceGPIOArray()
 	this->sourceLedGPIOs = new SourceLedGPIO[4];
 	this->sourceLedGPIOs[0].SRC_ID=RetroradioAudioSourceList::MPD_SOURCE;
 	this->sourceLedGPIOs[0].srcLedGPIO = new GPIOOutput(MPC_SRC_LED_GPIO_NR, GPIO_EXPORT_TIMEOUT_MS, false);
+	this->sourceLedGPIOs[0].enabled=false;
 	this->sourceLedGPIOs[1].SRC_ID=RetroradioAudioSourceList::DLNA_SOURCE;
 	this->sourceLedGPIOs[1].srcLedGPIO = new GPIOOutput(DLNA_SRC_LED_GPIO_NR, GPIO_EXPORT_TIMEOUT_MS, false);
+	this->sourceLedGPIOs[1].enabled=false;
 	this->sourceLedGPIOs[2].SRC_ID=RetroradioAudioSourceList::LMC_SOURCE;
 	this->sourceLedGPIOs[2].srcLedGPIO = new GPIOOutput(LMC_SRC_LED_GPIO_NR, GPIO_EXPORT_TIMEOUT_MS, false);
+	this->sourceLedGPIOs[2].enabled=false;
 	this->sourceLedGPIOs[3].SRC_ID=NULL;
 	this->sourceLedGPIOs[3].srcLedGPIO=NULL;
+	this->sourceLedGPIOs[3].enabled=false;
 }
 
 void GPIOController::DeleteSourceGPIOArray()
@@ -73,20 +80,20 @@ void GPIOController::DeleteSourceGPIOArray()
 
 bool GPIOController::Init()
 {
-	Logger::LogDebug("GPIOController::Init - Initializing GPIO controller.");
+	LOG_DEBUG("GPIOController::Init - Initializing GPIO controller.");
 	if (!this->ampPowerGPIO->Init())
 	{
-		Logger::LogDebug("Failed to initialize amp gpio (nr: %d)", AMP_POWER_GPIO_NR);
+		LOG_DEBUG("Failed to initialize amp gpio (nr: %d)", AMP_POWER_GPIO_NR);
 		return false;
 	}
 	if (!this->powerLedGPIO->Init())
 	{
-		Logger::LogDebug("Failed to initialize power led gpio (nr: %d)", POWER_LED_GPIO_NR);
+		LOG_DEBUG("Failed to initialize power led gpio (nr: %d)", POWER_LED_GPIO_NR);
 		return false;
 	}
 	if (!this->powerBtnGPIO->Init())
 	{
-		Logger::LogDebug("Failed to initialize power btn gpio (nr: %d)", PBTN_GPIO_NR);
+		LOG_DEBUG("Failed to initialize power btn gpio (nr: %d)", PBTN_GPIO_NR);
 		return false;
 	}
 
@@ -94,7 +101,7 @@ bool GPIOController::Init()
 	{
 		if (!this->sourceLedGPIOs[a].srcLedGPIO->Init())
 		{
-			Logger::LogDebug("Failed to source led gpio for source: %s", this->sourceLedGPIOs[a].SRC_ID);
+			LOG_DEBUG("Failed to source led gpio for source: %s", this->sourceLedGPIOs[a].SRC_ID);
 			return false;
 		}
 	}
@@ -108,14 +115,21 @@ void GPIOController::DeInit()
 
 void GPIOController::SetPowerLedMode(
 		PowerLedMode powerLedMode)
+{
+	this->powerLedMode=powerLedMode;
+	if (this->ledsOwned)
+		this->ApplyPowerLedMode();
+}
+
+void GPIOController::ApplyPowerLedMode()
 {
 	if (this->powerLedGPIO == NULL) return;
 
-	if (powerLedMode==POWER_OFF)
+	if (this->powerLedMode==POWER_OFF)
 		this->powerLedGPIO->SetModeConstantValue(false);
-	else if (powerLedMode==POWER_ON)
+	else if (this->powerLedMode==POWER_ON)
 		this->powerLedGPIO->SetModeConstantValue(true);
-	else if (powerLedMode==WAITING_FOR_WIFI)
+	else if (this->powerLedMode==WAITING_FOR_WIFI)
 		this->powerLedGPIO->SetModeBlinking(&WaitingForWIFIBinkSEQ);
 }
 
@@ -126,7 +140,9 @@ void GPIOController::SetSourceLedEnabled(
 	{
 		if (strcmp(this->sourceLedGPIOs[a].SRC_ID, sourceID)==0)
 		{
-			this->sourceLedGPIOs[a].srcLedGPIO->SetModeConstantValue(enabled);
+			this->sourceLedGPIOs[a].enabled=enabled;
+			if (this->ledsOwned)
+				this->sourceLedGPIOs[a].srcLedGPIO->SetModeConstantValue(enabled);
 			break;
 		}
 	}
@@ -135,7 +151,24 @@ void GPIOController::SetSourceLedEnabled(
 void GPIOController::DisableSourcesLeds()
 {
 	for (int a=0; this->sourceLedGPIOs[a].srcLedGPIO!=NULL; a++)
-		this->sourceLedGPIOs[a].srcLedGPIO->SetModeConstantValue(false);
+	{
+		this->sourceLedGPIOs[a].enabled=false;
+		if (this->ledsOwned)
+			this->sourceLedGPIOs[a].srcLedGPIO->SetModeConstantValue(false);
+	}
+}
+
+void GPIOController::SetLedsOwned(bool owned)
+{
+	LOG_DEBUG("GPIOController::SetLedsOwned - Leds %s.", owned ? "taken over" : "released");
+	this->ledsOwned=owned;
+	if (!owned)
+		return;
+
+	//apply what was requested while the leds were driven by someone else
+	this->ApplyPowerLedMode();
+	for (int a=0; this->sourceLedGPIOs[a].srcLedGPIO!=NULL; a++)
+		this->sourceLedGPIOs[a].srcLedGPIO->SetModeConstantValue(this->sourceLedGPIOs[a].enabled);
 }
 
 void GPIOController::SetAmpEnabled(bool enabled)
@@ -149,7 +182,8 @@ void GPIOController::OnValueChanged(GPIOInput* gpio, bool value)
 	//ignore events within the timer interval after the first event was received
 	if (!this->btnEventDelayTimerSet)
 	{
-		g_timeout_add(PWR_BTN_EVENT_DELAY, GPIOController::OnPwrBtnEventDelayElapsed, this);
+		TimerWheel::Instance()->Add(PWR_BTN_EVENT_DELAY, TimerWheel::TIMER_SLACK_NORMAL,
+				GPIOController::OnPwrBtnEventDelayElapsed, this);
 		this->btnEventDelayTimerSet=true;
 	}
 }
@@ -167,7 +201,7 @@ gboolean GPIOController::OnPwrBtnEventDelayElapsed(
 void GPIOController::EvaluatePwrBtnStateAfterEventTimeout()
 {
 	bool value=this->powerBtnGPIO->GetValue();
-	Logger::LogDebug("GPIOController::EvaluatePwrBtnStateAfterEventTimeout - Received power button event. GPIO Value: %d", value);
+	LOG_DEBUG("GPIOController::EvaluatePwrBtnStateAfterEventTimeout - Received power button event. GPIO Value: %d", value);
 	if (this->btnListener!=NULL)
 	{
 		if (value)
@@ -38,6 +38,7 @@ private:
 	{
 		const char *SRC_ID;
 		GPIOOutput *srcLedGPIO;
+		bool enabled;
 	} SourceLedGPIO;
 
 	bool btnEventDelayTimerSet;
@@ -52,6 +53,13 @@ private:
 
 	IBtnListener *btnListener;
 
+	//false while another process still drives the leds. Requested led states are applied when owned again.
+	bool ledsOwned;
+
+	PowerLedMode powerLedMode;
+
+	void ApplyPowerLedMode();
+
 	void CreateSourceGPIOArray();
 
 	void DeleteSourceGPIOArray();
@@ -75,6 +83,8 @@ public:
 
 	void DisableSourcesLeds();
 
+	void SetLedsOwned(bool owned);
+
 	void SetAmpEnabled(bool enabled);
 
 	virtual void OnValueChanged(GPIOInput *gpio, bool value);
@@ -0,0 +1,173 @@
+/*
+ * LatencyTracer.cpp
+ *
+ *  Created on: 17.10.2026
+ *      Author: joe
+ */
+
+#include "LatencyTracer.h"
+
+#include <stdio.h>
+#include <errno.h>
+#include <string.h>
+
+#include "Logging.h"
+
+using namespace CppAppUtils;
+
+using namespace retroradio_controller;
+
+//marks arriving later than this after the key press are not attributed to it anymore
+#define LATENCY_TRACE_SPAN_TIMEOUT_US		(5*G_USEC_PER_SEC)
+
+LatencyTracer *LatencyTracer::instance=NULL;
+
+const char *LatencyTracer::eventNames[__TRACE_EVENT_TYPE_CNT__]=
+	{
+		"ir_scancode",
+		"cmd_received",
+		"mixer_write",
+		"mpd_cmd_finished",
+		"ramp_finished"
+	};
+
+LatencyTracer::LatencyTracer() :
+		writeSeq(0),
+		currentSpanId(0),
+		currentSpanMarks(0),
+		currentSpanStartUs(0)
+{
+	for (unsigned int a=0; a<LATENCY_TRACE_RING_SIZE; a++)
+		this->events[a].seq.store(0, std::memory_order_relaxed);
+}
+
+LatencyTracer::~LatencyTracer()
+{
+}
+
+LatencyTracer *LatencyTracer::Instance()
+{
+	if (LatencyTracer::instance==NULL)
+		LatencyTracer::instance=new LatencyTracer();
+
+	return LatencyTracer::instance;
+}
+
+void LatencyTracer::Record(unsigned int spanId, TraceEventType type, int arg, gint64 timestampUs)
+{
+	unsigned int seq=this->writeSeq.fetch_add(1, std::memory_order_relaxed);
+	TraceEvent *event=&this->events[seq%LATENCY_TRACE_RING_SIZE];
+
+	//seq 0 marks an empty slot -> slots store seq+1
+	event->seq.store(0, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	event->spanId=spanId;
+	event->type=type;
+	event->arg=arg;
+	event->timestampUs=timestampUs;
+	event->seq.store(seq+1, std::memory_order_release);
+}
+
+void LatencyTracer::BeginSpan(guint64 kernelTimestampNs, int cmd)
+{
+	gint64 startUs=(gint64)(kernelTimestampNs/1000);
+	unsigned int spanId=this->currentSpanId.load(std::memory_order_relaxed)+1;
+
+	//lirc stamps with CLOCK_MONOTONIC like g_get_monotonic_time. Fall back to now for drivers not stamping.
+	if (kernelTimestampNs==0)
+		startUs=g_get_monotonic_time();
+
+	this->Record(spanId, TRACE_SPAN_BEGIN, cmd, startUs);
+
+	this->currentSpanMarks.store(0, std::memory_order_relaxed);
+	this->currentSpanStartUs.store(startUs, std::memory_order_relaxed);
+	this->currentSpanId.store(spanId, std::memory_order_release);
+}
+
+void LatencyTracer::Mark(TraceEventType type, int arg)
+{
+	unsigned int spanId=this->currentSpanId.load(std::memory_order_acquire);
+	gint64 now=g_get_monotonic_time();
+	unsigned int typeBit=1u << type;
+
+	if (spanId==0) return;
+	if (now-this->currentSpanStartUs.load(std::memory_order_relaxed) > LATENCY_TRACE_SPAN_TIMEOUT_US) return;
+
+	//a track change ramps down and up again -> all ramps are of interest
+	if (type!=TRACE_RAMP_FINISHED &&
+			(this->currentSpanMarks.fetch_or(typeBit, std::memory_order_relaxed) & typeBit)!=0)
+		return;
+
+	this->Record(spanId, type, arg, now);
+}
+
+bool LatencyTracer::DumpChromeTrace(const char *path)
+{
+	TraceEvent *snapshot;
+	unsigned int snapshotCnt=0;
+	unsigned int endSeq=this->writeSeq.load(std::memory_order_acquire);
+	unsigned int startSeq=endSeq>LATENCY_TRACE_RING_SIZE ? endSeq-LATENCY_TRACE_RING_SIZE : 0;
+	unsigned int beginSpanId=0;
+	bool first=true;
+	FILE *f;
+
+	snapshot=g_new(TraceEvent, LATENCY_TRACE_RING_SIZE);
+
+	//copy consistent slots only. Slots currently written or overwritten meanwhile are skipped.
+	for (unsigned int seq=startSeq; seq!=endSeq; seq++)
+	{
+		TraceEvent *event=&this->events[seq%LATENCY_TRACE_RING_SIZE];
+		TraceEvent *copy=&snapshot[snapshotCnt];
+
+		if (event->seq.load(std::memory_order_acquire)!=seq+1) continue;
+		copy->spanId=event->spanId;
+		copy->type=event->type;
+		copy->arg=event->arg;
+		copy->timestampUs=event->timestampUs;
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (event->seq.load(std::memory_order_relaxed)!=seq+1) continue;
+
+		snapshotCnt++;
+	}
+
+	f=fopen(path, "w");
+	if (f==NULL)
+	{
+		LOG_ERROR("Failed to open latency trace file %s: %s", path, strerror(errno));
+		g_free(snapshot);
+		return false;
+	}
+
+	fprintf(f, "{\"traceEvents\":[\n");
+
+	//events of a span are recorded contiguously. Spans whose begin has already been overwritten are dropped.
+	for (unsigned int a=0; a<snapshotCnt; a++)
+	{
+		TraceEvent *event=&snapshot[a];
+
+		if (event->type==TRACE_SPAN_BEGIN)
+			beginSpanId=event->spanId;
+		else if (event->spanId!=beginSpanId)
+			continue;
+
+		fprintf(f, "%s{\"name\":\"%s\",\"cat\":\"ir\",\"ph\":\"%s\",\"id\":%u,\"pid\":1,\"tid\":1,"
+				"\"ts\":%" G_GINT64_FORMAT ",\"args\":{\"arg\":%d}}",
+				first ? "" : ",\n",
+				event->type==TRACE_SPAN_BEGIN ? "keypress" : LatencyTracer::eventNames[event->type],
+				event->type==TRACE_SPAN_BEGIN ? "b" : "n",
+				event->spanId, event->timestampUs, event->arg);
+		first=false;
+
+		if (a+1==snapshotCnt || snapshot[a+1].spanId!=beginSpanId)
+			fprintf(f, ",\n{\"name\":\"keypress\",\"cat\":\"ir\",\"ph\":\"e\",\"id\":%u,\"pid\":1,\"tid\":1,"
+					"\"ts\":%" G_GINT64_FORMAT "}",
+					event->spanId, event->timestampUs);
+	}
+
+	fprintf(f, "\n]}\n");
+	fclose(f);
+	g_free(snapshot);
+
+	LOG_INFO("Dumped %u latency trace events to %s.", snapshotCnt, path);
+	return true;
+}
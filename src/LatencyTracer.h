@@ -0,0 +1,84 @@
+/*
+ * LatencyTracer.h
+ *
+ *  Created on: 17.10.2026
+ *      Author: joe
+ */
+
+#ifndef SRC_LATENCYTRACER_H_
+#define SRC_LATENCYTRACER_H_
+
+#include <atomic>
+
+#include <glib.h>
+
+namespace retroradio_controller {
+
+#define LATENCY_TRACE_RING_SIZE		1024
+
+#define LATENCY_TRACE_DUMP_PATH		"/tmp/retroradio-trace.json"
+
+//Records the way of a remote control key press through the controller. A span is opened at the kernel
+//timestamp of the received scan code, the stages reached afterwards are recorded as marks of the latest span.
+//Events are kept in a fixed ring which overwrites the oldest entries and can be dumped as chrome trace json.
+class LatencyTracer {
+public:
+	enum TraceEventType
+	{
+		TRACE_SPAN_BEGIN,
+		TRACE_CMD_RECEIVED,
+		TRACE_MIXER_WRITE,
+		TRACE_MPD_CMD_FINISHED,
+		TRACE_RAMP_FINISHED,
+		__TRACE_EVENT_TYPE_CNT__
+	};
+
+private:
+	typedef struct TraceEvent
+	{
+		//sequence number of the write which filled the slot. Published last, so a reader can detect
+		//slots currently being written or already overwritten.
+		std::atomic<unsigned int> seq;
+		unsigned int spanId;
+		TraceEventType type;
+		int arg;
+		gint64 timestampUs;
+	} TraceEvent;
+
+	static LatencyTracer *instance;
+
+	static const char *eventNames[__TRACE_EVENT_TYPE_CNT__];
+
+	TraceEvent events[LATENCY_TRACE_RING_SIZE];
+
+	std::atomic<unsigned int> writeSeq;
+
+	std::atomic<unsigned int> currentSpanId;
+
+	//types already recorded for the current span. Mixer writes and command completions are
+	//only of interest the first time after a key press, ramp steps would flood the ring otherwise.
+	std::atomic<unsigned int> currentSpanMarks;
+
+	std::atomic<gint64> currentSpanStartUs;
+
+	void Record(unsigned int spanId, TraceEventType type, int arg, gint64 timestampUs);
+
+	LatencyTracer();
+
+public:
+	virtual ~LatencyTracer();
+
+	static LatencyTracer *Instance();
+
+	//opens a new span at the given CLOCK_MONOTONIC timestamp in ns as delivered by the lirc driver
+	void BeginSpan(guint64 kernelTimestampNs, int cmd);
+
+	//records the given stage for the current span unless the span is closed already
+	void Mark(TraceEventType type, int arg=0);
+
+	bool DumpChromeTrace(const char *path);
+};
+
+} /* namespace retroradio_controller */
+
+#endif /* SRC_LATENCYTRACER_H_ */
@@ -0,0 +1,23 @@
+/*
+ * Logging.cpp
+ *
+ *  Created on: 17.10.2026
+ *      Author: joe
+ */
+
+#include "Logging.h"
+
+using namespace CppAppUtils;
+
+using namespace retroradio_controller;
+
+//everything is passed to the logger until the level is known
+Logger::LogLevel LogLevelCache::level=Logger::DEBUG;
+
+void LogLevelCache::Refresh()
+{
+	if (AsyncLogger::IsCapturingHistory())
+		LogLevelCache::level=Logger::DEBUG;
+	else
+		LogLevelCache::level=Logger::GetLogLevel();
+}
@@ -0,0 +1,74 @@
+/*
+ * Logging.h
+ *
+ *  Created on: 17.10.2026
+ *      Author: joe
+ */
+
+#ifndef SRC_LOGGING_H_
+#define SRC_LOGGING_H_
+
+#include <cpp-app-utils/Logger.h>
+
+#include "AsyncLogger.h"
+
+//lowest level compiled in: 0 = error, 1 = info, 2 = debug. Set via configure --with-log-floor.
+#ifndef RETRORADIO_LOG_FLOOR
+#define RETRORADIO_LOG_FLOOR		2
+#endif
+
+#define RETRORADIO_LOG_FLOOR_INFO	1
+#define RETRORADIO_LOG_FLOOR_DEBUG	2
+
+namespace retroradio_controller {
+
+//Copy of the logger's level. Log sites check it before evaluating their arguments, so disabled debug
+//messages cost a compare only. Log sites below the compile time floor are removed completely.
+//While the asynchronous backend keeps an error history, all levels are captured.
+class LogLevelCache {
+private:
+	static CppAppUtils::Logger::LogLevel level;
+
+public:
+	//to be called whenever the logger's level might have changed
+	static void Refresh();
+
+	static inline CppAppUtils::Logger::LogLevel Get()
+	{
+		return LogLevelCache::level;
+	}
+};
+
+} /* namespace retroradio_controller */
+
+//passes the message to the asynchronous backend if it runs. Each log site owns its rate limit state.
+//Non blocking threads never write synchronously. While the backend is stopped only their errors are written.
+#define LOG_DISPATCH(lvl, logFunc, ...)																\
+	do {																							\
+		static ::retroradio_controller::AsyncLogger::LogSite logSite;								\
+		if (::retroradio_controller::AsyncLogger::IsRunning())										\
+			::retroradio_controller::AsyncLogger::Record(&logSite, CppAppUtils::Logger::lvl, __VA_ARGS__);	\
+		else if (::retroradio_controller::AsyncLogger::IsCallingThreadNonBlocking())				\
+			::retroradio_controller::AsyncLogger::RecordUnbuffered(CppAppUtils::Logger::lvl, __VA_ARGS__);	\
+		else																						\
+			CppAppUtils::Logger::logFunc(__VA_ARGS__);												\
+	} while (0)
+
+#define LOG_DEBUG(...)																	\
+	do {																				\
+		if (RETRORADIO_LOG_FLOOR>=RETRORADIO_LOG_FLOOR_DEBUG &&							\
+				::retroradio_controller::LogLevelCache::Get()>=CppAppUtils::Logger::DEBUG)	\
+			LOG_DISPATCH(DEBUG, LogDebug, __VA_ARGS__);									\
+	} while (0)
+
+#define LOG_INFO(...)																	\
+	do {																				\
+		if (RETRORADIO_LOG_FLOOR>=RETRORADIO_LOG_FLOOR_INFO &&							\
+				::retroradio_controller::LogLevelCache::Get()>=CppAppUtils::Logger::INFO)	\
+			LOG_DISPATCH(INFO, LogInfo, __VA_ARGS__);									\
+	} while (0)
+
+//errors are always logged
+#define LOG_ERROR(...)	LOG_DISPATCH(ERROR, LogError, __VA_ARGS__)
+
+#endif /* SRC_LOGGING_H_ */
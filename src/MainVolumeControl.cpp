@@ -7,7 +7,7 @@
 
 #include "MainVolumeControl.h"
 
-#include "cpp-app-utils/Logger.h"
+#include "Logging.h"
 #include "RetroradioController.h"
 
 using namespace CppAppUtils;
@@ -19,16 +19,14 @@ using namespace CppAppUtils;
 #define	CONFIG_TAG_SNDCARD_NAME		"SndCardName"
 #define DEFAULT_SND_CARD_NAME		"default"
 
-#define NUMBER_VOL_STEPS			100
-
 namespace retroradio_controller {
 
 MainVolumeControl::MainVolumeControl(Configuration *configuration) :
 		BasicMixerControl(),
 		currentVolReal(0),
-		sndCardName(NULL),
+		repeatEngine(this),
 		mainMixerName(NULL),
-		volumeStep(0)
+		sndCardName(NULL)
 
 {
 	configuration->AddConfigurationModule(this);
@@ -43,16 +41,27 @@ MainVolumeControl::~MainVolumeControl()
 }
 
 bool MainVolumeControl::Init()
+{
+	long persistedVolume=RetroradioController::Instance()->GetPersistentState()->GetMasterVolume();
+
+	return AudioControlThread::Instance()->Invoke(this, VOL_CMD_INIT, persistedVolume)!=0;
+}
+
+void MainVolumeControl::DeInit()
+{
+	AudioControlThread::Instance()->Invoke(this, VOL_CMD_DEINIT, 0);
+}
+
+bool MainVolumeControl::DoInit(long persistedVolume)
 {
 	if (!BasicMixerControl::Init(this->ConfigGetCardName(), this->ConfigGetMixerName()))
 		return false;
 
-	this->currentVolReal=this->PercentToMixerVol(RetroradioController::Instance()->GetPersistentState()->GetMasterVolume());
+	this->currentVolReal=this->PercentToMixerVol(persistedVolume);
 	this->SetVolumeReal(this->currentVolReal);
 
-	this->volumeStep=(this->rangeMax-this->rangeMin)/NUMBER_VOL_STEPS;
-	if (this->volumeStep==0)
-		this->volumeStep=1;
+	this->repeatEngine.Start(AudioControlThread::Instance()->GetTimerWheel(), this->rangeMin, this->rangeMax,
+			this->currentVolReal);
 
 	return true;
 }
@@ -60,54 +69,99 @@ bool MainVolumeControl::Init()
 
 void MainVolumeControl::VolumeUp()
 {
-	this->currentVolReal+=this->volumeStep;
-	if (this->currentVolReal > this->rangeMax)
-		this->currentVolReal = this->rangeMax;
+	AudioControlThread::Instance()->Post(this, VOL_CMD_UP, 0);
+}
 
-	Logger::LogDebug("MainVolumeControl::VolumeUp -> Audio Controller requested to increase volume to %ld.", this->currentVolReal);
+void MainVolumeControl::VolumeDown()
+{
+	AudioControlThread::Instance()->Post(this, VOL_CMD_DOWN, 0);
+}
 
-	RetroradioController::Instance()->GetPersistentState()->SetMasterVolume(this->currentVolReal);
+void MainVolumeControl::OnVolumeKey(bool up)
+{
+	this->repeatEngine.OnKey(up);
+}
+
+void MainVolumeControl::OnSlewVolume(long volume)
+{
+	this->currentVolReal=volume;
 	BasicMixerControl::SetVolumeReal(this->currentVolReal);
 }
 
-void MainVolumeControl::VolumeDown()
+void MainVolumeControl::OnVolumeSettled(long volume)
 {
-	this->currentVolReal-=this->volumeStep;
-	if (this->currentVolReal < this->rangeMin)
-		this->currentVolReal = this->rangeMin;
+	LOG_DEBUG("MainVolumeControl::OnVolumeSettled -> Volume settled at %ld.", volume);
+	AudioControlThread::Instance()->PostEvent(this, VOL_EVT_CHANGED, volume);
+}
 
-	Logger::LogDebug("MainVolumeControl::VolumeDown -> Audio Controller requested to decrease volume to %ld.", this->currentVolReal);
-	RetroradioController::Instance()->GetPersistentState()->SetMasterVolume(this->currentVolReal);
-	BasicMixerControl::SetVolumeReal(this->currentVolReal);
+long MainVolumeControl::OnAudioControlCommand(int cmd, long arg, unsigned int tag)
+{
+	switch((Command)cmd)
+	{
+	case VOL_CMD_INIT:
+		return this->DoInit(arg) ? 1 : 0;
+
+	case VOL_CMD_DEINIT:
+		this->repeatEngine.Finish();
+		this->repeatEngine.Stop();
+		BasicMixerControl::DeInit();
+		break;
+
+	case VOL_CMD_UP:
+		this->repeatEngine.OnKey(true);
+		break;
+
+	case VOL_CMD_DOWN:
+		this->repeatEngine.OnKey(false);
+		break;
+
+	case VOL_CMD_MUTE:
+		LOG_DEBUG("MainVolumeControl::Mute -> Main volume control requested to mute.");
+		this->repeatEngine.Finish();
+		BasicMixerControl::SetVolumeReal(this->rangeMin);
+		break;
+
+	case VOL_CMD_UNMUTE:
+		LOG_DEBUG("MainVolumeControl::UnMute -> Main volume control requested to unmute.");
+		BasicMixerControl::SetVolumeReal(this->currentVolReal);
+		break;
+	}
+
+	return 0;
+}
+
+void MainVolumeControl::OnAudioControlEvent(int event, long arg, unsigned int tag)
+{
+	if (event==VOL_EVT_CHANGED)
+		RetroradioController::Instance()->GetPersistentState()->SetMasterVolume(arg);
 }
 
 void MainVolumeControl::OnMixerEvent(unsigned int mask)
 {
-	Logger::LogDebug("MainVolumeControl::OnMixerEvent -> Received mixer event. Mask: %d", mask);
+	LOG_DEBUG("MainVolumeControl::OnMixerEvent -> Received mixer event. Mask: %d", mask);
 
 	long curVolAlsaReal;
 	curVolAlsaReal=this->GetVolumeReal();
 
 	if (this->currentVolReal!=curVolAlsaReal)
 	{
-		Logger::LogDebug("MainVolumeControl::OnMixerEvent -> Mixer volume changed to %ld. Writing it again.", curVolAlsaReal);
+		LOG_DEBUG("MainVolumeControl::OnMixerEvent -> Mixer volume changed to %ld. Writing it again.", curVolAlsaReal);
 		this->currentVolReal=curVolAlsaReal;
+		this->repeatEngine.SetVolume(this->currentVolReal);
 		//do not write 0 to file -> Not store mute state, 0 received in case of remove sound card
 		if (this->currentVolReal != this->rangeMin)
-			RetroradioController::Instance()->GetPersistentState()->SetMasterVolume(this->currentVolReal);
+			AudioControlThread::Instance()->PostEvent(this, VOL_EVT_CHANGED, this->currentVolReal);
 	}
 }
 
 void MainVolumeControl::Mute()
 {
-	Logger::LogDebug("MainVolumeControl::Mute -> Main volume control requested to mute.");
-	BasicMixerControl::SetVolumeReal(this->rangeMin);
+	AudioControlThread::Instance()->Post(this, VOL_CMD_MUTE, 0);
 }
 
 void MainVolumeControl::UnMute()
 {
-	Logger::LogDebug("MainVolumeControl::UnMute -> Main volume control requested to unmute.");
-	BasicMixerControl::SetVolumeReal(this->currentVolReal);
+	AudioControlThread::Instance()->Post(this, VOL_CMD_UNMUTE, 0);
 }
 
 const char* MainVolumeControl::ConfigGetMixerName()
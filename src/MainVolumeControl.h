@@ -9,6 +9,8 @@
 #define SRC_MAINVOLUMECONTROL_H_
 
 #include "BasicMixerControl.h"
+#include "AudioControlThread.h"
+#include "VolumeRepeatEngine.h"
 #include "cpp-app-utils/Configuration.h"
 
 using namespace CppAppUtils;
@@ -19,18 +21,38 @@ namespace retroradio_controller {
 #define MASTER_VOL_MAX			37
 #define MASTER_VOL_MIN			0
 
+//The mixer is driven by the audio control thread. Volume keys move a target the mixer slews to, the volume
+//is persisted by the main loop once the key is released.
 class MainVolumeControl : public BasicMixerControl,
-	public Configuration::IConfigurationParserModule
+	public Configuration::IConfigurationParserModule, public AudioControlThread::IAudioControlHandler,
+	public AudioControlThread::IVolumeKeyHandler, public VolumeRepeatEngine::IVolumeSink
 {
 private:
-	long volumeStep;
+	enum Command
+	{
+		VOL_CMD_INIT,
+		VOL_CMD_DEINIT,
+		VOL_CMD_UP,
+		VOL_CMD_DOWN,
+		VOL_CMD_MUTE,
+		VOL_CMD_UNMUTE
+	};
+
+	enum Event
+	{
+		VOL_EVT_CHANGED
+	};
 
 	long currentVolReal;
 
+	VolumeRepeatEngine repeatEngine;
+
 	char *mainMixerName;
 
 	char *sndCardName;
 
+	bool DoInit(long persistedVolume);
+
 protected:
 	virtual void OnMixerEvent(unsigned int mask);
 
@@ -41,6 +63,8 @@ public:
 
 	virtual bool Init();
 
+	void DeInit();
+
 	void VolumeUp();
 
 	void VolumeDown();
@@ -56,6 +80,19 @@ public:
 	virtual bool ParseConfigFileItem(GKeyFile *confFile, const char *group, const char *key);
 
 	virtual bool IsConfigFileGroupKnown(const char *group);
+
+	//AudioControlThread::IAudioControlHandler
+	virtual long OnAudioControlCommand(int cmd, long arg, unsigned int tag);
+
+	virtual void OnAudioControlEvent(int event, long arg, unsigned int tag);
+
+	//AudioControlThread::IVolumeKeyHandler
+	virtual void OnVolumeKey(bool up);
+
+	//VolumeRepeatEngine::IVolumeSink
+	virtual void OnSlewVolume(long volume);
+
+	virtual void OnVolumeSettled(long volume);
 };
 
 } /* namespace retroradio_controller */
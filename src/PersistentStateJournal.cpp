@@ -0,0 +1,278 @@
+/*
+ * PersistentStateJournal.cpp
+ *
+ *  Created on: 17.10.2026
+ *      Author: joe
+ */
+
+#include "PersistentStateJournal.h"
+
+#include "Logging.h"
+
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+using namespace CppAppUtils;
+
+using namespace retroradio_controller;
+
+#define JOURNAL_RECORD_MAGIC	0x4A525452	//"RTRJ"
+
+PersistentStateJournal::PersistentStateJournal() :
+		fd(-1),
+		slotCnt(0),
+		nextSlot(0),
+		nextSequence(1),
+		newestValid(false),
+		newestSlot(0),
+		slotBuffer(NULL),
+		appendCnt(0),
+		wrapCnt(0),
+		invalidSlotCnt(0)
+{
+}
+
+PersistentStateJournal::~PersistentStateJournal()
+{
+	this->Close();
+}
+
+bool PersistentStateJournal::Open(const char *path, size_t journalSize)
+{
+	struct stat fileStat;
+
+	this->Close();
+
+	this->fd=open(path, O_RDWR | O_CREAT | O_DSYNC | O_CLOEXEC, S_IRUSR | S_IWUSR);
+	if (this->fd==-1)
+	{
+		LOG_ERROR("Unable to open state journal %s: %s", path, strerror(errno));
+		return false;
+	}
+
+	if (fstat(this->fd, &fileStat)==0 && S_ISBLK(fileStat.st_mode))
+	{
+		off_t deviceSize=lseek(this->fd, 0, SEEK_END);
+
+		if (deviceSize>=0 && (size_t)deviceSize<journalSize)
+			journalSize=(size_t)deviceSize;
+	}
+
+	//the newest record must never be the one overwritten
+	this->slotCnt=journalSize/JOURNAL_SLOT_SIZE;
+	if (this->slotCnt<2)
+	{
+		LOG_ERROR("State journal %s too small. At least %u bytes required.", path, 2*JOURNAL_SLOT_SIZE);
+		this->Close();
+		return false;
+	}
+
+	this->slotBuffer=(unsigned char *)g_malloc0(JOURNAL_SLOT_SIZE);
+
+	//a reopened journal must not start over at its first slot and sequence
+	this->Scan();
+
+	LOG_DEBUG("PersistentStateJournal::Open - Opened state journal %s with %u slots.", path, this->slotCnt);
+	return true;
+}
+
+void PersistentStateJournal::Close()
+{
+	if (this->fd!=-1)
+		close(this->fd);
+	this->fd=-1;
+
+	g_free(this->slotBuffer);
+	this->slotBuffer=NULL;
+	this->slotCnt=0;
+	this->newestValid=false;
+}
+
+bool PersistentStateJournal::IsOpen()
+{
+	return this->fd!=-1;
+}
+
+guint32 PersistentStateJournal::Crc32(guint32 crc, const void *data, size_t size)
+{
+	const unsigned char *itr=(const unsigned char *)data;
+
+	//records are a few hundred bytes -> no table needed
+	crc=~crc;
+	while (size--)
+	{
+		crc^=*itr++;
+		for (int bit=0; bit<8; bit++)
+			crc=(crc>>1) ^ (0xEDB88320 & (0-(crc & 1)));
+	}
+
+	return ~crc;
+}
+
+guint32 PersistentStateJournal::CalcRecordCrc(const RecordHeader *header, const void *payload)
+{
+	RecordHeader crcHeader=*header;
+	guint32 crc;
+
+	crcHeader.crc=0;
+	crc=PersistentStateJournal::Crc32(0, &crcHeader, sizeof(crcHeader));
+	return PersistentStateJournal::Crc32(crc, payload, header->payloadSize);
+}
+
+size_t PersistentStateJournal::GetMaxPayloadSize()
+{
+	return JOURNAL_SLOT_SIZE-sizeof(RecordHeader);
+}
+
+size_t PersistentStateJournal::GetRecordSize(size_t payloadSize)
+{
+	return sizeof(RecordHeader)+payloadSize;
+}
+
+bool PersistentStateJournal::ReadSlot(unsigned int slot, RecordHeader *header)
+{
+	if (pread(this->fd, this->slotBuffer, JOURNAL_SLOT_SIZE, (off_t)slot*JOURNAL_SLOT_SIZE)!=JOURNAL_SLOT_SIZE)
+		return false;
+
+	memcpy(header, this->slotBuffer, sizeof(RecordHeader));
+	if (header->magic!=JOURNAL_RECORD_MAGIC || header->payloadSize>PersistentStateJournal::GetMaxPayloadSize())
+		return false;
+
+	return PersistentStateJournal::CalcRecordCrc(header, this->slotBuffer+sizeof(RecordHeader))==header->crc;
+}
+
+void PersistentStateJournal::Scan()
+{
+	RecordHeader header;
+	guint32 newestSequence=0;
+
+	this->newestValid=false;
+	this->newestSlot=0;
+	this->nextSlot=0;
+	this->nextSequence=1;
+	this->invalidSlotCnt=0;
+
+	for (unsigned int slot=0; slot<this->slotCnt; slot++)
+	{
+		if (!this->ReadSlot(slot, &header))
+		{
+			this->invalidSlotCnt++;
+			continue;
+		}
+
+		//wrap safe comparison of the sequence numbers
+		if (!this->newestValid || (gint32)(header.sequence-newestSequence)>0)
+		{
+			newestSequence=header.sequence;
+			this->newestSlot=slot;
+			this->newestValid=true;
+		}
+	}
+
+	if (!this->newestValid)
+		return;
+
+	LOG_DEBUG("PersistentStateJournal::Scan - Newest record %u found in slot %u. %u slots invalid.",
+			newestSequence, this->newestSlot, this->invalidSlotCnt);
+
+	this->nextSlot=(this->newestSlot+1)%this->slotCnt;
+	this->nextSequence=newestSequence+1;
+}
+
+size_t PersistentStateJournal::Recover(void *payload, size_t maxSize)
+{
+	RecordHeader header;
+
+	if (this->fd==-1)
+		return 0;
+
+	if (!this->newestValid)
+	{
+		LOG_INFO("State journal holds no valid record.");
+		return 0;
+	}
+
+	if (!this->ReadSlot(this->newestSlot, &header))
+		return 0;
+
+	if (header.payloadSize>maxSize)
+	{
+		LOG_ERROR("State journal record of %u bytes exceeds the data set size.", header.payloadSize);
+		return 0;
+	}
+
+	memcpy(payload, this->slotBuffer+sizeof(RecordHeader), header.payloadSize);
+	return header.payloadSize;
+}
+
+size_t PersistentStateJournal::ReadLegacyDataSet(void *payload, size_t size)
+{
+	ssize_t result;
+
+	if (this->fd==-1)
+		return 0;
+
+	result=pread(this->fd, payload, size, 0);
+	return result<0 ? 0 : (size_t)result;
+}
+
+bool PersistentStateJournal::Append(const void *payload, size_t size)
+{
+	RecordHeader header;
+	bool result=true;
+
+	if (this->fd==-1 || size>PersistentStateJournal::GetMaxPayloadSize())
+		return false;
+
+	header.magic=JOURNAL_RECORD_MAGIC;
+	header.sequence=this->nextSequence;
+	header.payloadSize=size;
+	header.crc=0;
+	header.crc=PersistentStateJournal::CalcRecordCrc(&header, payload);
+
+	memset(this->slotBuffer, 0, JOURNAL_SLOT_SIZE);
+	memcpy(this->slotBuffer, &header, sizeof(header));
+	memcpy(this->slotBuffer+sizeof(header), payload, size);
+
+	if (pwrite(this->fd, this->slotBuffer, JOURNAL_SLOT_SIZE, (off_t)this->nextSlot*JOURNAL_SLOT_SIZE)!=JOURNAL_SLOT_SIZE)
+	{
+		LOG_ERROR("Unable to write state journal slot %u: %s", this->nextSlot, strerror(errno));
+		result=false;
+	}
+	else
+	{
+		this->newestValid=true;
+		this->newestSlot=this->nextSlot;
+		this->appendCnt++;
+	}
+
+	//a failed slot is skipped as well. The previous record stays the newest valid one.
+	this->nextSequence++;
+	this->nextSlot++;
+	if (this->nextSlot==this->slotCnt)
+	{
+		LOG_DEBUG("PersistentStateJournal::Append - Journal wrapped. Continuing at its start.");
+		this->nextSlot=0;
+		this->wrapCnt++;
+	}
+
+	return result;
+}
+
+unsigned int PersistentStateJournal::GetAppendCount()
+{
+	return this->appendCnt;
+}
+
+unsigned int PersistentStateJournal::GetWrapCount()
+{
+	return this->wrapCnt;
+}
+
+unsigned int PersistentStateJournal::GetInvalidSlotCount()
+{
+	return this->invalidSlotCnt;
+}
@@ -0,0 +1,106 @@
+/*
+ * PersistentStateJournal.h
+ *
+ *  Created on: 17.10.2026
+ *      Author: joe
+ */
+
+#ifndef SRC_PERSISTENTSTATEJOURNAL_H_
+#define SRC_PERSISTENTSTATEJOURNAL_H_
+
+#include <glib.h>
+#include <stddef.h>
+
+namespace retroradio_controller {
+
+//one record per slot. A slot covers a whole page so a torn write never touches the previous record.
+#define JOURNAL_SLOT_SIZE			4096
+#define JOURNAL_DEFAULT_SIZE		(1024*1024)
+
+//Append only journal of CRC protected data set records spread over the state file or partition.
+//Every record holds a complete data set. The newest valid record is found by scanning all slots on open.
+//Once the end of the journal is reached writing continues at its start (compaction), overwriting the oldest records.
+class PersistentStateJournal {
+private:
+	typedef struct RecordHeader
+	{
+		guint32 magic;
+
+		//increases with every record written
+		guint32 sequence;
+
+		guint32 payloadSize;
+
+		//crc32 over the header with crc==0 followed by the payload
+		guint32 crc;
+	} RecordHeader;
+
+	int fd;
+
+	unsigned int slotCnt;
+
+	//slot written by the next append
+	unsigned int nextSlot;
+
+	guint32 nextSequence;
+
+	//slot of the newest valid record, found on open or written since
+	bool newestValid;
+
+	unsigned int newestSlot;
+
+	unsigned char *slotBuffer;
+
+	unsigned int appendCnt;
+
+	unsigned int wrapCnt;
+
+	unsigned int invalidSlotCnt;
+
+	static guint32 Crc32(guint32 crc, const void *data, size_t size);
+
+	static guint32 CalcRecordCrc(const RecordHeader *header, const void *payload);
+
+	//leaves the payload in slotBuffer
+	bool ReadSlot(unsigned int slot, RecordHeader *header);
+
+	//finds the newest valid record and positions the next append behind it
+	void Scan();
+
+public:
+	PersistentStateJournal();
+
+	virtual ~PersistentStateJournal();
+
+	//journalSize is clamped to the size of a block device. Appends continue behind the newest valid record.
+	bool Open(const char *path, size_t journalSize);
+
+	void Close();
+
+	bool IsOpen();
+
+	//copies the payload of the newest valid record. Returns its size or 0 if the journal holds none.
+	//Uses the scan done on open, the journal is not read again except for the record itself.
+	size_t Recover(void *payload, size_t maxSize);
+
+	//reads the data set written in front of the journal format at the start of the file. Returns the bytes read.
+	size_t ReadLegacyDataSet(void *payload, size_t size);
+
+	bool Append(const void *payload, size_t size);
+
+	static size_t GetMaxPayloadSize();
+
+	//bytes of a slot covered by a record with the given payload, the rest of the slot is zero
+	static size_t GetRecordSize(size_t payloadSize);
+
+	unsigned int GetAppendCount();
+
+	unsigned int GetWrapCount();
+
+	//slots found torn or unused during the last recovery
+	unsigned int GetInvalidSlotCount();
+};
+
+} /* namespace retroradio_controller */
+
+#endif /* SRC_PERSISTENTSTATEJOURNAL_H_ */
@@ -0,0 +1,291 @@
+/*
+ * PersistentStateWriter.cpp
+ *
+ *  Created on: 17.10.2026
+ *      Author: joe
+ */
+
+#include "PersistentStateWriter.h"
+
+#include "Logging.h"
+
+using namespace CppAppUtils;
+
+using namespace retroradio_controller;
+
+PersistentStateWriter::PersistentStateWriter(PersistentStateJournal *journal) :
+		journal(journal),
+		journalPath(NULL),
+		journalSize(0),
+		thread(NULL),
+		quit(false),
+		scratchBuffer(0),
+		frontBuffer(1),
+		backBuffer(2),
+		snapshotPending(false),
+		snapshotTime(0),
+		submittedSeq(0),
+		writtenSeq(0),
+		writeCnt(0),
+		failedWriteCnt(0),
+		wrapCnt(0),
+		latencyCnt(0),
+		latencySumUs(0),
+		latencyMaxUs(0)
+{
+	g_mutex_init(&this->mutex);
+	g_cond_init(&this->snapshotCond);
+	g_cond_init(&this->writtenCond);
+
+	for (int a=0; a<3; a++)
+	{
+		this->buffers[a]=(unsigned char *)g_malloc0(PersistentStateJournal::GetMaxPayloadSize());
+		this->bufferSizes[a]=0;
+	}
+}
+
+PersistentStateWriter::~PersistentStateWriter()
+{
+	this->Stop();
+
+	for (int a=0; a<3; a++)
+		g_free(this->buffers[a]);
+
+	g_cond_clear(&this->writtenCond);
+	g_cond_clear(&this->snapshotCond);
+	g_mutex_clear(&this->mutex);
+}
+
+bool PersistentStateWriter::Start(const char *path, size_t size)
+{
+	GError *error=NULL;
+
+	this->journalPath=path;
+	this->journalSize=size;
+
+	if (this->thread!=NULL)
+		return true;
+
+	this->quit=false;
+	this->thread=g_thread_try_new("state-writer", PersistentStateWriter::ThreadFunc, this, &error);
+	if (this->thread==NULL)
+	{
+		LOG_ERROR("Unable to start persistent state writer thread: %s. Writing state from main loop.", error->message);
+		g_error_free(error);
+		return false;
+	}
+
+	LOG_DEBUG("PersistentStateWriter::Start - Started persistent state writer thread.");
+	return true;
+}
+
+void PersistentStateWriter::Stop()
+{
+	if (this->thread==NULL)
+		return;
+
+	g_mutex_lock(&this->mutex);
+	this->quit=true;
+	g_cond_signal(&this->snapshotCond);
+	g_mutex_unlock(&this->mutex);
+
+	g_thread_join(this->thread);
+	this->thread=NULL;
+
+	LOG_DEBUG("PersistentStateWriter::Stop - Stopped persistent state writer thread.");
+}
+
+gpointer PersistentStateWriter::ThreadFunc(gpointer data)
+{
+	((PersistentStateWriter *)data)->Run();
+	return NULL;
+}
+
+void PersistentStateWriter::Run()
+{
+	g_mutex_lock(&this->mutex);
+	while (true)
+	{
+		unsigned int buffer;
+		gint64 takenTime;
+		guint64 seq;
+		bool result;
+
+		while (!this->snapshotPending && !this->quit)
+			g_cond_wait(&this->snapshotCond, &this->mutex);
+
+		if (!this->snapshotPending)
+			break;
+
+		//the previous back buffer is written already, the main loop may commit into it now
+		buffer=this->frontBuffer;
+		this->frontBuffer=this->backBuffer;
+		this->backBuffer=buffer;
+		this->snapshotPending=false;
+		takenTime=this->snapshotTime;
+		seq=this->submittedSeq;
+		g_mutex_unlock(&this->mutex);
+
+		result=this->WriteSnapshot(this->buffers[buffer], this->bufferSizes[buffer]);
+
+		g_mutex_lock(&this->mutex);
+		this->FinishSnapshot(seq, result, takenTime);
+	}
+	g_mutex_unlock(&this->mutex);
+}
+
+bool PersistentStateWriter::WriteSnapshot(const void *data, size_t size)
+{
+	if (!this->journal->IsOpen())
+	{
+		LOG_DEBUG("PersistentStateWriter::WriteSnapshot - Opening state journal %s.", this->journalPath);
+		if (this->journalPath==NULL || !this->journal->Open(this->journalPath, this->journalSize))
+			return false;
+	}
+
+	return this->journal->Append(data, size);
+}
+
+void PersistentStateWriter::FinishSnapshot(guint64 seq, bool result, gint64 takenTime)
+{
+	gint64 latency=g_get_monotonic_time()-takenTime;
+
+	if (result)
+		this->writeCnt++;
+	else
+		this->failedWriteCnt++;
+
+	this->latencyCnt++;
+	this->latencySumUs+=latency;
+	if (latency>this->latencyMaxUs)
+		this->latencyMaxUs=latency;
+	this->wrapCnt=this->journal->GetWrapCount();
+
+	//a failed snapshot is not retried, the next commit writes the whole data set again
+	this->writtenSeq=seq;
+	g_cond_broadcast(&this->writtenCond);
+}
+
+void *PersistentStateWriter::BeginSnapshot(size_t *maxSize)
+{
+	g_mutex_lock(&this->mutex);
+
+	*maxSize=PersistentStateJournal::GetMaxPayloadSize();
+	return this->buffers[this->scratchBuffer];
+}
+
+void PersistentStateWriter::CommitSnapshot(size_t size)
+{
+	unsigned int buffer;
+
+	if (size==0)
+	{
+		g_mutex_unlock(&this->mutex);
+		return;
+	}
+
+	//the serialized snapshot replaces the committed one, which is reused as scratch buffer
+	buffer=this->scratchBuffer;
+	this->scratchBuffer=this->frontBuffer;
+	this->frontBuffer=buffer;
+
+	this->bufferSizes[this->frontBuffer]=size;
+	this->submittedSeq++;
+
+	if (this->thread==NULL)
+	{
+		gint64 takenTime=g_get_monotonic_time();
+
+		this->FinishSnapshot(this->submittedSeq, this->WriteSnapshot(this->buffers[this->frontBuffer], size), takenTime);
+		g_mutex_unlock(&this->mutex);
+		return;
+	}
+
+	//a snapshot not yet picked up is replaced. Its latency counts from the first one.
+	if (!this->snapshotPending)
+		this->snapshotTime=g_get_monotonic_time();
+	this->snapshotPending=true;
+	g_cond_signal(&this->snapshotCond);
+	g_mutex_unlock(&this->mutex);
+}
+
+bool PersistentStateWriter::Flush(unsigned int timeoutMs)
+{
+	gint64 endTime=g_get_monotonic_time()+(gint64)timeoutMs*1000;
+	guint64 target;
+	bool result;
+
+	g_mutex_lock(&this->mutex);
+	target=this->submittedSeq;
+	while (this->writtenSeq<target)
+	{
+		if (!g_cond_wait_until(&this->writtenCond, &this->mutex, endTime))
+			break;
+	}
+	result=this->writtenSeq>=target;
+	g_mutex_unlock(&this->mutex);
+
+	if (!result)
+		LOG_ERROR("Persistent state not written within %u ms.", timeoutMs);
+
+	return result;
+}
+
+unsigned int PersistentStateWriter::GetWriteCount()
+{
+	unsigned int result;
+
+	g_mutex_lock(&this->mutex);
+	result=this->writeCnt;
+	g_mutex_unlock(&this->mutex);
+	return result;
+}
+
+unsigned int PersistentStateWriter::GetFailedWriteCount()
+{
+	unsigned int result;
+
+	g_mutex_lock(&this->mutex);
+	result=this->failedWriteCnt;
+	g_mutex_unlock(&this->mutex);
+	return result;
+}
+
+unsigned int PersistentStateWriter::GetWrapCount()
+{
+	unsigned int result;
+
+	g_mutex_lock(&this->mutex);
+	result=this->wrapCnt;
+	g_mutex_unlock(&this->mutex);
+	return result;
+}
+
+gint64 PersistentStateWriter::GetCommitLatencyAvgUs()
+{
+	gint64 result;
+
+	g_mutex_lock(&this->mutex);
+	result=this->latencyCnt>0 ? this->latencySumUs/this->latencyCnt : 0;
+	g_mutex_unlock(&this->mutex);
+	return result;
+}
+
+gint64 PersistentStateWriter::GetCommitLatencyMaxUs()
+{
+	gint64 result;
+
+	g_mutex_lock(&this->mutex);
+	result=this->latencyMaxUs;
+	g_mutex_unlock(&this->mutex);
+	return result;
+}
+
+void PersistentStateWriter::ResetLatencyStatistics()
+{
+	g_mutex_lock(&this->mutex);
+	this->latencyCnt=0;
+	this->latencySumUs=0;
+	this->latencyMaxUs=0;
+	g_mutex_unlock(&this->mutex);
+}
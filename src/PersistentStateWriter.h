@@ -0,0 +1,124 @@
+/*
+ * PersistentStateWriter.h
+ *
+ *  Created on: 17.10.2026
+ *      Author: joe
+ */
+
+#ifndef SRC_PERSISTENTSTATEWRITER_H_
+#define SRC_PERSISTENTSTATEWRITER_H_
+
+#include <glib.h>
+
+#include "PersistentStateJournal.h"
+
+namespace retroradio_controller {
+
+#define PERSISTENT_STATE_FLUSH_TIMEOUT_MS	3000
+
+//Writes data set snapshots into the journal from a thread of its own, the main loop never waits for the storage.
+//The main loop serializes into a scratch buffer which becomes the front buffer once the snapshot is committed,
+//while the thread writes the back buffer. A failed serialization leaves a pending snapshot untouched. Snapshots
+//taken before the thread picked up the previous one replace it. Without a running thread they are written directly.
+class PersistentStateWriter {
+private:
+	PersistentStateJournal *journal;
+
+	const char *journalPath;
+
+	size_t journalSize;
+
+	GThread *thread;
+
+	bool quit;
+
+	GMutex mutex;
+
+	//signals a new snapshot to the thread
+	GCond snapshotCond;
+
+	//signals a written snapshot to flushing callers
+	GCond writtenCond;
+
+	unsigned char *buffers[3];
+
+	size_t bufferSizes[3];
+
+	//buffer filled by the main loop
+	unsigned int scratchBuffer;
+
+	//last committed snapshot
+	unsigned int frontBuffer;
+
+	//buffer written by the thread
+	unsigned int backBuffer;
+
+	bool snapshotPending;
+
+	//time the oldest snapshot not yet written has been taken
+	gint64 snapshotTime;
+
+	guint64 submittedSeq;
+
+	guint64 writtenSeq;
+
+	unsigned int writeCnt;
+
+	unsigned int failedWriteCnt;
+
+	unsigned int wrapCnt;
+
+	unsigned int latencyCnt;
+
+	gint64 latencySumUs;
+
+	gint64 latencyMaxUs;
+
+	static gpointer ThreadFunc(gpointer data);
+
+	void Run();
+
+	//the writer thread or the main loop without thread only
+	bool WriteSnapshot(const void *data, size_t size);
+
+	//called with the mutex locked by the thread which has written the snapshot
+	void FinishSnapshot(guint64 seq, bool result, gint64 takenTime);
+
+public:
+	PersistentStateWriter(PersistentStateJournal *journal);
+
+	virtual ~PersistentStateWriter();
+
+	//the journal is opened again with path and size if it is closed when writing
+	bool Start(const char *path, size_t size);
+
+	//writes the pending snapshot before the thread exits
+	void Stop();
+
+	//main loop only. Returns the scratch buffer locked until CommitSnapshot is called.
+	void *BeginSnapshot(size_t *maxSize);
+
+	//size 0 discards the snapshot, the previously committed one stays pending
+	void CommitSnapshot(size_t size);
+
+	//waits until all snapshots committed so far are written. Returns false on timeout.
+	bool Flush(unsigned int timeoutMs);
+
+	unsigned int GetWriteCount();
+
+	unsigned int GetFailedWriteCount();
+
+	unsigned int GetWrapCount();
+
+	//time from taking a snapshot until it is written
+	gint64 GetCommitLatencyAvgUs();
+
+	gint64 GetCommitLatencyMaxUs();
+
+	//restarts the latency average and maximum
+	void ResetLatencyStatistics();
+};
+
+} /* namespace retroradio_controller */
+
+#endif /* SRC_PERSISTENTSTATEWRITER_H_ */
@@ -9,37 +9,29 @@
 
 #include "RetroradioController.h"
 
-#include <cpp-app-utils/Logger.h>
+#include "Logging.h"
 
 #include <glib.h>
-#include <sys/types.h>
-#include <sys/stat.h>
-#include <unistd.h>
 
 using namespace CppAppUtils;
 
-#define STARTUP_POLL_TIMEOUT_MS		250
-
-#define HANDOVER_FILE		"/run/system_start_complete"
-
-
 namespace retroradio_controller {
 
 PowerStateMachine::PowerStateMachine() :
 		state(_NOT_INITIALIZED),
 		need2ReOpenSoundDevices(true)
 {
-
+	this->handover=new EarlyLateHandover(this);
 }
 
 PowerStateMachine::~PowerStateMachine()
 {
-
+	delete this->handover;
 }
 
 bool PowerStateMachine::Init()
 {
-	Logger::LogDebug("PowerStateMachine::Init -> Initializing main state machine.");
+	LOG_DEBUG("PowerStateMachine::Init -> Initializing main state machine.");
 
 	return true;
 }
@@ -47,40 +39,33 @@ bool PowerStateMachine::Init()
 void PowerStateMachine::DeInit()
 {
 	this->state=_NOT_INITIALIZED;
-	Logger::LogDebug("PowerStateMachine::DeInit -> Deinitialized main state machine.");
+	LOG_DEBUG("PowerStateMachine::DeInit -> Deinitialized main state machine.");
 }
 
 void PowerStateMachine::EnterStartingUp()
 {
 	AudioController *ac=RetroradioController::Instance()->GetAudioController();
 
-	Logger::LogDebug("PowerStateMachine::EnterStartingUp -> Retroradio starting up. Waiting for sources to finish booting.");
+	LOG_DEBUG("PowerStateMachine::EnterStartingUp -> Retroradio starting up. Waiting for sources to finish booting.");
 	this->state=STARTING_UP;
 
-	// all sources already up and ready for activation?
+	// sources signal when they are ready. Startup goes on as soon as the last one is.
+	ac->WaitForSourcesStartup();
 	if (ac->CheckSourcesStartupState())
 		this->OnStartupFinished();
-	else
-		g_timeout_add(STARTUP_POLL_TIMEOUT_MS, PowerStateMachine::OnStartupPollTimerElapsed, this);
 }
 
-gboolean PowerStateMachine::OnStartupPollTimerElapsed(gpointer user_data)
+void PowerStateMachine::OnSourcesStartupFinished()
 {
-	PowerStateMachine *instance=(PowerStateMachine *)user_data;
-	AudioController *ac=RetroradioController::Instance()->GetAudioController();
+	if (this->state!=STARTING_UP)
+		return;
 
-	if (ac->CheckSourcesStartupState())
-	{
-		instance->OnStartupFinished();
-		return FALSE;
-	}
-
-	return TRUE;
+	this->OnStartupFinished();
 }
 
 void PowerStateMachine::OnStartupFinished()
 {
-	Logger::LogDebug("PowerStateMachine::OnStartupFinished -> Startup for sources finished.");
+	LOG_DEBUG("PowerStateMachine::OnStartupFinished -> Startup for sources finished.");
 	this->DoEarlyLateHandover();
 	if (RetroradioController::Instance()->GetConnObserver()->IsConnected())
 	{
@@ -95,33 +80,21 @@ void PowerStateMachine::OnStartupFinished()
 
 void PowerStateMachine::DoEarlyLateHandover()
 {
-	struct stat r;
-	int f,cntr=10;
-
-	Logger::LogDebug("PowerStateMachine::DoEarlyLateHandover -> Doing hand over handshake with early process.");
-
-
-	//create file /run/system_start_complete to inform rr-early-setup process that system start is complete
-	f=open(HANDOVER_FILE, O_CREAT, 0666);
-	close(f);
-
-	//the process exists and removes the file directly before
-	//when we detect the file removal, we can go on controling LEDs without any influence of the early service
-	while(stat(HANDOVER_FILE, &r)==0 && cntr!=0)
-	{
-		Logger::LogDebug("PowerStateMachine::DoEarlyLateHandover -> Waiting for early process to finish.");
-		//give the early process 100ms to exit
-		usleep(100000);
-		cntr--;
-	}
+	//leds are taken over when the early process is gone. Activation goes on in parallel.
+	RetroradioController::Instance()->GetGPIOController()->SetLedsOwned(false);
+	if (!this->handover->Start())
+		RetroradioController::Instance()->GetGPIOController()->SetLedsOwned(true);
+}
 
-	if (cntr==0)
-		Logger::LogError("Early setup process did not remove file /run/system_start_complete within 1 sec.");
+void PowerStateMachine::OnHandoverFinished(bool timedOut)
+{
+	LOG_DEBUG("PowerStateMachine::OnHandoverFinished -> Early process finished. Taking over leds.");
+	RetroradioController::Instance()->GetGPIOController()->SetLedsOwned(true);
 }
 
 void PowerStateMachine::EnterWaitingForWifiAndSndCard()
 {
-	Logger::LogDebug("PowerStateMachine::EnterWaitingForWifiAndSndCard -> Waiting for wifi and/or snd card.");
+	LOG_DEBUG("PowerStateMachine::EnterWaitingForWifiAndSndCard -> Waiting for wifi and/or snd card.");
 	this->state=WAITING_FOR_WIFI_AND_SNDCARD;
 
 	RetroradioController::Instance()->GetGPIOController()->SetPowerLedMode(GPIOController::WAITING_FOR_WIFI);
@@ -134,7 +107,7 @@ void PowerStateMachine::EnterWaitingForWifiAndSndCard()
 void PowerStateMachine::EnterConnectionLoss()
 {
 	AudioController *ac=RetroradioController::Instance()->GetAudioController();
-	Logger::LogDebug("PowerStateMachine::EnterConnectionLoss -> Lost connection. Deactivating radio services.");
+	LOG_DEBUG("PowerStateMachine::EnterConnectionLoss -> Lost connection. Deactivating radio services.");
 	ac->DeactivateController(true);
 	this->state=CONNECTION_LOSS;
 	if (ac->GetState()==AudioController::DEACTIVATED)
@@ -144,7 +117,7 @@ void PowerStateMachine::EnterConnectionLoss()
 void PowerStateMachine::EnterSndCardDisappeared()
 {
 	AudioController *ac=RetroradioController::Instance()->GetAudioController();
-	Logger::LogDebug("PowerStateMachine::EnterSndCardDisappeared -> Sound card disappeared. Deactivating radio services.");
+	LOG_DEBUG("PowerStateMachine::EnterSndCardDisappeared -> Sound card disappeared. Deactivating radio services.");
 	//sound card gone -> no mute ramp possible
 	ac->DeactivateController(false);
 	this->state=SNDCARD_DISAPPEARED;
@@ -155,7 +128,7 @@ void PowerStateMachine::EnterSndCardDisappeared()
 void PowerStateMachine::EnterActivating()
 {
 	AudioController *ac=RetroradioController::Instance()->GetAudioController();
-	Logger::LogDebug("PowerStateMachine::EnterActivating -> Activating radio services.");
+	LOG_DEBUG("PowerStateMachine::EnterActivating -> Activating radio services.");
 	this->SetPowerEnabled(true);
 	RetroradioController::Instance()->GetPersistentState()->SetPowerStateActive(true);
 	ac->ActivateAudioController(this->need2ReOpenSoundDevices);
@@ -168,7 +141,7 @@ void PowerStateMachine::EnterActivating()
 void PowerStateMachine::EnterDeactivating()
 {
 	AudioController *ac=RetroradioController::Instance()->GetAudioController();
-	Logger::LogDebug("PowerStateMachine::EnterDeactivating -> Deactivating radio services.");
+	LOG_DEBUG("PowerStateMachine::EnterDeactivating -> Deactivating radio services.");
 	RetroradioController::Instance()->GetPersistentState()->SetPowerStateActive(false);
 	ac->DeactivateController(true);
 	this->state=DEACTIVATING;
@@ -178,26 +151,28 @@ void PowerStateMachine::EnterDeactivating()
 
 void PowerStateMachine::EnterActive()
 {
-	Logger::LogDebug("PowerStateMachine::EnterActive -> Radio services activated.");
+	LOG_DEBUG("PowerStateMachine::EnterActive -> Radio services activated.");
 	this->state=ACTIVE;
 }
 
 void PowerStateMachine::EnterStandby()
 {
-	Logger::LogDebug("PowerStateMachine::EnterStandby -> Entering state standby.");
+	LOG_DEBUG("PowerStateMachine::EnterStandby -> Entering state standby.");
+	//the radio may be unplugged once it is off -> the power state must be on the storage
+	RetroradioController::Instance()->GetPersistentState()->Flush();
 	this->SetPowerEnabled(false);
 	this->state=STANDBY;
 }
 
 void PowerStateMachine::OnPowerBtnPressed()
 {
-	Logger::LogDebug("PowerStateMachine::OnPowerBtnPressed -> Received a \"Power Button released\" event.");
+	LOG_DEBUG("PowerStateMachine::OnPowerBtnPressed -> Received a \"Power Button released\" event.");
 	this->DoProcessPowerBtnEvent();
 }
 
 void PowerStateMachine::OnIRPowerCommandReceived()
 {
-	Logger::LogDebug("PowerStateMachine::OnIRPowerCommandReceived -> Received a Power IR Command Trigger.");
+	LOG_DEBUG("PowerStateMachine::OnIRPowerCommandReceived -> Received a Power IR Command Trigger.");
 	this->DoProcessPowerBtnEvent();
 }
 
@@ -264,7 +239,7 @@ void PowerStateMachine::OnAudioControllerStateChanged(
 	AudioController *ac=RetroradioController::Instance()->GetAudioController();
 	AudioController::State acState=ac->GetState();
 
-	Logger::LogDebug("PowerStateMachine::OnAudioControllerStateChanged -> Power state machine received state"
+	LOG_DEBUG("PowerStateMachine::OnAudioControllerStateChanged -> Power state machine received state"
 			"change event from audio controller. New State: %s",AudioController::StateNames[newState]);
 
 	if (this->state==ACTIVATING && acState==AudioController::ACTIVATED)
@@ -278,13 +253,13 @@ void PowerStateMachine::OnAudioControllerStateChanged(
 
 void PowerStateMachine::KickOff()
 {
-	Logger::LogDebug("PowerStateMachine::KickOff -> Starting main state machine.");
+	LOG_DEBUG("PowerStateMachine::KickOff -> Starting main state machine.");
 	this->EnterStartingUp();
 }
 
 void PowerStateMachine::SetPowerEnabled(bool enabled)
 {
-	Logger::LogDebug("PowerStateMachine::SetPowerEnabled -> %s amp power.", enabled ? "Activating" : "DeActivating");
+	LOG_DEBUG("PowerStateMachine::SetPowerEnabled -> %s amp power.", enabled ? "Activating" : "DeActivating");
 	RetroradioController::Instance()->GetGPIOController()->SetAmpEnabled(enabled);
 	if (enabled)
 		RetroradioController::Instance()->GetGPIOController()->SetPowerLedMode(GPIOController::POWER_ON);
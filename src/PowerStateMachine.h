@@ -9,10 +9,11 @@
 #define SRC_POWERSTATEMACHINE_H_
 
 #include "AudioController.h"
+#include "EarlyLateHandover.h"
 
 namespace retroradio_controller {
 
-class PowerStateMachine {
+class PowerStateMachine : public EarlyLateHandover::IHandoverListener {
 
 private:
 	enum State
@@ -33,6 +34,8 @@ private:
 
 	bool need2ReOpenSoundDevices;
 
+	EarlyLateHandover *handover;
+
 	void EnterStartingUp();
 
 	void OnStartupFinished();
@@ -53,8 +56,6 @@ private:
 
 	void SetPowerEnabled(bool enabled);
 
-	static gboolean OnStartupPollTimerElapsed(gpointer user_data);
-
 	void DoEarlyLateHandover();
 
 	void DoProcessPowerBtnEvent();
@@ -84,6 +85,11 @@ public:
 
 	void OnAudioControllerStateChanged(AudioController::State newState);
 
+	void OnSourcesStartupFinished();
+
+	//EarlyLateHandover::IHandoverListener
+	virtual void OnHandoverFinished(bool timedOut);
+
 	void KickOff();
 
 	bool IsPowered();
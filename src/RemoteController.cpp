@@ -18,8 +18,9 @@
 
 #include <sys/ioctl.h>
 
-#include <cpp-app-utils/Logger.h>
+#include "Logging.h"
 #include "RetroradioController.h"
+#include "LatencyTracer.h"
 
 #define SOFT_REPEAT_DETECTOR_TIMEOUT_MS	250
 
@@ -40,15 +41,15 @@ namespace retroradio_controller {
 RemoteController::RemoteController(IRemoteControllerListener* theListener,
 		Configuration *configuration) :
 		listener (theListener),
-		pollFd(-1),
-		lircEventSrc(0),
 		inputDeviceName(NULL),
 		remoteProfileName(NULL),
-		retryCntr(0),
-		defereTimerId(0),
-		softwarRepeatDetectorDelayEnabled(false),
 		softwareRepeatDetectorTimerId(0),
-		lastScanCode(_SCAN_CODE_NOT_SET)
+		softwarRepeatDetectorDelayEnabled(false),
+		lastScanCode(_SCAN_CODE_NOT_SET),
+		lircEventSource(NULL),
+		pollFd(-1),
+		retryCntr(0),
+		defereTimerId(0)
 {
 	this->remoteControllerProfiles=new RemoteControllerProfiles();
 	configuration->AddConfigurationModule(this);
@@ -65,9 +66,40 @@ RemoteController::~RemoteController()
 }
 
 bool RemoteController::Init()
+{
+	return AudioControlThread::Instance()->Invoke(this, RC_CMD_INIT, 0)!=0;
+}
+
+void RemoteController::DeInit()
+{
+	AudioControlThread::Instance()->Invoke(this, RC_CMD_DEINIT, 0);
+}
+
+long RemoteController::OnAudioControlCommand(int cmd, long arg, unsigned int tag)
+{
+	switch((Command)cmd)
+	{
+	case RC_CMD_INIT:
+		return this->DoInit() ? 1 : 0;
+
+	case RC_CMD_DEINIT:
+		this->DoDeInit();
+		break;
+	}
+
+	return 0;
+}
+
+void RemoteController::OnAudioControlEvent(int event, long arg, unsigned int tag)
+{
+	if (event==RC_EVT_COMMAND && this->listener != NULL)
+		this->listener->OnCommandReceived((RemoteControllerProfiles::RemoteCommand)arg);
+}
+
+bool RemoteController::DoInit()
 {
 	int result;
-	Logger::LogDebug("RemoteController::Init -> Initializing Remote Controller.");
+	LOG_DEBUG("RemoteController::Init -> Initializing Remote Controller.");
 	this->retryCntr=0;
 	this->softwarRepeatDetectorDelayEnabled=false;
 	this->softwareRepeatDetectorTimerId=0;
@@ -88,7 +120,8 @@ bool RemoteController::Init()
 
 void RemoteController::DefereInitalization()
 {
-	this->defereTimerId=g_timeout_add(DEFERED_INIT_RETRY_INTERVAL_MS, RemoteController::RetryInit, this);
+	this->defereTimerId=AudioControlThread::Instance()->GetTimerWheel()->Add(DEFERED_INIT_RETRY_INTERVAL_MS,
+			TimerWheel::TIMER_SLACK_LAZY, RemoteController::RetryInit, this);
 }
 
 gboolean RemoteController::RetryInit(gpointer data)
@@ -103,11 +136,11 @@ gboolean RemoteController::RetryInit(gpointer data)
 	if (initResult != EAGAIN || instance->retryCntr >= DEFERED_INIT_RETRY_CNT_MAX)
 	{
 		if (initResult==0)
-			Logger::LogDebug("RemoteController::RetryInit - Initialization succeeded after %d tries.", instance->retryCntr);
+			LOG_DEBUG("RemoteController::RetryInit - Initialization succeeded after %d tries.", instance->retryCntr);
 		if (initResult==EAGAIN)
-			Logger::LogError("Did not succeed initializing the remote controller after %d tries. Giving up.", instance->retryCntr);
+			LOG_ERROR("Did not succeed initializing the remote controller after %d tries. Giving up.", instance->retryCntr);
 		else
-			Logger::LogError("Failed to initialize the remote controller. Result: %d", initResult);
+			LOG_ERROR("Failed to initialize the remote controller. Result: %d", initResult);
 
 		instance->defereTimerId=0;
 		return FALSE;
@@ -116,11 +149,11 @@ gboolean RemoteController::RetryInit(gpointer data)
 	return TRUE;
 }
 
-void RemoteController::DeInit()
+void RemoteController::DoDeInit()
 {
 	if (this->softwareRepeatDetectorTimerId!=0)
 	{
-		g_source_remove(this->softwareRepeatDetectorTimerId);
+		AudioControlThread::Instance()->GetTimerWheel()->Remove(this->softwareRepeatDetectorTimerId);
 				this->softwareRepeatDetectorTimerId=0;
 		this->softwarRepeatDetectorDelayEnabled=false;
 		this->lastScanCode=_SCAN_CODE_NOT_SET;
@@ -128,14 +161,15 @@ void RemoteController::DeInit()
 
 	if (this->defereTimerId!=0)
 	{
-		g_source_remove(this->defereTimerId);
+		AudioControlThread::Instance()->GetTimerWheel()->Remove(this->defereTimerId);
 		this->defereTimerId=0;
 	}
 
-	if (this->lircEventSrc!=0)
+	if (this->lircEventSource!=NULL)
 	{
-		g_source_remove(this->lircEventSrc);
-		this->lircEventSrc=0;
+		g_source_destroy(this->lircEventSource);
+		g_source_unref(this->lircEventSource);
+		this->lircEventSource=NULL;
 	}
 
 	if (this->pollFd!= -1)
@@ -145,7 +179,7 @@ void RemoteController::DeInit()
 	}
 
 	this->remoteControllerProfiles->DeInit();
-	Logger::LogDebug("RemoteController::DeInit -> Deinitialized Remote controller");
+	LOG_DEBUG("RemoteController::DeInit -> Deinitialized Remote controller");
 }
 
 int RemoteController::InitializeLIRC()
@@ -153,14 +187,14 @@ int RemoteController::InitializeLIRC()
 	int result;
 	const char *lircDevice = this->GetLircDeviceName();
 
-	Logger::LogDebug("RemoteController::InitializeLIRC -> Open LIRC device: %s.", lircDevice);
+	LOG_DEBUG("RemoteController::InitializeLIRC -> Open LIRC device: %s.", lircDevice);
 
-	Logger::LogDebug("RemoteController::InitializeLIRC -> Ping: %d", this->pollFd);
+	LOG_DEBUG("RemoteController::InitializeLIRC -> Ping: %d", this->pollFd);
 
 	if (this->pollFd!=-1)
 		close(this->pollFd);
 
-	Logger::LogDebug("RemoteController::InitializeLIRC -> Ping ...");
+	LOG_DEBUG("RemoteController::InitializeLIRC -> Ping ...");
 
 	result=this->SetIRDeviceProtocol(lircDevice);
 
@@ -181,41 +215,48 @@ int RemoteController::SetIRDeviceProtocol(const char *lircDevice)
 
 	const char *protoName=this->remoteControllerProfiles->GetProtocolName();
 
-	Logger::LogDebug("RemoteController::SetIRDeviceProtocol -> Setting IR device protocol to %s.", protoName);
+	LOG_DEBUG("RemoteController::SetIRDeviceProtocol -> Setting IR device protocol to %s.", protoName);
 	if (stat(lircDevice, &statResult)!=0)
 	{
 		if (errno == ENOENT)
 			return EAGAIN;
 		else
 		{
-			Logger::LogError("Error looking up IR device %s: %s", lircDevice, strerror(errno));
+			LOG_ERROR("Error looking up IR device %s: %s", lircDevice, strerror(errno));
 			return errno;
 		}
 	}
 
+	//scan codes replayed through a fifo (latency bench) need no protocol setup
+	if (S_ISFIFO(statResult.st_mode))
+	{
+		LOG_INFO("IR input device %s is a fifo. Replaying scan codes written to it.", lircDevice);
+		return 0;
+	}
+
 	majorId=major(statResult.st_rdev);
 	minorId=minor(statResult.st_rdev);
 
 	if (minorId < 0 || majorId < 0)
 	{
-		Logger::LogError("Given path %s is not a device node.", lircDevice);
+		LOG_ERROR("Given path %s is not a device node.", lircDevice);
 		return EINVAL;
 	}
 
 	snprintf(fn,2040,RC_PROTOCOL_PATH_TEMPLATE, majorId,minorId);
-	Logger::LogDebug("RemoteController::SetIRDeviceProtocol -> Opening IR protocols file: %s", fn);
+	LOG_DEBUG("RemoteController::SetIRDeviceProtocol -> Opening IR protocols file: %s", fn);
 
 	fd=open(fn, O_WRONLY|O_NONBLOCK);
 	if (fd==-1)
 	{
-		Logger::LogError("Error opening protocol file of IR device %s: %s", fn, strerror(errno));
+		LOG_ERROR("Error opening protocol file of IR device %s: %s", fn, strerror(errno));
 		return errno;
 	}
 
 	len=strlen(protoName);
 	if (write(fd, protoName, len)!=len)
 	{
-		Logger::LogError("Error setting IR protocol to %s.", protoName);
+		LOG_ERROR("Error setting IR protocol to %s.", protoName);
 		result=EINVAL;
 	}
 
@@ -227,24 +268,29 @@ int RemoteController::SetIRDeviceProtocol(const char *lircDevice)
 int RemoteController::EnableIRDeviceReceiveMode(const char *lircDevice)
 {
 	unsigned mode = LIRC_MODE_SCANCODE;
+	struct stat statResult;
 
-	Logger::LogDebug("RemoteController::EnableIRDeviceReceiveMode -> Setting IR device into receiver mode.");
+	LOG_DEBUG("RemoteController::EnableIRDeviceReceiveMode -> Setting IR device into receiver mode.");
 	this->pollFd=open(lircDevice, O_RDONLY | O_NONBLOCK);
 	if (this->pollFd==-1)
 	{
-		Logger::LogInfo("Failed to open LIRC device: %s. Retrying again.", lircDevice);
+		LOG_INFO("Failed to open LIRC device: %s. Retrying again.", lircDevice);
 		return EAGAIN;
 	}
 
-	if (ioctl(this->pollFd, LIRC_SET_REC_MODE, &mode))
+	if (fstat(this->pollFd, &statResult)==0 && S_ISFIFO(statResult.st_mode))
+		LOG_DEBUG("RemoteController::EnableIRDeviceReceiveMode -> Reading scan codes from fifo.");
+	else if (ioctl(this->pollFd, LIRC_SET_REC_MODE, &mode))
 	{
-		Logger::LogError("Failed to set lirc kernel module into SCAN mode.");
+		LOG_ERROR("Failed to set lirc kernel module into SCAN mode.");
 		close(this->pollFd);
 		this->pollFd=-1;
 		return EFAULT;
 	}
 
-    this->lircEventSrc=g_unix_fd_add(this->pollFd,G_IO_IN,RemoteController::OnLircEvent, this);
+    this->lircEventSource=g_unix_fd_source_new(this->pollFd,G_IO_IN);
+    g_source_set_callback(this->lircEventSource,(GSourceFunc)RemoteController::OnLircEvent,this,NULL);
+    g_source_attach(this->lircEventSource,g_main_context_get_thread_default());
 
 	return 0;
 }
@@ -275,7 +321,7 @@ void RemoteController::ReadLircEvent()
 	if (bytesRd != -1)
 		ParseScanCodes(sc, (unsigned int)(bytesRd / sizeof(lirc_scancode_t)));
 	else if (errno != EAGAIN)
-		Logger::LogError("Failed to read scan code from lirc module.");
+		LOG_ERROR("Failed to read scan code from lirc module.");
 }
 
 void RemoteController::ParseScanCodes(lirc_scancode_t* scanCodes,
@@ -288,14 +334,14 @@ void RemoteController::ParseScanCodes(lirc_scancode_t* scanCodes,
 		bool repeated=(scanCodes[i].flags & LIRC_SCANCODE_FLAG_REPEAT)!=0;
 		bool toggled=(scanCodes[i].flags & LIRC_SCANCODE_FLAG_TOGGLE)!=0;
 
-		Logger::LogDebug("RemoteController::ParseScanCodes -> Received IR code: 0x%llX, %s , %s",
+		LOG_DEBUG("RemoteController::ParseScanCodes -> Received IR code: 0x%llX, %s , %s",
 				scanCodes[i].scancode, repeated ? "repeated" : "", toggled ? "toggled" : "");
 
 		// software repeat filter.
 		if (this->CheckSoftwareRepeatDetector(scanCodes[i].scancode, repeated))
 			repeated=true;
 
-		this->ProcessScanCode(scanCodes[i].scancode, repeated, toggled);
+		this->ProcessScanCode(scanCodes[i].scancode, repeated, toggled, scanCodes[i].timestamp);
 	}
 }
 
@@ -325,10 +371,10 @@ bool RemoteController::CheckSoftwareRepeatDetector(unsigned long scancode,
 
 	//remove old timeout if active (can happen when different scancodes arrive fast one after the other)
 	if (this->softwareRepeatDetectorTimerId!=0)
-		g_source_remove(this->softwareRepeatDetectorTimerId);
+		AudioControlThread::Instance()->GetTimerWheel()->Remove(this->softwareRepeatDetectorTimerId);
 
-	this->softwareRepeatDetectorTimerId=g_timeout_add(SOFT_REPEAT_DETECTOR_TIMEOUT_MS,
-			RemoteController::SoftwareRepeatDetectorTimeoutFunc, this);
+	this->softwareRepeatDetectorTimerId=AudioControlThread::Instance()->GetTimerWheel()->Add(SOFT_REPEAT_DETECTOR_TIMEOUT_MS,
+			TimerWheel::TIMER_SLACK_NORMAL, RemoteController::SoftwareRepeatDetectorTimeoutFunc, this);
 
 	return false;
 }
@@ -353,7 +399,7 @@ bool RemoteController::FilterRepeatedCmds(RemoteControllerProfiles::RemoteComman
 }
 
 void RemoteController::ProcessScanCode(unsigned long scancode, bool repeated,
-		bool toggled)
+		bool toggled, guint64 timestamp)
 {
 	RemoteControllerProfiles::RemoteCommand cmd;
 	cmd=this->remoteControllerProfiles->GetCommandFromScanCode(scancode);
@@ -364,8 +410,16 @@ void RemoteController::ProcessScanCode(unsigned long scancode, bool repeated,
 	if (this->FilterRepeatedCmds(cmd, repeated, toggled))
 		return;
 
-	if (this->listener != NULL)
-		this->listener->OnCommandReceived(cmd);
+	LatencyTracer::Instance()->BeginSpan(timestamp, cmd);
+
+	if ((cmd==RemoteControllerProfiles::CMD_VOL_UP || cmd==RemoteControllerProfiles::CMD_VOL_DOWN) &&
+			AudioControlThread::Instance()->DispatchVolumeKey(cmd==RemoteControllerProfiles::CMD_VOL_UP))
+	{
+		LatencyTracer::Instance()->Mark(LatencyTracer::TRACE_CMD_RECEIVED, cmd);
+		return;
+	}
+
+	AudioControlThread::Instance()->PostEvent(this, RC_EVT_COMMAND, cmd);
 }
 
 bool RemoteController::ParseConfigFileItem(GKeyFile* confFile, const char* group, const char* key)
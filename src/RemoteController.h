@@ -14,6 +14,7 @@
 #include <cpp-app-utils/Configuration.h>
 
 #include "RemoteControllerProfiles.h"
+#include "AudioControlThread.h"
 
 extern "C"
 {
@@ -24,7 +25,10 @@ using namespace CppAppUtils;
 
 namespace retroradio_controller {
 
-class RemoteController : public Configuration::IConfigurationParserModule {
+//IR input is read and decoded by the audio control thread. Commands are passed to the listener by the main loop,
+//volume keys are handled by the audio control thread directly when possible.
+class RemoteController : public Configuration::IConfigurationParserModule,
+	public AudioControlThread::IAudioControlHandler {
 
 public:
 	class IRemoteControllerListener {
@@ -33,6 +37,17 @@ public:
 	};
 
 private:
+	enum Command
+	{
+		RC_CMD_INIT,
+		RC_CMD_DEINIT
+	};
+
+	enum Event
+	{
+		RC_EVT_COMMAND
+	};
+
 	RemoteControllerProfiles *remoteControllerProfiles;
 
 	IRemoteControllerListener *listener;
@@ -47,7 +62,7 @@ private:
 
 	unsigned long lastScanCode;
 
-	guint lircEventSrc;
+	GSource *lircEventSource;
 
 	int pollFd;
 
@@ -55,6 +70,10 @@ private:
 
 	guint defereTimerId;
 
+	bool DoInit();
+
+	void DoDeInit();
+
 	int InitializeLIRC();
 
 	int SetIRDeviceProtocol(const char *lircDevice);
@@ -81,7 +100,7 @@ private:
 
 	bool FilterRepeatedCmds(RemoteControllerProfiles::RemoteCommand cmd, bool repeated, bool toggled);
 
-	void ProcessScanCode(unsigned long scancode, bool repeated, bool toggled);
+	void ProcessScanCode(unsigned long scancode, bool repeated, bool toggled, guint64 timestamp);
 
 public:
 	RemoteController(IRemoteControllerListener *theListener, Configuration *configuration);
@@ -95,6 +114,11 @@ public:
 	virtual bool ParseConfigFileItem(GKeyFile *confFile, const char *group, const char *key);
 
 	virtual bool IsConfigFileGroupKnown(const char *group);
+
+	//AudioControlThread::IAudioControlHandler
+	virtual long OnAudioControlCommand(int cmd, long arg, unsigned int tag);
+
+	virtual void OnAudioControlEvent(int event, long arg, unsigned int tag);
 };
 
 } /* namespace retroradiocontroller */
@@ -18,7 +18,7 @@
 
 #include <sys/ioctl.h>
 
-#include <cpp-app-utils/Logger.h>
+#include "Logging.h"
 #include "RetroradioController.h"
 
 #define SMALL_NEC_REMOTE_PROFILE_PROTOCOL_NAME				"nec"
@@ -84,7 +84,7 @@ RemoteControllerProfiles::~RemoteControllerProfiles()
 
 bool RemoteControllerProfiles::Init(const char *profileName)
 {
-	Logger::LogDebug("RemoteControllerProfiles::Init -> Initializing remote controller profile %s.", profileName);
+	LOG_DEBUG("RemoteControllerProfiles::Init -> Initializing remote controller profile %s.", profileName);
 
 	if (strcmp(profileName, SMALL_NEC_REMOTE_PROFILE_ID)==0)
 		this->CreateSmallNECRemoteProfile();
@@ -92,12 +92,12 @@ bool RemoteControllerProfiles::Init(const char *profileName)
 		this->CreateTvstickRC5RemoteProfile();
 	else
 	{
-		Logger::LogError("Unknown remote controller profile: %s", profileName);
-		Logger::LogError("Known Profiles: %s, %s", SMALL_NEC_REMOTE_PROFILE_ID, TVSTICK_RC5_REMOTE_PROFILE_ID);
+		LOG_ERROR("Unknown remote controller profile: %s", profileName);
+		LOG_ERROR("Known Profiles: %s, %s", SMALL_NEC_REMOTE_PROFILE_ID, TVSTICK_RC5_REMOTE_PROFILE_ID);
 		return false;
 	}
 
-	Logger::LogDebug("RemoteControllerProfiles::Init -> Remote Protocol: %s", this->GetProtocolName());
+	LOG_DEBUG("RemoteControllerProfiles::Init -> Remote Protocol: %s", this->GetProtocolName());
 
 	return true;
 }
@@ -105,7 +105,7 @@ bool RemoteControllerProfiles::Init(const char *profileName)
 
 void RemoteControllerProfiles::DeInit()
 {
-	Logger::LogDebug("RemoteControllerProfiles::DeInit -> Deinitialized Remote controller profile.");
+	LOG_DEBUG("RemoteControllerProfiles::DeInit -> Deinitialized Remote controller profile.");
 }
 
 void RemoteControllerProfiles::CreateSmallNECRemoteProfile()
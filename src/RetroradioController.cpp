@@ -7,10 +7,15 @@
 
 #include "RetroradioController.h"
 
-#include <cpp-app-utils/Logger.h>
+#include "Logging.h"
 #include <glib-unix.h>
 #include <RetroradioControllerConfiguration.h>
 #include <sysexits.h>
+#include <signal.h>
+
+#include "LatencyTracer.h"
+#include "TimerWheel.h"
+#include "AudioControlThread.h"
 
 using namespace retroradio_controller;
 
@@ -21,6 +26,7 @@ RetroradioController::RetroradioController() :
 {
 	this->mainloop=g_main_loop_new(NULL,FALSE);
 	this->configuration=new RetroradioControllerConfiguration();
+	this->asyncLogger=new AsyncLogger(this->configuration);
 	this->persistentState=new RetroradioPersistentState(this->configuration);
 	this->stateMachine=new PowerStateMachine();
 	this->audioController=new AudioController(this, this->configuration);
@@ -39,6 +45,7 @@ RetroradioController::~RetroradioController()
 	delete this->audioController;
 	delete this->stateMachine;
 	delete this->persistentState;
+	delete this->asyncLogger;
 	delete this->configuration;
 	g_main_loop_unref (this->mainloop);
 }
@@ -48,7 +55,9 @@ bool RetroradioController::Init(int argc, char *argv[])
 	if (!this->configuration->ParseArgsEarly(argc,argv,this->returnCode))
 		return false;
 
-	Logger::LogInfo("Starting retroradio controller %s",
+	LogLevelCache::Refresh();
+
+	LOG_INFO("Starting retroradio controller %s",
 			RetroradioControllerConfiguration::Version);
 
 	if (!this->configuration->ReadConfigurationFile())
@@ -57,53 +66,60 @@ bool RetroradioController::Init(int argc, char *argv[])
 		return false;
 	}
 
+	LogLevelCache::Refresh();
+	this->asyncLogger->Start();
+
     g_unix_signal_add(1, &UnixSignalHandler, this);
     g_unix_signal_add(2, &UnixSignalHandler, this);
     g_unix_signal_add(15, &UnixSignalHandler, this);
+    g_unix_signal_add(SIGUSR1, &DumpTraceSignalHandler, this);
+
+    //without the thread ir input and mixers are driven by the main loop
+    AudioControlThread::Instance()->Start();
 
     this->persistentState->Init();
 
     if (!this->gpioController->Init())
     {
-    	Logger::LogError("Failed to init gpio controller.");
+    	LOG_ERROR("Failed to init gpio controller.");
     	return false;
     }
 
     if (!this->stateMachine->Init())
     {
-    	Logger::LogError("Failed to init main state machine.");
+    	LOG_ERROR("Failed to init main state machine.");
     	return false;
     }
 
     if (!this->audioController->Init())
     {
-    	Logger::LogError("Failed to start audio controller.");
+    	LOG_ERROR("Failed to start audio controller.");
     	return false;
     }
 
     if (!this->remoteController->Init())
 	{
-		Logger::LogError("Failed to start remote controller.");
+		LOG_ERROR("Failed to start remote controller.");
 		return false;
 	}
 
 	if (!this->connObserver->Init())
 	{
-		Logger::LogError("Failed to start wlan connection observer.");
+		LOG_ERROR("Failed to start wlan connection observer.");
 		return false;
 	}
 
 	if (!this->soundCardSetupController->Init())
 	{
-		Logger::LogError("Failed to start sound card setup controller.");
+		LOG_ERROR("Failed to start sound card setup controller.");
 		return false;
 	}
 
-    Logger::LogDebug("RetroradioController::Init -> Initialized Retroradio Controller");
+    LOG_DEBUG("RetroradioController::Init -> Initialized Retroradio Controller");
 
     this->stateMachine->KickOff();
 
-    Logger::LogDebug("RetroradioController::Init -> Kicked off main state machine");
+    LOG_DEBUG("RetroradioController::Init -> Kicked off main state machine");
 
     return true;
 }
@@ -116,11 +132,13 @@ void RetroradioController::DeInit()
 	this->stateMachine->DeInit();
 	this->remoteController->DeInit();
 	this->gpioController->DeInit();
+	AudioControlThread::Instance()->Stop();
+	this->persistentState->DeInit();
 
 	delete this;
 	RetroradioController::instance=NULL;
 
-	Logger::LogDebug("RetroradioController::DeInit -> Deinitialized Retroradio Controller");
+	LOG_DEBUG("RetroradioController::DeInit -> Deinitialized Retroradio Controller");
 }
 
 RetroradioController *RetroradioController::Instance()
@@ -138,17 +156,60 @@ gboolean RetroradioController::UnixSignalHandler(gpointer user_data)
 	return TRUE;
 }
 
+gboolean RetroradioController::DumpTraceSignalHandler(gpointer user_data)
+{
+	RetroradioController *controller=(RetroradioController *)user_data;
+	TimerWheel::Statistics stats;
+
+	LatencyTracer::Instance()->DumpChromeTrace(LATENCY_TRACE_DUMP_PATH);
+	TimerWheel::Instance()->GetStatistics(&stats);
+	RetroradioController::LogTimerWheelStatistics("Main loop", &stats);
+	//the audio control thread's wheel is read by the thread itself
+	if (AudioControlThread::Instance()->IsRunning())
+	{
+		AudioControlThread::Instance()->Invoke(controller, CTRL_CMD_GET_TIMER_WHEEL_STATS, (long)&stats);
+		RetroradioController::LogTimerWheelStatistics("Audio control thread", &stats);
+	}
+	LOG_INFO("Mixer controls: %lu volume reads and writes passed to alsa, %u card mixers opened.",
+			BasicMixerControl::GetAlsaCallCount(), AlsaMixerRegistry::Instance()->GetCardOpenCount());
+	LOG_INFO("Persistent state: %u commits written, journal wrapped %u times, commit latency avg %lld us max %lld us.",
+			controller->persistentState->GetCommitCount(), controller->persistentState->GetJournalWrapCount(),
+			(long long)controller->persistentState->GetCommitLatencyAvgUs(),
+			(long long)controller->persistentState->GetCommitLatencyMaxUs());
+	LOG_INFO("Non blocking threads: %u log messages dropped while the asynchronous log backend was stopped.",
+			AsyncLogger::GetUnbufferedDroppedCount());
+	return TRUE;
+}
+
+void RetroradioController::LogTimerWheelStatistics(const char *name, TimerWheel::Statistics *stats)
+{
+	LOG_INFO("%s timer wheel: %llu wakeups (%.2f/s), %llu timers fired.", name,
+			(unsigned long long)stats->wakeupCnt, stats->wakeupsPerSecond, (unsigned long long)stats->firedCnt);
+}
+
+long RetroradioController::OnAudioControlCommand(int cmd, long arg, unsigned int tag)
+{
+	if (cmd==CTRL_CMD_GET_TIMER_WHEEL_STATS)
+		AudioControlThread::Instance()->GetTimerWheel()->GetStatistics((TimerWheel::Statistics *)arg);
+	return 0;
+}
+
+void RetroradioController::OnAudioControlEvent(int event, long arg, unsigned int tag)
+{
+}
+
 void RetroradioController::Run()
 {
-	Logger::LogDebug("RetroradioController::Run -> Going to enter retroradio controller main loop.");
+	LOG_DEBUG("RetroradioController::Run -> Going to enter retroradio controller main loop.");
 	g_main_loop_run(this->mainloop);
-	Logger::LogDebug("RetroradioController::Run -> Retroradio main loop left. Shutting down.");
+	LOG_DEBUG("RetroradioController::Run -> Retroradio main loop left. Shutting down.");
 }
 
 void RetroradioController::OnCommandReceived(
 		RemoteControllerProfiles::RemoteCommand cmd)
 {
-	Logger::LogDebug("RetroradioController::OnCommandReceived -> Received IR command: %d", cmd);
+	LatencyTracer::Instance()->Mark(LatencyTracer::TRACE_CMD_RECEIVED, cmd);
+	LOG_DEBUG("RetroradioController::OnCommandReceived -> Received IR command: %d", cmd);
 
 	if (cmd==RemoteControllerProfiles::CMD_POWER)
 	{
@@ -187,13 +248,13 @@ void RetroradioController::OnCommandReceived(
 
 void RetroradioController::OnSoundCardReady()
 {
-    Logger::LogDebug("RetroradioController::OnSoundCardReady -> Sound card setup controller signaled sound card setup done.");
+    LOG_DEBUG("RetroradioController::OnSoundCardReady -> Sound card setup controller signaled sound card setup done.");
     this->stateMachine->OnSoundCardReady();
 }
 
 void RetroradioController::OnSoundCardDisabled()
 {
-    Logger::LogDebug("RetroradioController::OnSoundCardReady -> Sound card setup controller signaled disappeared sound card.");
+    LOG_DEBUG("RetroradioController::OnSoundCardReady -> Sound card setup controller signaled disappeared sound card.");
     this->stateMachine->OnSoundCardDisabled();
 }
 
@@ -210,13 +271,13 @@ int RetroradioController::GetReturnCode()
 
 void RetroradioController::OnConnectionEstablished()
 {
-	Logger::LogDebug("RetroradioController::OnConnectionEstablished - Connection to internet established.");
+	LOG_DEBUG("RetroradioController::OnConnectionEstablished - Connection to internet established.");
 	this->stateMachine->OnConnectionEstablished();
 }
 
 void RetroradioController::OnConnectionLost()
 {
-	Logger::LogDebug("RetroradioController::OnConnectionLost - Connection to internet lost.");
+	LOG_DEBUG("RetroradioController::OnConnectionLost - Connection to internet lost.");
 	this->stateMachine->OnConnectionLost();
 }
 
@@ -225,6 +286,11 @@ void RetroradioController::OnStateChanged(AudioController::State newState)
 	this->stateMachine->OnAudioControllerStateChanged(newState);
 }
 
+void RetroradioController::OnSourcesStartupFinished()
+{
+	this->stateMachine->OnSourcesStartupFinished();
+}
+
 void RetroradioController::OnPowerButtonReleased()
 {
 	this->stateMachine->OnPowerBtnPressed();
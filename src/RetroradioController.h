@@ -20,6 +20,9 @@
 #include "ConnObserverFile.h"
 #include "SoundCardSetup.h"
 #include "RetroradioPersistentState.h"
+#include "AsyncLogger.h"
+#include "AudioControlThread.h"
+#include "TimerWheel.h"
 
 using namespace GenericEmbeddedUtils;
 
@@ -29,10 +32,15 @@ namespace retroradio_controller
 
 class RetroradioController : public RemoteController::IRemoteControllerListener,
 	ConnObserverFile::Listener, AudioController::IStateListener, GPIOController::IBtnListener,
-	SoundCardSetup::ISoundCardSetupListener
+	SoundCardSetup::ISoundCardSetupListener, public AudioControlThread::IAudioControlHandler
 {
 
 private:
+	enum AudioControlCommand
+	{
+		CTRL_CMD_GET_TIMER_WHEEL_STATS
+	};
+
 	static RetroradioController *instance;
 
 	int returnCode;
@@ -41,6 +49,8 @@ private:
 
 	RetroradioControllerConfiguration *configuration;
 
+	AsyncLogger *asyncLogger;
+
 	AudioController *audioController;
 
 	RemoteController *remoteController;
@@ -57,6 +67,10 @@ private:
 
 	static gboolean UnixSignalHandler(gpointer user_data);
 
+	static gboolean DumpTraceSignalHandler(gpointer user_data);
+
+	static void LogTimerWheelStatistics(const char *name, TimerWheel::Statistics *stats);
+
 	RetroradioController();
 
 	virtual ~RetroradioController();
@@ -74,6 +88,8 @@ public:
 	//AudioController::IStateListener
 	virtual void OnStateChanged(AudioController::State newState);
 
+	virtual void OnSourcesStartupFinished();
+
 	//GPIOController::IBtnListener
 
 	virtual void OnPowerButtonReleased();
@@ -84,6 +100,11 @@ public:
 
 	virtual void OnSoundCardDisabled();
 
+	//AudioControlThread::IAudioControlHandler
+	virtual long OnAudioControlCommand(int cmd, long arg, unsigned int tag);
+
+	virtual void OnAudioControlEvent(int event, long arg, unsigned int tag);
+
 	static RetroradioController *Instance();
 
 	bool Init(int argc, char *argv[]);
@@ -12,7 +12,7 @@
 #include "MainVolumeControl.h"
 
 #include <stdlib.h>
-#include <unistd.h>
+#include <string.h>
 
 using namespace retroradio_controller;
 
@@ -33,28 +33,32 @@ RetroradioPersistentState::~RetroradioPersistentState()
 {
 }
 
-bool RetroradioPersistentState::DoWriteDataSet(int fd)
+size_t RetroradioPersistentState::DoWriteDataSet(void *buffer, size_t maxSize)
 {
 	size_t size=sizeof(PersistentState);
 
-	if (write(fd, &this->state,size)!=size)
-		return false;
+	if (size>maxSize)
+		return 0;
 
-	return true;
+	memcpy(buffer, &this->state, size);
+	return size;
 }
 
-bool RetroradioPersistentState::DoReadDataSet(int fd)
+bool RetroradioPersistentState::DoReadDataSet(const void *buffer, size_t size)
 {
-	size_t size=sizeof(PersistentState);
-
-	if (read(fd, &this->state,size)!=size)
+	//a data set read from in front of the journal may be followed by other data
+	if (size<sizeof(PersistentState))
 		return false;
 
+	memcpy(&this->state, buffer, sizeof(PersistentState));
+
 	if (!CheckDataSetSignature())	return false;
 	if (!CheckPowerValue())	return false;
 	if (!CheckMasterVolumeValue())	return false;
 	if (!CheckCurrentSrcId())	return false;
 	//no sanity check track number ...
+	this->state.mpdQueuePlaylistName[sizeof(this->state.mpdQueuePlaylistName)-1]='\0';
+	this->state.mpdQueuePlaylistLastModified[sizeof(this->state.mpdQueuePlaylistLastModified)-1]='\0';
 
 	return true;
 }
@@ -92,6 +96,7 @@ void RetroradioPersistentState::DoResetToDefault()
 	strncpy(this->state.currentSrcId, RetroradioAudioSourceList::GetDefaultSourceId(),
 			sizeof(this->state.currentSrcId)-1);
 	this->state.mpdCurrentTrackNr 	= 0;
+	this->ResetMPDQueueFingerprint();
 }
 
 void RetroradioPersistentState::SetPowerStateActive(bool isActive)
@@ -139,3 +144,36 @@ unsigned int RetroradioPersistentState::GetMPDCurrentTrackNr()
 {
 	return this->state.mpdCurrentTrackNr;
 }
+
+void RetroradioPersistentState::SetMPDQueueFingerprint(const char *playlistName, const char *playlistLastModified,
+		unsigned int queueVersion, unsigned int queueLength)
+{
+	strncpy(this->state.mpdQueuePlaylistName, playlistName, sizeof(this->state.mpdQueuePlaylistName)-1);
+	this->state.mpdQueuePlaylistName[sizeof(this->state.mpdQueuePlaylistName)-1]='\0';
+	strncpy(this->state.mpdQueuePlaylistLastModified, playlistLastModified,
+			sizeof(this->state.mpdQueuePlaylistLastModified)-1);
+	this->state.mpdQueuePlaylistLastModified[sizeof(this->state.mpdQueuePlaylistLastModified)-1]='\0';
+	this->state.mpdQueueVersion=queueVersion;
+	this->state.mpdQueueLength=queueLength;
+	this->CommitDelayed();
+}
+
+void RetroradioPersistentState::ResetMPDQueueFingerprint()
+{
+	memset(this->state.mpdQueuePlaylistName, 0, sizeof(this->state.mpdQueuePlaylistName));
+	memset(this->state.mpdQueuePlaylistLastModified, 0, sizeof(this->state.mpdQueuePlaylistLastModified));
+	this->state.mpdQueueVersion=0;
+	this->state.mpdQueueLength=0;
+}
+
+bool RetroradioPersistentState::IsMPDQueueFingerprintEqual(const char *playlistName, const char *playlistLastModified,
+		unsigned int queueVersion, unsigned int queueLength)
+{
+	//an empty name is never stored for a loaded queue
+	if (this->state.mpdQueuePlaylistName[0]=='\0')
+		return false;
+
+	return strcmp(this->state.mpdQueuePlaylistName, playlistName)==0 &&
+			strcmp(this->state.mpdQueuePlaylistLastModified, playlistLastModified)==0 &&
+			this->state.mpdQueueVersion==queueVersion && this->state.mpdQueueLength==queueLength;
+}
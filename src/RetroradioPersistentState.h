@@ -27,6 +27,15 @@ private:
 
 		unsigned int mpdCurrentTrackNr;
 
+		//fingerprint of the mpd queue loaded the last time. Used to skip reloading an unchanged playlist.
+		char mpdQueuePlaylistName[128];
+
+		char mpdQueuePlaylistLastModified[32];
+
+		unsigned int mpdQueueVersion;
+
+		unsigned int mpdQueueLength;
+
 		char stateEndTag[2];
 
 	} PersistentState;
@@ -42,9 +51,9 @@ private:
 	bool CheckCurrentSrcId();
 
 protected:
-	virtual bool DoWriteDataSet(int fd);
+	virtual size_t DoWriteDataSet(void *buffer, size_t maxSize);
 
-	virtual bool DoReadDataSet(int fd);
+	virtual bool DoReadDataSet(const void *buffer, size_t size);
 
 	virtual void DoResetToDefault();
 
@@ -68,6 +77,14 @@ public:
 	void SetMPDCurrentTrackNr(unsigned int currentTrackNr);
 
 	unsigned int GetMPDCurrentTrackNr();
+
+	void SetMPDQueueFingerprint(const char *playlistName, const char *playlistLastModified,
+			unsigned int queueVersion, unsigned int queueLength);
+
+	void ResetMPDQueueFingerprint();
+
+	bool IsMPDQueueFingerprintEqual(const char *playlistName, const char *playlistLastModified,
+			unsigned int queueVersion, unsigned int queueLength);
 };
 
 } /* namespace retroradio_controller */
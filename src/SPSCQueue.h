@@ -0,0 +1,67 @@
+/*
+ * SPSCQueue.h
+ *
+ *  Created on: 17.10.2026
+ *      Author: joe
+ */
+
+#ifndef SRC_SPSCQUEUE_H_
+#define SRC_SPSCQUEUE_H_
+
+#include <atomic>
+
+namespace retroradio_controller {
+
+//Lock free bounded queue for exactly one producer and one consumer thread.
+//SIZE must be a power of two. One slot is kept free to tell a full from an empty queue.
+template<typename T, unsigned int SIZE>
+class SPSCQueue {
+private:
+	static_assert((SIZE & (SIZE-1))==0, "SPSCQueue size must be a power of two");
+
+	//written by the consumer only
+	std::atomic<unsigned int> head;
+
+	//written by the producer only
+	std::atomic<unsigned int> tail;
+
+	T items[SIZE];
+
+public:
+	SPSCQueue() :
+			head(0),
+			tail(0)
+	{
+	}
+
+	//producer side. Returns false if the queue is full.
+	bool Push(const T &item)
+	{
+		unsigned int tail=this->tail.load(std::memory_order_relaxed);
+		unsigned int next=(tail+1) & (SIZE-1);
+
+		if (next==this->head.load(std::memory_order_acquire))
+			return false;
+
+		this->items[tail]=item;
+		this->tail.store(next, std::memory_order_release);
+		return true;
+	}
+
+	//consumer side. Returns false if the queue is empty.
+	bool Pop(T *item)
+	{
+		unsigned int head=this->head.load(std::memory_order_relaxed);
+
+		if (head==this->tail.load(std::memory_order_acquire))
+			return false;
+
+		*item=this->items[head];
+		this->head.store((head+1) & (SIZE-1), std::memory_order_release);
+		return true;
+	}
+};
+
+} /* namespace retroradio_controller */
+
+#endif /* SRC_SPSCQUEUE_H_ */
@@ -8,7 +8,7 @@
 #include "SoundCardSetup.h"
 
 #include <glib-unix.h>
-#include "cpp-app-utils/Logger.h"
+#include "Logging.h"
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <unistd.h>
@@ -49,7 +49,7 @@ SoundCardSetup::~SoundCardSetup()
 bool SoundCardSetup::Init()
 {
 	this->DeInit();
-	Logger::LogDebug("SoundCardSetup::Init - Initializing sound card setup controller.");
+	LOG_DEBUG("SoundCardSetup::Init - Initializing sound card setup controller.");
 	if (!this->SetupUdevListener())
 		return false;
 
@@ -77,12 +77,12 @@ bool SoundCardSetup::SetupUdevListener()
 {
 	int monitorFd;
 
-	Logger::LogDebug("SoundCardSetup::SetupUdevListener - Creating udev monitor.");
+	LOG_DEBUG("SoundCardSetup::SetupUdevListener - Creating udev monitor.");
 
 	this->udevObj = udev_new();
 	if(this->udevObj==NULL)
 	{
-		Logger::LogError("Unable to create new udev object.");
+		LOG_ERROR("Unable to create new udev object.");
 		return false;
 	}
 
@@ -98,7 +98,7 @@ bool SoundCardSetup::SetupUdevListener()
 void SoundCardSetup::TriggerColdPluggedDevices()
 {
 	DeviceReadyT *item=this->devNodeLst;
-	Logger::LogDebug("SoundCardSetup::ColdPlugDevices - Setting up sound devices if already available.");
+	LOG_DEBUG("SoundCardSetup::ColdPlugDevices - Setting up sound devices if already available.");
 	while(item->devNode!=NULL)
 	{
 		this->TriggerColdPluggedDevice(item->devNode);
@@ -135,7 +135,7 @@ void SoundCardSetup::OnUdevEvent(udev_device *dev)
 
 	allDevicesSetupOld=this->IsCardAvailable();
 
-	Logger::LogDebug("SoundCardSetup::OnUdevEvent - Received uevent for dev node: %s, Action: %s", devNode, action);
+	LOG_DEBUG("SoundCardSetup::OnUdevEvent - Received uevent for dev node: %s, Action: %s", devNode, action);
 
 	//"change" events are treated same way as "add" events
 	deviceReadyItem->available=!(strcmp(action,"remove")==0);
@@ -159,12 +159,12 @@ void SoundCardSetup::TriggerColdPluggedDevice(const char *devNode)
 	const char *syspath;
 	int fd;
 
-	Logger::LogDebug("SoundCardSetup::TriggerColdPluggedDevice - Triggering cold plugged device: %s", devNode);
+	LOG_DEBUG("SoundCardSetup::TriggerColdPluggedDevice - Triggering cold plugged device: %s", devNode);
 
 	// if dev node not yet there -> ok, will appear later
 	if (stat(devNode, &statResult)!=0)
 	{
-		Logger::LogDebug("SoundCardSetup::TriggerColdPluggedDevice - Device %s not present yet (stat failed). Waiting for it.", devNode);
+		LOG_DEBUG("SoundCardSetup::TriggerColdPluggedDevice - Device %s not present yet (stat failed). Waiting for it.", devNode);
 		return;
 	}
 
@@ -173,8 +173,8 @@ void SoundCardSetup::TriggerColdPluggedDevice(const char *devNode)
 	udevDevice=udev_device_new_from_devnum(this->udevObj,deviceType,statResult.st_rdev);
 	if (udevDevice==NULL)
 	{
-		Logger::LogDebug("SoundCardSetup::TriggerColdPluggedDevice - Device %s not present yet (no udev device). Waiting for it.", devNode);
-		Logger::LogDebug("SoundCardSetup::TriggerColdPluggedDevice - Device %s, Type: %c, Major: %d, Minor: %d",
+		LOG_DEBUG("SoundCardSetup::TriggerColdPluggedDevice - Device %s not present yet (no udev device). Waiting for it.", devNode);
+		LOG_DEBUG("SoundCardSetup::TriggerColdPluggedDevice - Device %s, Type: %c, Major: %d, Minor: %d",
 				devNode, deviceType, major(statResult.st_rdev), minor(statResult.st_rdev));
 		return;
 	}
@@ -186,15 +186,15 @@ void SoundCardSetup::TriggerColdPluggedDevice(const char *devNode)
 	if (fd != -1)
 	{
 		if (write(fd, "add", 3)==3)
-			Logger::LogDebug("SoundCardSetup::TriggerColdPluggedDevice - Wrote \"add\" to uevent file %s successfully.", ueventFilepath);
+			LOG_DEBUG("SoundCardSetup::TriggerColdPluggedDevice - Wrote \"add\" to uevent file %s successfully.", ueventFilepath);
 		else
-			Logger::LogDebug("SoundCardSetup::TriggerColdPluggedDevice - Error writing add to uevent file: %s.", ueventFilepath);
+			LOG_DEBUG("SoundCardSetup::TriggerColdPluggedDevice - Error writing add to uevent file: %s.", ueventFilepath);
 		close(fd);
 	}
 	else
 	{
-		Logger::LogDebug("SoundCardSetup::TriggerColdPluggedDevice - Device %s not present yet (open uevent file failed). Waiting for it.", devNode);
-		Logger::LogDebug("SoundCardSetup::TriggerColdPluggedDevice - Path: %s",ueventFilepath);
+		LOG_DEBUG("SoundCardSetup::TriggerColdPluggedDevice - Device %s not present yet (open uevent file failed). Waiting for it.", devNode);
+		LOG_DEBUG("SoundCardSetup::TriggerColdPluggedDevice - Path: %s",ueventFilepath);
 	}
 
 	udev_device_unref(udevDevice);
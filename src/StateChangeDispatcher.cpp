@@ -0,0 +1,144 @@
+/*
+ * StateChangeDispatcher.cpp
+ *
+ *  Created on: 17.10.2026
+ *      Author: joe
+ */
+
+#include "StateChangeDispatcher.h"
+
+#include "Logging.h"
+
+using namespace CppAppUtils;
+
+using namespace retroradio_controller;
+
+//limits the number of events delivered within one main loop iteration in case listeners keep posting
+#define STATE_CHANGE_MAX_EVENTS_PER_DISPATCH	(STATE_CHANGE_QUEUE_SIZE*4)
+
+StateChangeDispatcher *StateChangeDispatcher::instance=NULL;
+
+GSourceFuncs StateChangeDispatcher::dispatchSourceFuncs=
+	{
+		StateChangeDispatcher::Prepare,
+		StateChangeDispatcher::Check,
+		StateChangeDispatcher::Dispatch,
+		NULL,	//finalize
+		NULL,	//closure_callback
+		NULL	//closure_marshal
+	};
+
+StateChangeDispatcher::StateChangeDispatcher() :
+		eventHead(0),
+		eventCnt(0),
+		maxEventCnt(0)
+{
+	//source is never removed. It is only dispatched while events are queued.
+	this->dispatchSource=g_source_new(&StateChangeDispatcher::dispatchSourceFuncs, sizeof(GSource));
+	g_source_set_priority(this->dispatchSource, G_PRIORITY_DEFAULT_IDLE);
+	g_source_attach(this->dispatchSource, NULL);
+}
+
+StateChangeDispatcher::~StateChangeDispatcher()
+{
+	g_source_destroy(this->dispatchSource);
+	g_source_unref(this->dispatchSource);
+}
+
+StateChangeDispatcher *StateChangeDispatcher::Instance()
+{
+	if (StateChangeDispatcher::instance==NULL)
+		StateChangeDispatcher::instance=new StateChangeDispatcher();
+
+	return StateChangeDispatcher::instance;
+}
+
+void StateChangeDispatcher::Post(IStateChangeSender *sender, int newState)
+{
+	StateChangeEvent *event;
+
+	//listeners query the current state anyway -> only the latest state of a sender needs to be delivered
+	for (unsigned int a=0; a<this->eventCnt; a++)
+	{
+		event=&this->events[(this->eventHead+a)%STATE_CHANGE_QUEUE_SIZE];
+		if (event->sender==sender)
+		{
+			event->newState=newState;
+			return;
+		}
+	}
+
+	if (this->eventCnt==STATE_CHANGE_QUEUE_SIZE)
+	{
+		LOG_ERROR("State change queue full. Dropping state change to %d.", newState);
+		return;
+	}
+
+	event=&this->events[(this->eventHead+this->eventCnt)%STATE_CHANGE_QUEUE_SIZE];
+	event->sender=sender;
+	event->newState=newState;
+	this->eventCnt++;
+
+	if (this->eventCnt>this->maxEventCnt)
+	{
+		this->maxEventCnt=this->eventCnt;
+		LOG_DEBUG("StateChangeDispatcher::Post - New maximum state change queue depth: %u", this->maxEventCnt);
+	}
+}
+
+void StateChangeDispatcher::Cancel(IStateChangeSender *sender)
+{
+	unsigned int kept=0;
+
+	for (unsigned int a=0; a<this->eventCnt; a++)
+	{
+		StateChangeEvent event=this->events[(this->eventHead+a)%STATE_CHANGE_QUEUE_SIZE];
+		if (event.sender!=sender)
+			this->events[(this->eventHead+kept++)%STATE_CHANGE_QUEUE_SIZE]=event;
+	}
+
+	this->eventCnt=kept;
+}
+
+gboolean StateChangeDispatcher::Prepare(GSource *source, gint *timeout)
+{
+	*timeout=-1;
+	return StateChangeDispatcher::instance!=NULL && StateChangeDispatcher::instance->eventCnt!=0;
+}
+
+gboolean StateChangeDispatcher::Check(GSource *source)
+{
+	return StateChangeDispatcher::instance!=NULL && StateChangeDispatcher::instance->eventCnt!=0;
+}
+
+gboolean StateChangeDispatcher::Dispatch(GSource *source, GSourceFunc callback, gpointer user_data)
+{
+	StateChangeDispatcher::instance->DispatchEvents();
+	return TRUE;
+}
+
+void StateChangeDispatcher::DispatchEvents()
+{
+	unsigned int delivered=0;
+
+	//events posted by listeners are delivered as well -> a chain of transitions completes in one iteration
+	while (this->eventCnt!=0 && delivered<STATE_CHANGE_MAX_EVENTS_PER_DISPATCH)
+	{
+		StateChangeEvent event=this->events[this->eventHead];
+		this->eventHead=(this->eventHead+1)%STATE_CHANGE_QUEUE_SIZE;
+		this->eventCnt--;
+
+		event.sender->DeliverStateChange(event.newState);
+		delivered++;
+	}
+}
+
+unsigned int StateChangeDispatcher::GetQueueDepth()
+{
+	return this->eventCnt;
+}
+
+unsigned int StateChangeDispatcher::GetMaxQueueDepth()
+{
+	return this->maxEventCnt;
+}
@@ -0,0 +1,76 @@
+/*
+ * StateChangeDispatcher.h
+ *
+ *  Created on: 17.10.2026
+ *      Author: joe
+ */
+
+#ifndef SRC_STATECHANGEDISPATCHER_H_
+#define SRC_STATECHANGEDISPATCHER_H_
+
+#include <glib.h>
+
+namespace retroradio_controller {
+
+#define STATE_CHANGE_QUEUE_SIZE		32
+
+//Delivers state change notifications decoupled from the state machine posting them. Events are kept in a
+//preallocated ring and drained by one persistent main loop source. Events posted while draining are delivered
+//within the same main loop iteration. A state superseded before delivery is replaced by the newer one.
+class StateChangeDispatcher {
+public:
+	class IStateChangeSender
+	{
+	public:
+		virtual void DeliverStateChange(int newState)=0;
+	};
+
+private:
+	typedef struct StateChangeEvent
+	{
+		IStateChangeSender *sender;
+		int newState;
+	} StateChangeEvent;
+
+	static StateChangeDispatcher *instance;
+
+	static GSourceFuncs dispatchSourceFuncs;
+
+	StateChangeEvent events[STATE_CHANGE_QUEUE_SIZE];
+
+	unsigned int eventHead;
+
+	unsigned int eventCnt;
+
+	unsigned int maxEventCnt;
+
+	GSource *dispatchSource;
+
+	static gboolean Prepare(GSource *source, gint *timeout);
+
+	static gboolean Check(GSource *source);
+
+	static gboolean Dispatch(GSource *source, GSourceFunc callback, gpointer user_data);
+
+	void DispatchEvents();
+
+	StateChangeDispatcher();
+
+public:
+	virtual ~StateChangeDispatcher();
+
+	static StateChangeDispatcher *Instance();
+
+	void Post(IStateChangeSender *sender, int newState);
+
+	//drops pending events of a sender about to be destroyed
+	void Cancel(IStateChangeSender *sender);
+
+	unsigned int GetQueueDepth();
+
+	unsigned int GetMaxQueueDepth();
+};
+
+} /* namespace retroradio_controller */
+
+#endif /* SRC_STATECHANGEDISPATCHER_H_ */
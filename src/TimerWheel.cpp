@@ -0,0 +1,356 @@
+/*
+ * TimerWheel.cpp
+ *
+ *  Created on: 17.10.2026
+ *      Author: joe
+ */
+
+#include "TimerWheel.h"
+
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/timerfd.h>
+
+#include <glib-unix.h>
+
+#include "Logging.h"
+
+using namespace CppAppUtils;
+
+using namespace retroradio_controller;
+
+#define TIMER_WHEEL_LEVEL0_MASK		(TIMER_WHEEL_LEVEL0_SIZE-1)
+#define TIMER_WHEEL_LEVEL_MASK		(TIMER_WHEEL_LEVEL_SIZE-1)
+
+#define TIMER_WHEEL_LEVEL_SHIFT(level)	(TIMER_WHEEL_LEVEL0_BITS+(level)*TIMER_WHEEL_LEVEL_BITS)
+
+//timers further away are parked in the last slot of the top level and relinked when it cascades
+#define TIMER_WHEEL_MAX_DELTA		((1ULL << TIMER_WHEEL_LEVEL_SHIFT(TIMER_WHEEL_UPPER_LEVELS))-1)
+
+TimerWheel *TimerWheel::instance=NULL;
+
+//maximum slack per class. A timer never gets more slack than half of its interval.
+const guint TimerWheel::slackMs[]={ 0, 20, 1000 };
+
+TimerWheel::TimerWheel(GMainContext *context) :
+		nextTimerId(1),
+		currentTick(0),
+		timerFdSource(NULL),
+		armedDeadline(0),
+		dispatching(false),
+		wakeupCnt(0),
+		firedCnt(0)
+{
+	memset(this->level0, 0, sizeof(this->level0));
+	memset(this->levels, 0, sizeof(this->levels));
+
+	this->startTime=g_get_monotonic_time();
+
+	this->timerFd=timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK|TFD_CLOEXEC);
+	if (this->timerFd==-1)
+		LOG_ERROR("Failed to create timer wheel timerfd: %s", strerror(errno));
+	else
+	{
+		this->timerFdSource=g_unix_fd_source_new(this->timerFd, G_IO_IN);
+		g_source_set_callback(this->timerFdSource, (GSourceFunc)TimerWheel::OnTimerFdEvent, this, NULL);
+		g_source_attach(this->timerFdSource, context);
+	}
+}
+
+TimerWheel::~TimerWheel()
+{
+	for (std::map<guint, Timer *>::iterator itr=this->timers.begin(); itr!=this->timers.end(); itr++)
+		delete itr->second;
+	this->timers.clear();
+
+	if (this->timerFdSource!=NULL)
+	{
+		g_source_destroy(this->timerFdSource);
+		g_source_unref(this->timerFdSource);
+	}
+
+	if (this->timerFd!=-1)
+		close(this->timerFd);
+}
+
+TimerWheel *TimerWheel::Instance()
+{
+	if (TimerWheel::instance==NULL)
+		TimerWheel::instance=new TimerWheel(NULL);
+
+	return TimerWheel::instance;
+}
+
+guint64 TimerWheel::GetNowTick()
+{
+	return (guint64)(g_get_monotonic_time()-this->startTime)/1000;
+}
+
+guint TimerWheel::Add(guint intervalMs, SlackClass slack, GSourceFunc func, gpointer data)
+{
+	Timer *timer=new Timer;
+
+	//catch up first, the new timer is relative to now and must not be linked behind the wheel's position
+	if (this->timers.empty())
+		this->currentTick=this->GetNowTick();
+
+	timer->id=this->nextTimerId++;
+	if (this->nextTimerId==0)
+		this->nextTimerId=1;
+	timer->intervalMs=intervalMs;
+	timer->slackMs=MIN(TimerWheel::slackMs[slack], intervalMs/2);
+	timer->func=func;
+	timer->data=data;
+	timer->expires=this->GetNowTick()+intervalMs;
+	timer->bucket=NULL;
+
+	this->timers[timer->id]=timer;
+	this->Link(timer);
+	this->Rearm();
+
+	return timer->id;
+}
+
+void TimerWheel::Remove(guint timerId)
+{
+	std::map<guint, Timer *>::iterator itr=this->timers.find(timerId);
+
+	if (itr==this->timers.end())
+		return;
+
+	if (itr->second->bucket!=NULL)
+		this->Unlink(itr->second);
+
+	delete itr->second;
+	this->timers.erase(itr);
+	this->Rearm();
+}
+
+void TimerWheel::Link(Timer *timer)
+{
+	guint64 expires=timer->expires;
+	guint64 delta;
+
+	if (expires<=this->currentTick)
+		expires=this->currentTick+1;
+
+	delta=expires-this->currentTick;
+	if (delta>TIMER_WHEEL_MAX_DELTA)
+	{
+		delta=TIMER_WHEEL_MAX_DELTA;
+		expires=this->currentTick+delta;
+	}
+
+	if (delta<TIMER_WHEEL_LEVEL0_SIZE)
+		timer->bucket=&this->level0[expires & TIMER_WHEEL_LEVEL0_MASK];
+	else
+	{
+		for (int level=0; level<TIMER_WHEEL_UPPER_LEVELS; level++)
+		{
+			if (delta < (1ULL << TIMER_WHEEL_LEVEL_SHIFT(level+1)))
+			{
+				timer->bucket=&this->levels[level][(expires >> TIMER_WHEEL_LEVEL_SHIFT(level)) & TIMER_WHEEL_LEVEL_MASK];
+				break;
+			}
+		}
+	}
+
+	timer->prev=NULL;
+	timer->next=*timer->bucket;
+	if (timer->next!=NULL)
+		timer->next->prev=timer;
+	*timer->bucket=timer;
+}
+
+void TimerWheel::Unlink(Timer *timer)
+{
+	if (timer->prev!=NULL)
+		timer->prev->next=timer->next;
+	else
+		*timer->bucket=timer->next;
+
+	if (timer->next!=NULL)
+		timer->next->prev=timer->prev;
+
+	timer->bucket=NULL;
+	timer->prev=NULL;
+	timer->next=NULL;
+}
+
+void TimerWheel::Cascade(int level, unsigned int idx)
+{
+	Timer *timer=this->levels[level][idx];
+
+	//relinking puts the timers into lower levels as they are due within the range covered there now
+	this->levels[level][idx]=NULL;
+	while (timer!=NULL)
+	{
+		Timer *next=timer->next;
+		this->Link(timer);
+		timer=next;
+	}
+}
+
+void TimerWheel::Advance(guint64 toTick, std::vector<guint> &expired)
+{
+	while (this->currentTick<toTick)
+	{
+		unsigned int idx;
+		Timer *timer;
+
+		this->currentTick++;
+
+		if ((this->currentTick & TIMER_WHEEL_LEVEL0_MASK)==0)
+		{
+			for (int level=0; level<TIMER_WHEEL_UPPER_LEVELS; level++)
+			{
+				idx=(this->currentTick >> TIMER_WHEEL_LEVEL_SHIFT(level)) & TIMER_WHEEL_LEVEL_MASK;
+				this->Cascade(level, idx);
+				if (idx!=0) break;
+			}
+		}
+
+		idx=this->currentTick & TIMER_WHEEL_LEVEL0_MASK;
+		while ((timer=this->level0[idx])!=NULL)
+		{
+			this->Unlink(timer);
+			//parked timers are relinked until they are really due
+			if (timer->expires>this->currentTick)
+				this->Link(timer);
+			else
+				expired.push_back(timer->id);
+			if (this->level0[idx]==timer) break;
+		}
+	}
+}
+
+gboolean TimerWheel::OnTimerFdEvent(gint fd, GIOCondition condition, gpointer user_data)
+{
+	TimerWheel *instance=(TimerWheel *)user_data;
+	guint64 expirations;
+
+	if (read(fd, &expirations, sizeof(expirations))!=sizeof(expirations) && errno!=EAGAIN)
+		LOG_ERROR("Failed to read timer wheel timerfd: %s", strerror(errno));
+
+	instance->Dispatch();
+	return TRUE;
+}
+
+void TimerWheel::Dispatch()
+{
+	std::vector<guint> expired;
+
+	this->wakeupCnt++;
+	this->armedDeadline=0;
+	this->dispatching=true;
+
+	this->Advance(this->GetNowTick(), expired);
+
+	for (std::vector<guint>::iterator id=expired.begin(); id!=expired.end(); id++)
+	{
+		std::map<guint, Timer *>::iterator itr=this->timers.find(*id);
+		gboolean rearm;
+
+		//removed by a callback dispatched before
+		if (itr==this->timers.end())
+			continue;
+
+		this->firedCnt++;
+		rearm=itr->second->func(itr->second->data);
+
+		//the callback may have removed its own timer
+		itr=this->timers.find(*id);
+		if (itr==this->timers.end())
+			continue;
+
+		if (rearm)
+		{
+			itr->second->expires=this->GetNowTick()+itr->second->intervalMs;
+			this->Link(itr->second);
+		}
+		else
+		{
+			delete itr->second;
+			this->timers.erase(itr);
+		}
+	}
+
+	this->dispatching=false;
+	this->Rearm();
+}
+
+bool TimerWheel::GetNextDeadline(guint64 *deadline)
+{
+	bool found=false;
+
+	//the wheel holds a handful of timers only, so the latest acceptable expiry is looked up directly
+	for (std::map<guint, Timer *>::iterator itr=this->timers.begin(); itr!=this->timers.end(); itr++)
+	{
+		guint64 latest=itr->second->expires+itr->second->slackMs;
+		if (itr->second->bucket==NULL) continue;
+		if (!found || latest<*deadline)
+			*deadline=latest;
+		found=true;
+	}
+
+	return found;
+}
+
+void TimerWheel::Rearm()
+{
+	struct itimerspec spec;
+	guint64 deadline;
+	gint64 deadlineTime;
+
+	if (this->dispatching || this->timerFd==-1)
+		return;
+
+	memset(&spec, 0, sizeof(spec));
+
+	if (!this->GetNextDeadline(&deadline))
+	{
+		//nothing armed -> no wakeups at all
+		if (this->armedDeadline==0) return;
+		this->armedDeadline=0;
+	}
+	else
+	{
+		if (deadline<=this->currentTick)
+			deadline=this->currentTick+1;
+		if (deadline==this->armedDeadline) return;
+
+		this->armedDeadline=deadline;
+		deadlineTime=this->startTime+(gint64)deadline*1000;
+		spec.it_value.tv_sec=deadlineTime/G_USEC_PER_SEC;
+		spec.it_value.tv_nsec=(deadlineTime%G_USEC_PER_SEC)*1000;
+	}
+
+	if (timerfd_settime(this->timerFd, TFD_TIMER_ABSTIME, &spec, NULL)!=0)
+		LOG_ERROR("Failed to arm timer wheel timerfd: %s", strerror(errno));
+}
+
+guint64 TimerWheel::GetWakeupCount()
+{
+	return this->wakeupCnt;
+}
+
+guint64 TimerWheel::GetFiredCount()
+{
+	return this->firedCnt;
+}
+
+double TimerWheel::GetWakeupsPerSecond()
+{
+	gint64 elapsed=g_get_monotonic_time()-this->startTime;
+
+	if (elapsed<=0) return 0;
+	return this->wakeupCnt*(double)G_USEC_PER_SEC/elapsed;
+}
+
+void TimerWheel::GetStatistics(Statistics *stats)
+{
+	stats->wakeupCnt=this->wakeupCnt;
+	stats->firedCnt=this->firedCnt;
+	stats->wakeupsPerSecond=this->GetWakeupsPerSecond();
+}
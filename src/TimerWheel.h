@@ -0,0 +1,138 @@
+/*
+ * TimerWheel.h
+ *
+ *  Created on: 17.10.2026
+ *      Author: joe
+ */
+
+#ifndef SRC_TIMERWHEEL_H_
+#define SRC_TIMERWHEEL_H_
+
+#include <map>
+#include <vector>
+
+#include <glib.h>
+
+namespace retroradio_controller {
+
+#define TIMER_WHEEL_LEVEL0_BITS		8
+#define TIMER_WHEEL_LEVEL_BITS		6
+#define TIMER_WHEEL_UPPER_LEVELS	3
+
+#define TIMER_WHEEL_LEVEL0_SIZE		(1 << TIMER_WHEEL_LEVEL0_BITS)
+#define TIMER_WHEEL_LEVEL_SIZE		(1 << TIMER_WHEEL_LEVEL_BITS)
+
+//Hierarchical timer wheel with a resolution of 1 ms driving all timers of the controller from a single timerfd.
+//A timer may fire late by up to the slack of its class, so timers due close to each other are served by
+//one wakeup. Without armed timers the timerfd is disarmed and the controller does not wake up at all.
+//Callbacks behave like the ones of g_timeout_add: returning TRUE rearms the timer.
+//Instance() serves the main context. Threads running their own context create a wheel of their own.
+class TimerWheel {
+public:
+	typedef struct Statistics
+	{
+		guint64 wakeupCnt;
+		guint64 firedCnt;
+		double wakeupsPerSecond;
+	} Statistics;
+
+	enum SlackClass
+	{
+		//ramp steps and other audible timing
+		TIMER_SLACK_PRECISE,
+		//user interaction like repeat detection and debouncing
+		TIMER_SLACK_NORMAL,
+		//watchdogs, retries and persistence
+		TIMER_SLACK_LAZY
+	};
+
+private:
+	typedef struct Timer
+	{
+		guint id;
+		guint64 expires;
+		guint intervalMs;
+		guint slackMs;
+		GSourceFunc func;
+		gpointer data;
+		struct Timer *prev;
+		struct Timer *next;
+		//bucket the timer is linked into
+		struct Timer **bucket;
+	} Timer;
+
+	static TimerWheel *instance;
+
+	static const guint slackMs[];
+
+	Timer *level0[TIMER_WHEEL_LEVEL0_SIZE];
+
+	Timer *levels[TIMER_WHEEL_UPPER_LEVELS][TIMER_WHEEL_LEVEL_SIZE];
+
+	std::map<guint, Timer *> timers;
+
+	guint nextTimerId;
+
+	//wheel time in ms. All timers due up to this tick have been dispatched.
+	guint64 currentTick;
+
+	gint64 startTime;
+
+	int timerFd;
+
+	GSource *timerFdSource;
+
+	guint64 armedDeadline;
+
+	//timerfd is rearmed once after all expired timers have been dispatched
+	bool dispatching;
+
+	guint64 wakeupCnt;
+
+	guint64 firedCnt;
+
+	static gboolean OnTimerFdEvent(gint fd, GIOCondition condition, gpointer user_data);
+
+	guint64 GetNowTick();
+
+	void Link(Timer *timer);
+
+	void Unlink(Timer *timer);
+
+	void Cascade(int level, unsigned int idx);
+
+	void Advance(guint64 toTick, std::vector<guint> &expired);
+
+	void Dispatch();
+
+	bool GetNextDeadline(guint64 *deadline);
+
+	void Rearm();
+
+public:
+	//timers are dispatched in the given context, NULL for the default main context
+	TimerWheel(GMainContext *context);
+
+	virtual ~TimerWheel();
+
+	static TimerWheel *Instance();
+
+	//returns a non zero timer id
+	guint Add(guint intervalMs, SlackClass slack, GSourceFunc func, gpointer data);
+
+	void Remove(guint timerId);
+
+	guint64 GetWakeupCount();
+
+	guint64 GetFiredCount();
+
+	//average number of timerfd wakeups per second since the wheel was created
+	double GetWakeupsPerSecond();
+
+	//to be called by the thread running the wheel
+	void GetStatistics(Statistics *stats);
+};
+
+} /* namespace retroradio_controller */
+
+#endif /* SRC_TIMERWHEEL_H_ */
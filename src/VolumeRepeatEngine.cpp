@@ -0,0 +1,203 @@
+/*
+ * VolumeRepeatEngine.cpp
+ *
+ *  Created on: 17.10.2026
+ *      Author: joe
+ */
+
+#include "VolumeRepeatEngine.h"
+
+#include "Logging.h"
+
+using namespace CppAppUtils;
+
+using namespace retroradio_controller;
+
+VolumeRepeatEngine::VolumeRepeatEngine(IVolumeSink *sink) :
+		sink(sink),
+		timerWheel(NULL),
+		rangeMin(0),
+		rangeMax(0),
+		unitStep(1),
+		currentVolume(0),
+		targetVolume(0),
+		settledVolume(0),
+		holding(false),
+		holdUp(false),
+		holdStartTime(0),
+		lastKeyTime(0),
+		slewTimerId(0),
+		releaseTimerId(0)
+{
+}
+
+VolumeRepeatEngine::~VolumeRepeatEngine()
+{
+	this->RemoveTimers();
+}
+
+void VolumeRepeatEngine::Start(TimerWheel *timerWheel, long rangeMin, long rangeMax, long volume)
+{
+	this->RemoveTimers();
+
+	this->timerWheel=timerWheel;
+	this->rangeMin=rangeMin;
+	this->rangeMax=rangeMax;
+	this->unitStep=(rangeMax-rangeMin)/VOLUME_REPEAT_UNITS_PER_RANGE;
+	if (this->unitStep==0)
+		this->unitStep=1;
+
+	this->SetVolume(volume);
+}
+
+void VolumeRepeatEngine::Stop()
+{
+	this->RemoveTimers();
+	this->holding=false;
+	this->timerWheel=NULL;
+}
+
+void VolumeRepeatEngine::RemoveTimers()
+{
+	if (this->timerWheel==NULL)
+		return;
+
+	if (this->slewTimerId!=0)
+		this->timerWheel->Remove(this->slewTimerId);
+	if (this->releaseTimerId!=0)
+		this->timerWheel->Remove(this->releaseTimerId);
+	this->slewTimerId=0;
+	this->releaseTimerId=0;
+}
+
+long VolumeRepeatEngine::GetUnitsForHoldTime(gint64 holdTimeUs)
+{
+	gint64 holdTimeMs=holdTimeUs/1000;
+	long units;
+
+	//single presses and the first repeats keep fine steps
+	if (holdTimeMs<VOLUME_REPEAT_ACCEL_DELAY_MS)
+		return 1;
+
+	units=1+(holdTimeMs-VOLUME_REPEAT_ACCEL_DELAY_MS)/VOLUME_REPEAT_ACCEL_MS_PER_UNIT;
+	return units>VOLUME_REPEAT_UNITS_MAX ? VOLUME_REPEAT_UNITS_MAX : units;
+}
+
+void VolumeRepeatEngine::OnKey(bool up)
+{
+	gint64 now=g_get_monotonic_time();
+	long step;
+
+	if (this->timerWheel==NULL)
+		return;
+
+	//a key event after a release or for the other direction starts a new hold
+	if (!this->holding || this->holdUp!=up)
+	{
+		this->holding=true;
+		this->holdUp=up;
+		this->holdStartTime=now;
+	}
+	this->lastKeyTime=now;
+
+	step=VolumeRepeatEngine::GetUnitsForHoldTime(now-this->holdStartTime)*this->unitStep;
+	this->targetVolume+=up ? step : -step;
+	if (this->targetVolume>this->rangeMax)
+		this->targetVolume=this->rangeMax;
+	if (this->targetVolume<this->rangeMin)
+		this->targetVolume=this->rangeMin;
+
+	LOG_DEBUG("VolumeRepeatEngine::OnKey - Volume target %ld, step %ld.", this->targetVolume, step);
+
+	if (this->releaseTimerId==0)
+		this->releaseTimerId=this->timerWheel->Add(VOLUME_REPEAT_RELEASE_MS, TimerWheel::TIMER_SLACK_NORMAL,
+				VolumeRepeatEngine::OnReleaseTimerElapsed, this);
+
+	//the first step is taken at once, key presses are not delayed by the slew tick
+	if (this->slewTimerId==0 && this->Slew())
+		this->slewTimerId=this->timerWheel->Add(VOLUME_SLEW_INTERVAL_MS, TimerWheel::TIMER_SLACK_PRECISE,
+				VolumeRepeatEngine::OnSlewTimerElapsed, this);
+}
+
+bool VolumeRepeatEngine::Slew()
+{
+	long maxStep=VOLUME_SLEW_UNITS_PER_TICK*this->unitStep;
+	long delta=this->targetVolume-this->currentVolume;
+
+	if (delta==0)
+		return false;
+
+	if (delta>maxStep)
+		delta=maxStep;
+	if (delta<-maxStep)
+		delta=-maxStep;
+
+	this->currentVolume+=delta;
+	this->sink->OnSlewVolume(this->currentVolume);
+
+	return this->currentVolume!=this->targetVolume;
+}
+
+gboolean VolumeRepeatEngine::OnSlewTimerElapsed(gpointer data)
+{
+	VolumeRepeatEngine *instance=(VolumeRepeatEngine *)data;
+
+	if (instance->Slew())
+		return TRUE;
+
+	instance->slewTimerId=0;
+	instance->SettleIfDone();
+	return FALSE;
+}
+
+gboolean VolumeRepeatEngine::OnReleaseTimerElapsed(gpointer data)
+{
+	VolumeRepeatEngine *instance=(VolumeRepeatEngine *)data;
+
+	//rearmed as long as key events keep coming
+	if (g_get_monotonic_time()-instance->lastKeyTime<VOLUME_REPEAT_RELEASE_MS*1000)
+		return TRUE;
+
+	LOG_DEBUG("VolumeRepeatEngine::OnReleaseTimerElapsed - Volume key released.");
+	instance->releaseTimerId=0;
+	instance->holding=false;
+	instance->SettleIfDone();
+	return FALSE;
+}
+
+void VolumeRepeatEngine::SettleIfDone()
+{
+	if (this->holding || this->currentVolume!=this->targetVolume || this->currentVolume==this->settledVolume)
+		return;
+
+	this->settledVolume=this->currentVolume;
+	this->sink->OnVolumeSettled(this->currentVolume);
+}
+
+void VolumeRepeatEngine::Finish()
+{
+	this->RemoveTimers();
+	this->holding=false;
+
+	if (this->currentVolume!=this->targetVolume)
+	{
+		this->currentVolume=this->targetVolume;
+		this->sink->OnSlewVolume(this->currentVolume);
+	}
+
+	this->SettleIfDone();
+}
+
+void VolumeRepeatEngine::SetVolume(long volume)
+{
+	this->RemoveTimers();
+	this->holding=false;
+	this->currentVolume=volume;
+	this->targetVolume=volume;
+	this->settledVolume=volume;
+}
+
+long VolumeRepeatEngine::GetVolume()
+{
+	return this->currentVolume;
+}
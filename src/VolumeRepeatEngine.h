@@ -0,0 +1,111 @@
+/*
+ * VolumeRepeatEngine.h
+ *
+ *  Created on: 17.10.2026
+ *      Author: joe
+ */
+
+#ifndef SRC_VOLUMEREPEATENGINE_H_
+#define SRC_VOLUMEREPEATENGINE_H_
+
+#include <glib.h>
+
+#include "TimerWheel.h"
+
+namespace retroradio_controller {
+
+//volume steps per key event grow from 1 to VOLUME_REPEAT_UNITS_MAX while a key is held.
+//At ~110 ms ir repeat rate the whole range takes ~1.8 s.
+#define VOLUME_REPEAT_UNITS_PER_RANGE	100
+#define VOLUME_REPEAT_ACCEL_DELAY_MS	300
+#define VOLUME_REPEAT_ACCEL_MS_PER_UNIT	100
+#define VOLUME_REPEAT_UNITS_MAX			10
+
+//a key counts as released without any event for this time
+#define VOLUME_REPEAT_RELEASE_MS		200
+
+//the mixer follows the target by at most VOLUME_SLEW_UNITS_PER_TICK units each tick
+#define VOLUME_SLEW_INTERVAL_MS			20
+#define VOLUME_SLEW_UNITS_PER_TICK		3
+
+//Turns volume key events into a target volume which the mixer volume slews to.
+//Steps get larger the longer a key is held. The volume is reported as settled once, after the key has been
+//released and the mixer has reached the target. All methods must be called by the thread running the wheel.
+class VolumeRepeatEngine {
+public:
+	class IVolumeSink
+	{
+	public:
+		//the mixer has to be set to volume
+		virtual void OnSlewVolume(long volume)=0;
+
+		//the key is released and volume reached -> volume can be persisted
+		virtual void OnVolumeSettled(long volume)=0;
+	};
+
+private:
+	IVolumeSink *sink;
+
+	TimerWheel *timerWheel;
+
+	long rangeMin;
+
+	long rangeMax;
+
+	long unitStep;
+
+	long currentVolume;
+
+	long targetVolume;
+
+	//last volume reported as settled
+	long settledVolume;
+
+	bool holding;
+
+	bool holdUp;
+
+	gint64 holdStartTime;
+
+	gint64 lastKeyTime;
+
+	guint slewTimerId;
+
+	guint releaseTimerId;
+
+	static long GetUnitsForHoldTime(gint64 holdTimeUs);
+
+	//returns true while the target is not reached
+	bool Slew();
+
+	void SettleIfDone();
+
+	void RemoveTimers();
+
+	static gboolean OnSlewTimerElapsed(gpointer data);
+
+	static gboolean OnReleaseTimerElapsed(gpointer data);
+
+public:
+	VolumeRepeatEngine(IVolumeSink *sink);
+
+	virtual ~VolumeRepeatEngine();
+
+	void Start(TimerWheel *timerWheel, long rangeMin, long rangeMax, long volume);
+
+	void Stop();
+
+	void OnKey(bool up);
+
+	//moves the mixer to the target at once and settles a pending change
+	void Finish();
+
+	//volume changed by someone else. Cancels a running slew.
+	void SetVolume(long volume);
+
+	long GetVolume();
+};
+
+} /* namespace retroradio_controller */
+
+#endif /* SRC_VOLUMEREPEATENGINE_H_ */